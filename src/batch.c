@@ -0,0 +1,291 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "tulip.h"
+#include "batch.h"
+#include "epd.h"
+#include "gamestate.h"
+#include "fen.h"
+#include "eval.h"
+#include "hash.h"
+#include "json.h"
+#include "notation.h"
+#include "packedpos.h"
+#include "search.h"
+#include "ztable.h"
+
+// Positions are read and dispatched in chunks; results of a chunk are written in input
+// order once every worker is done with it, which bounds memory for arbitrarily large files.
+#define BATCH_CHUNK_SIZE 4096
+#define BATCH_LINE_LEN 512
+#define BATCH_RESULT_LEN (2 * BATCH_LINE_LEN + 256)
+#define BATCH_FILE_BUFFER (1024 * 1024)
+
+typedef struct {
+	int64_t lineNumber;         // The line, or for packed files the record, counting from 1.
+	const uint8_t* packed;      // The packed position, when reading a packed position file.
+	char line[BATCH_LINE_LEN];
+	char result[BATCH_RESULT_LEN];
+} BatchItem;
+
+typedef struct {
+	BatchArgs* args;
+	BatchItem* items;
+	int32_t count;
+	int32_t next;           // Index of the next unclaimed item, guarded by lock.
+	pthread_mutex_t lock;
+} BatchQueue;
+
+typedef struct {
+	pthread_t thread;
+	BatchQueue* queue;
+	GameState gameState;
+	ZTable zTable;          // Searches only; each worker owns its table.
+	SearchResult searchResult;
+} BatchWorker;
+
+static void evaluateItem(BatchWorker* worker, BatchItem* item, char* fen) {
+	GameState* state = &worker->gameState;
+	const int32_t mult = state->current->toMove == COLOR_WHITE ? 1 : -1;
+
+	snprintf(item->result, BATCH_RESULT_LEN, "{\"line\": %"PRId64", \"fenString\": \"%s\", \"score\": %i}",
+	         item->lineNumber, fen, mult * evaluate(state));
+}
+
+static void searchItem(BatchWorker* worker, BatchItem* item, char* fen) {
+	GameState* state = &worker->gameState;
+	SearchResult* result = &worker->searchResult;
+	char moveStr[16];
+	SearchArgs args;
+
+	initSearchArgs(&args);
+	args.depth = worker->queue->args->depth;
+	args.timeToThinkMillis = INT64_MAX; // Only the depth may decide the result, never the clock.
+
+	// Start every position from a logically empty table so results don't depend on how positions
+	// were spread over the workers.
+	hash_newGeneration(&worker->zTable);
+	search(state, &args, result);
+
+	if (result->searchStatus == SEARCH_STATUS_NONE) {
+		notation_printShortAlg(&result->move, state, moveStr);
+		snprintf(item->result, BATCH_RESULT_LEN,
+		         "{\"line\": %"PRId64", \"fenString\": \"%s\", \"move\": \"%s\", \"score\": %i, \"nodes\": %"PRId64", \"elapsedMs\": %"PRId64"}",
+		         item->lineNumber, fen, moveStr, result->score, result->nodes, result->durationMs);
+	} else {
+		snprintf(item->result, BATCH_RESULT_LEN,
+		         "{\"line\": %"PRId64", \"fenString\": \"%s\", \"move\": null, \"status\": \"noLegalMoves\"}",
+		         item->lineNumber, fen);
+	}
+}
+
+static bool readPosition(BatchWorker* worker, BatchItem* item, char* fen, size_t size) {
+	if (item->packed != NULL) {
+		if (!unpackPosition(&worker->gameState, item->packed)) {
+			return false;
+		}
+
+		printFen(&worker->gameState, fen, (int32_t) size);
+		return true;
+	}
+
+	return epd_toFen(item->line, fen, size) && parseFenWithPrint(&worker->gameState, fen, false);
+}
+
+static void processItem(BatchWorker* worker, BatchItem* item) {
+	char fen[BATCH_LINE_LEN];
+	char escapedFen[2 * BATCH_LINE_LEN];
+
+	if (!readPosition(worker, item, fen, sizeof(fen))) {
+		snprintf(item->result, BATCH_RESULT_LEN, "{\"line\": %"PRId64", \"error\": \"Unable to parse position.\"}",
+		         item->lineNumber);
+		return;
+	}
+
+	escapeJsonString(fen, escapedFen, sizeof(escapedFen));
+	if (worker->queue->args->mode == BATCH_SEARCH) {
+		searchItem(worker, item, escapedFen);
+	} else {
+		evaluateItem(worker, item, escapedFen);
+	}
+}
+
+static void* runWorker(void* arg) {
+	BatchWorker* worker = (BatchWorker*) arg;
+	BatchQueue* queue = worker->queue;
+
+	while (true) {
+		pthread_mutex_lock(&queue->lock);
+		const int32_t index = queue->next < queue->count ? queue->next++ : -1;
+		pthread_mutex_unlock(&queue->lock);
+
+		if (index < 0) {
+			break;
+		}
+
+		processItem(worker, &queue->items[index]);
+	}
+
+	return NULL;
+}
+
+// Reads up to BATCH_CHUNK_SIZE positions. Returns the number read, or -1 on a line too long to hold.
+static int32_t readChunk(FILE* file, BatchItem* items, int64_t* lineNumber) {
+	int32_t count = 0;
+
+	while (count < BATCH_CHUNK_SIZE && fgets(items[count].line, BATCH_LINE_LEN, file)) {
+		BatchItem* item = &items[count];
+		const size_t len = strlen(item->line);
+		(*lineNumber)++;
+
+		if (len > 0 && item->line[len - 1] != '\n' && !feof(file)) {
+			fprintf(stderr, "Line %"PRId64" is too long.\n", *lineNumber);
+			return -1;
+		}
+
+		const char* p = item->line;
+		while (*p == ' ' || *p == '\t') {
+			p++;
+		}
+
+		if (*p == '\0' || *p == '\n' || *p == '\r' || *p == '#') {
+			continue;
+		}
+
+		item->lineNumber = *lineNumber;
+		item->packed = NULL;
+		count++;
+	}
+
+	return count;
+}
+
+// As readChunk(), for a packed position file; no parsing is needed.
+static int32_t readPackedChunk(PackedFile* file, BatchItem* items, int64_t* lineNumber) {
+	int32_t count = 0;
+
+	while (count < BATCH_CHUNK_SIZE && (uint64_t) *lineNumber < file->count) {
+		BatchItem* item = &items[count++];
+		item->packed = file->positions + (uint64_t) *lineNumber * PACKED_POSITION_SIZE;
+		item->lineNumber = ++(*lineNumber);
+	}
+
+	return count;
+}
+
+bool batch_run(const char* fileName, BatchArgs* args) {
+	FILE* file = fopen(fileName, "r");
+	if (!file) {
+		perror("Unable to open batch file");
+		return false;
+	}
+
+	setvbuf(file, NULL, _IOFBF, BATCH_FILE_BUFFER);
+
+	// Packed position files are mapped and read in place.
+	PackedFile packedFile;
+	packedFile.mapping = NULL;
+	if (packedpos_isPackedFile(fileName) && !packedpos_open(fileName, &packedFile)) {
+		fclose(file);
+		return false;
+	}
+
+	const bool packed = packedFile.mapping != NULL;
+
+	const int32_t threads = args->threads;
+	BatchItem* items = ALLOC(BATCH_CHUNK_SIZE, BatchItem, items, "Unable to allocate batch items.");
+	BatchWorker* workers = ALLOC((size_t) threads, BatchWorker, workers, "Unable to allocate batch workers.");
+	BatchQueue queue;
+	queue.args = args;
+	queue.items = items;
+	pthread_mutex_init(&queue.lock, NULL);
+
+	for (int32_t i = 0; i < threads; i++) {
+		BatchWorker* worker = &workers[i];
+		worker->queue = &queue;
+		initializeGamestate(&worker->gameState);
+
+		if (args->mode == BATCH_SEARCH) {
+			hash_createZTable(&worker->zTable);
+			worker->gameState.zTable = &worker->zTable;
+			createSearchResult(&worker->searchResult);
+		}
+	}
+
+	bool result = true;
+	int64_t lineNumber = 0;
+	int32_t count;
+
+	while ((count = packed ? readPackedChunk(&packedFile, items, &lineNumber) : readChunk(file, items, &lineNumber)) > 0) {
+		queue.count = count;
+		queue.next = 0;
+
+		if (threads == 1) {
+			runWorker(&workers[0]);
+		} else {
+			for (int32_t i = 0; i < threads; i++) {
+				if (pthread_create(&workers[i].thread, NULL, runWorker, &workers[i]) != 0) {
+					perror("Unable to start batch worker");
+					exit(EXIT_FAILURE);
+				}
+			}
+
+			for (int32_t i = 0; i < threads; i++) {
+				pthread_join(workers[i].thread, NULL);
+			}
+		}
+
+		for (int32_t i = 0; i < count; i++) {
+			puts(items[i].result);
+		}
+	}
+
+	if (count < 0 || ferror(file)) {
+		result = false;
+	}
+
+	for (int32_t i = 0; i < threads; i++) {
+		BatchWorker* worker = &workers[i];
+
+		if (args->mode == BATCH_SEARCH) {
+			destroySearchResult(&worker->searchResult);
+			hash_destroyZTable(&worker->zTable);
+		}
+
+		destroyGamestate(&worker->gameState);
+	}
+
+	pthread_mutex_destroy(&queue.lock);
+	free(workers);
+	free(items);
+	packedpos_close(&packedFile);
+	fclose(file);
+	fflush(stdout);
+
+	return result;
+}
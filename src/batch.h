@@ -0,0 +1,45 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdbool.h>
+#include <inttypes.h>
+
+#define BATCH_EVALUATE  0
+#define BATCH_SEARCH    1
+
+// Options for a batch run over a file of FEN or EPD positions.
+typedef struct {
+	int32_t mode;       // BATCH_EVALUATE or BATCH_SEARCH.
+	int32_t depth;      // Search depth for BATCH_SEARCH.
+	int32_t threads;    // Number of worker threads, each with its own GameState.
+} BatchArgs;
+
+// Evaluates or searches every position in the file, one per line, and writes one JSON
+// result per position to stdout in input order. Blank lines and lines starting with '#'
+// are skipped. Packed position files (see packedpos.h) are also accepted, and mapped
+// rather than parsed. Returns false if the file can't be read.
+bool batch_run(const char* fileName, BatchArgs* args);
+
+#endif
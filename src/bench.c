@@ -0,0 +1,149 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#include "tulip.h"
+#include "bench.h"
+#include "gamestate.h"
+#include "fen.h"
+#include "hash.h"
+#include "json.h"
+#include "notation.h"
+#include "search.h"
+#include "util.h"
+#include "ztable.h"
+
+// Openings, middlegames with and without castling rights, tactical positions, and
+// endgames down to a handful of pieces. Changing this list changes the signature.
+static const char* BENCH_FENS[] = {
+	"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+	"rnbqkbnr/pp1ppppp/8/2p5/4P3/8/PPPP1PPP/RNBQKBNR w KQkq c6 0 2",
+	"rnbqkbnr/ppp2ppp/8/3pp3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq d6 0 3",
+	"r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3",
+	"r1bqkbnr/pppp1ppp/2n5/1B2p3/4P3/5N2/PPPP1PPP/RNBQK2R b KQkq - 3 3",
+	"r1bqkb1r/pppp1ppp/2n2n2/4p2Q/2B1P3/8/PPPP1PPP/RNB1K1NR w KQkq - 4 4",
+	"r1bqk2r/pppp1ppp/2n2n2/2b1p3/2B1P3/2N2N2/PPPP1PPP/R1BQK2R w KQkq - 4 5",
+	"rnbqkb1r/pp2pppp/3p1n2/8/3NP3/8/PPP2PPP/RNBQKB1R w KQkq - 1 5",
+	"rnbqkb1r/pp3ppp/4pn2/2pp4/2PP4/2N2N2/PP2PPPP/R1BQKB1R w KQkq - 0 5",
+	"rnbqk2r/ppp1ppbp/3p1np1/8/2PPP3/2N5/PP3PPP/R1BQKBNR w KQkq - 1 5",
+	"r1b1k2r/ppppnppp/2n2q2/2b5/3NP3/2P1B3/PP3PPP/RN1QKB1R w KQkq - 0 1",
+	"r2q1rk1/ppp2ppp/2np1n2/2b1p1B1/2B1P1b1/2NP1N2/PPP2PPP/R2Q1RK1 w - - 6 8",
+	"r1bq1rk1/pp2bppp/2n1pn2/2pp4/3P4/2PBPN2/PP1N1PPP/R1BQ1RK1 w - - 0 9",
+	"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+	"2rq1rk1/pb1nbppp/1p2pn2/2pp4/3P4/1P1BPN2/PBPN1PPP/2RQ1RK1 w - - 4 12",
+	"r1bbk1nr/pp3p1p/2n5/1N4p1/2Np1B2/8/PPP2PPP/2KR1B1R w kq - 0 13",
+	"r3r1k1/pp3pbp/1qp3p1/2B5/2BP2b1/Q1n2N2/P4PPP/3R1K1R b - - 0 17",
+	"3r1rk1/p4ppp/1pq1pn2/2b5/2P5/1P3N2/PB2QPPP/3R1RK1 w - - 0 18",
+	"4rrk1/pp1n3p/3q2pQ/2p1pb2/2PP4/2P3N1/P2B2PP/4RRK1 b - - 7 19",
+	"2kr3r/pp1q1ppp/5n2/1Nb5/2Pp1B2/7Q/P4PPP/1R3RK1 w - - 0 1",
+	"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+	"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+	"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+	"3r3k/2r4p/1p1b3q/p4P2/P2Pp3/1B2P3/3BQ1RP/6K1 w - - 0 1",
+	"6k1/3b3r/1p1p4/p1n2p2/1PPNpP1q/P3Q1p1/1R1RB1P1/5K2 b - - 0 1",
+	"r2r1n2/pp2bk2/2p1p2p/3q4/3PN1QP/2P3R1/P4PP1/5RK1 w - - 0 1",
+	"2r3k1/5pp1/p3p2p/1p1rP3/3N4/P5P1/1P3P1P/2R1R1K1 w - - 0 28",
+	"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+	"8/5pk1/6p1/1p5p/1P2P2P/5KP1/8/8 w - - 0 40",
+	"8/1p3pp1/7p/5P1P/2k3P1/8/2K2P2/8 w - - 0 1",
+	"6k1/5p2/6p1/8/7p/8/6PP/6K1 b - - 0 1",
+	"8/8/1P6/5pr1/8/4R3/7k/2K5 w - - 0 1",
+	"8/2p4P/8/kr6/6R1/8/8/1K6 w - - 0 1",
+	"8/R7/2q5/8/6k1/8/1P5p/K6R w - - 0 124",
+	"8/8/3P3k/8/1p6/8/1P6/1K3n2 b - - 0 1",
+	"8/8/8/8/5kp1/P7/8/1K1N4 w - - 0 1",
+	"8/8/8/5N2/8/p7/8/2NK3k w - - 0 1",
+	"8/3k4/8/8/8/4B3/4KB2/2B5 w - - 0 1",
+	"8/8/8/4k3/8/8/3R4/3K4 w - - 0 1",
+	"8/8/8/8/8/4k3/4P3/4K3 w - - 0 1",
+};
+
+int32_t bench_positionCount() {
+	return (int32_t) (sizeof(BENCH_FENS) / sizeof(BENCH_FENS[0]));
+}
+
+const char* bench_position(int32_t index) {
+	return BENCH_FENS[index];
+}
+
+void bench_run(int32_t depth) {
+	const int32_t count = bench_positionCount();
+	GameState state;
+	ZTable table;
+	SearchResult result;
+	char fen[128];
+	char moveStr[16];
+	int64_t totalNodes = 0;
+	int64_t totalNanos = 0;
+
+	initializeGamestate(&state);
+	hash_createZTable(&table);
+	state.zTable = &table;
+	createSearchResult(&result);
+
+	SearchArgs args;
+	initSearchArgs(&args);
+	args.depth = depth;
+	args.timeToThinkMillis = INT64_MAX; // The clock must never cut a search short, or the node count would vary.
+
+	for (int32_t i = 0; i < count; i++) {
+		snprintf(fen, sizeof(fen), "%s", BENCH_FENS[i]);
+		if (!parseFen(&state, fen)) {
+			fprintf(stderr, "Bench position %i is invalid: %s\n", i + 1, BENCH_FENS[i]);
+			exit(EXIT_FAILURE);
+		}
+
+		hash_clearZTable(&table);
+
+		const int64_t start = getMonotonicTimeNanos();
+		search(&state, &args, &result);
+		const int64_t elapsed = getMonotonicTimeNanos() - start;
+
+		totalNodes += result.nodes;
+		totalNanos += elapsed;
+
+		if (result.searchStatus == SEARCH_STATUS_NONE) {
+			notation_printShortAlg(&result.move, &state, moveStr);
+		} else {
+			snprintf(moveStr, sizeof(moveStr), "none");
+		}
+
+		fprintf(stderr, "Position %2i/%i: %-7s %10"PRId64" nodes %8.1f ms\n", i + 1, count, moveStr, result.nodes,
+		        (double) elapsed / 1e6);
+	}
+
+	const double seconds = (double) totalNanos / 1e9;
+	fprintf(stderr, "===========================\n");
+	fprintf(stderr, "Depth         : %i\n", depth);
+	fprintf(stderr, "Total nodes   : %"PRId64"\n", totalNodes);
+	fprintf(stderr, "Elapsed (ms)  : %"PRId64"\n", totalNanos / 1000000);
+	fprintf(stderr, "Nodes/second  : %.0f\n", seconds > 0 ? (double) totalNodes / seconds : 0.0);
+
+	printBenchResult(count, depth, totalNodes, totalNanos);
+
+	destroySearchResult(&result);
+	destroyGamestate(&state);
+	hash_destroyZTable(&table);
+}
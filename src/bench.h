@@ -0,0 +1,42 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdbool.h>
+#include <inttypes.h>
+
+#define BENCH_DEFAULT_DEPTH 4
+
+// Searches a fixed set of positions to the given depth, each from an empty transposition
+// table and without a time limit, so the total node count is the same on every run of a
+// given build. Progress and a summary go to stderr as text; the totals go to stdout as JSON.
+void bench_run(int32_t depth);
+
+// The number of positions in the benchmark list.
+int32_t bench_positionCount();
+
+// The FEN string of the benchmark position at the given index.
+const char* bench_position(int32_t index);
+
+#endif
@@ -723,4 +723,95 @@ extern const uint64_t BITS_PASSED_PAWN_B[144];
 
 // Bitmasks for ranks, files, etc, indexed by rank/file index.
 extern const uint64_t BITS_FILES[8];
+
+// Count the set bits in a bitboard. GCC and clang turn the builtin into a
+// single POPCNT instruction when the target has one (e.g. "make native");
+// otherwise this is a branch-free SWAR count.
+static inline int32_t countBits(uint64_t n) {
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__POPCNT__)
+    return (int32_t) __builtin_popcountll(n);
+#else
+    n = n - ((n >> 1) & (uint64_t) 0x5555555555555555);
+    n = (n & (uint64_t) 0x3333333333333333) + ((n >> 2) & (uint64_t) 0x3333333333333333);
+    n = (n + (n >> 4)) & (uint64_t) 0x0f0f0f0f0f0f0f0f;
+    return (int32_t) ((n * (uint64_t) 0x0101010101010101) >> 56);
+#endif
+}
+
+// Index (0 = A1, 63 = H8) of the least significant set bit. Undefined for 0.
+static inline int32_t lowestBitIndex(uint64_t n) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (int32_t) __builtin_ctzll(n);
+#else
+    // De Bruijn multiplication on the isolated low bit.
+    static const int32_t DEBRUIJN_INDEX[64] = {
+        0, 1, 48, 2, 57, 49, 28, 3, 61, 58, 50, 42, 38, 29, 17, 4,
+        62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12, 5,
+        63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+        46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19, 9, 13, 8, 7, 6
+    };
+    return DEBRUIJN_INDEX[((n & (0 - n)) * (uint64_t) 0x03f79d71b4cb0a89) >> 58];
+#endif
+}
+
+// Kogge-Stone occluded fills. Starting from the "generator" squares, these
+// smear each bit in one direction through the "propagator" squares (usually
+// the empty squares), stopping before the first square not in the propagator
+// set. The generator squares are included in the result. Directions that
+// move sideways mask off the file that a shifted bit would wrap around onto.
+#define BB_FILL(gen, pro, shift, wrap) \
+    do { \
+        pro &= (wrap); \
+        gen |= pro & shift(gen, 1); \
+        pro &= shift(pro, 1); \
+        gen |= pro & shift(gen, 2); \
+        pro &= shift(pro, 2); \
+        gen |= pro & shift(gen, 4); \
+    } while (0)
+
+#define BB_SHIFT_N(b, n)  ((b) << (8 * (n)))
+#define BB_SHIFT_S(b, n)  ((b) >> (8 * (n)))
+#define BB_SHIFT_NE(b, n) ((b) << (9 * (n)))
+#define BB_SHIFT_NW(b, n) ((b) << (7 * (n)))
+#define BB_SHIFT_SE(b, n) ((b) >> (7 * (n)))
+#define BB_SHIFT_SW(b, n) ((b) >> (9 * (n)))
+
+static inline uint64_t fillNorth(uint64_t gen, uint64_t pro) {
+    BB_FILL(gen, pro, BB_SHIFT_N, ~(uint64_t) 0);
+    return gen;
+}
+
+static inline uint64_t fillSouth(uint64_t gen, uint64_t pro) {
+    BB_FILL(gen, pro, BB_SHIFT_S, ~(uint64_t) 0);
+    return gen;
+}
+
+static inline uint64_t fillNorthEast(uint64_t gen, uint64_t pro) {
+    BB_FILL(gen, pro, BB_SHIFT_NE, ~BIT_FILE_A);
+    return gen;
+}
+
+static inline uint64_t fillNorthWest(uint64_t gen, uint64_t pro) {
+    BB_FILL(gen, pro, BB_SHIFT_NW, ~BIT_FILE_H);
+    return gen;
+}
+
+static inline uint64_t fillSouthEast(uint64_t gen, uint64_t pro) {
+    BB_FILL(gen, pro, BB_SHIFT_SE, ~BIT_FILE_A);
+    return gen;
+}
+
+static inline uint64_t fillSouthWest(uint64_t gen, uint64_t pro) {
+    BB_FILL(gen, pro, BB_SHIFT_SW, ~BIT_FILE_H);
+    return gen;
+}
+
+#undef BB_SHIFT_N
+#undef BB_SHIFT_S
+#undef BB_SHIFT_NE
+#undef BB_SHIFT_NW
+#undef BB_SHIFT_SE
+#undef BB_SHIFT_SW
+#undef BB_FILL
+
 #endif
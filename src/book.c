@@ -20,11 +20,15 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#define _POSIX_C_SOURCE 200112L // For mmap() and friends with -std=c99
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <inttypes.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #include <ctype.h>
 #include <unistd.h>
 
@@ -32,12 +36,31 @@
 #include "tulip.h"
 #include "gamestate.h"
 #include "move.h"
+#include "movegen.h"
+#include "makemove.h"
 #include "notation.h"
+#include "fen.h"
 #include "posix.h"
 #include "hashconsts.h"
+#include "util.h"
 
 #define BOOK_MAX_MOVES 256
 #define BOOK_MAX_STR_LEN 8
+#define MAX_BOOK_WEIGHT 0xFFFF
+
+static const char* INITIAL_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+static uint64_t recordHash(OpenBook* book, uint64_t index) {
+	return readLE64(book->records + index * BOOK_RECORD_SIZE);
+}
+
+static uint16_t recordMove(OpenBook* book, uint64_t index) {
+	return readLE16(book->records + index * BOOK_RECORD_SIZE + 8);
+}
+
+static uint16_t recordWeight(OpenBook* book, uint64_t index) {
+	return readLE16(book->records + index * BOOK_RECORD_SIZE + 10);
+}
 
 static void initializeStrArray(char*** array) {
 	*array = ALLOC(BOOK_MAX_MOVES, sizeof(char*), *array, "Unable to allocate memory for book move string array.");
@@ -47,7 +70,7 @@ static void initializeStrArray(char*** array) {
 }
 
 static void destroyStrArray(char*** array) {
-	for (int32_t i = 0; i < BOOK_MAX_STR_LEN; i++) {
+	for (int32_t i = 0; i < BOOK_MAX_MOVES; i++) {
 		free((*array)[i]);
 	}
 	free(*array);
@@ -74,6 +97,7 @@ static int readMoves(GameState* state, char*** strArray, OpenBook* book) {
 	char* line = calloc(lineLen, sizeof(char));
 	if (!line) {
 		perror("Error allocating memory for line buffer.");
+		free(sql);
 		return 0;
 	}
 
@@ -87,46 +111,416 @@ static int readMoves(GameState* state, char*** strArray, OpenBook* book) {
 				*idx-- = '\0';
 			}
 
-			strncpy((*strArray)[count++], line, lineLen);
+			snprintf((*strArray)[count++], BOOK_MAX_STR_LEN, "%s", line);
 		}
 
 		pclose(fp);
 	}
 
+	free(line);
+	free(sql);
 	return count;
 }
 
-bool book_open(const char* fileName, OpenBook* book) {
-	book->fileName = fileName;
-	return access(book->fileName, F_OK) == 0;
-}
-
-bool book_close(OpenBook* book) {
-	return true;
-}
-
-int book_getMoves(GameState* gameState, MoveBuffer* buffer, OpenBook* book) {
-	int32_t strCount;
+// Finds the SQLite book moves for a position; every move gets a weight of one.
+static int32_t findSqliteMoves(GameState* gameState, OpenBook* book, MoveBuffer* buffer, int32_t* weights) {
 	int32_t moveCount = 0;
 	char** strArray;
 	Move m;
 	initializeStrArray(&strArray);
 
 	// Get the move strings from the database
-	strCount = readMoves(gameState, &strArray, book);
+	const int32_t strCount = readMoves(gameState, &strArray, book);
 
 	// Parse the move strings and add the legal moves to the move buffer.
 	for (int32_t i = 0; i < strCount; i++) {
 		if (notation_matchMove(strArray[i], gameState, &m)) {
+			weights[moveCount] = 1;
 			buffer->moves[moveCount++] = m;
 		}
 	}
 
-	buffer->length = moveCount;
 	destroyStrArray(&strArray);
 	return moveCount;
 }
 
+// The index of the first record whose hash isn't less than the given hash.
+static uint64_t lowerBound(OpenBook* book, uint64_t hash) {
+	uint64_t low = 0;
+	uint64_t high = book->recordCount;
+	while (low < high) {
+		const uint64_t mid = low + (high - low) / 2;
+		if (recordHash(book, mid) < hash) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	return low;
+}
+
+static int32_t findBinaryMoves(GameState* gameState, OpenBook* book, MoveBuffer* buffer, int32_t* weights) {
+	const uint64_t hash = book_bookHash(gameState);
+	uint64_t index = lowerBound(book, hash);
+	if (index >= book->recordCount || recordHash(book, index) != hash) {
+		return 0;
+	}
+
+	MoveBuffer legalMoves;
+	createMoveBuffer(&legalMoves);
+	generateLegalMoves(gameState, &legalMoves);
+
+	// Records that don't match a legal move (a hash collision, most likely) are ignored.
+	int32_t moveCount = 0;
+	for (; index < book->recordCount && recordHash(book, index) == hash && moveCount < BOOK_MAX_MOVES; index++) {
+		const uint16_t packed = recordMove(book, index);
+		for (int32_t i = 0; i < legalMoves.length; i++) {
+			if (packMove(&legalMoves.moves[i]) == packed) {
+				weights[moveCount] = recordWeight(book, index);
+				buffer->moves[moveCount++] = legalMoves.moves[i];
+				break;
+			}
+		}
+	}
+
+	destroyMoveBuffer(&legalMoves);
+	return moveCount;
+}
+
+static int32_t findMoves(GameState* gameState, OpenBook* book, MoveBuffer* buffer, int32_t* weights) {
+	const int32_t count = book->format == BOOK_FORMAT_BINARY
+	                      ? findBinaryMoves(gameState, book, buffer, weights)
+	                      : findSqliteMoves(gameState, book, buffer, weights);
+	buffer->length = count;
+	return count;
+}
+
+// Maps a binary book. Returns false, without touching the book, if the file isn't one.
+static bool openBinary(const char* fileName, OpenBook* book, bool* corrupt) {
+	*corrupt = false;
+	const int fd = open(fileName, O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size < BOOK_HEADER_SIZE) {
+		close(fd);
+		return false;
+	}
+
+	const size_t size = (size_t) st.st_size;
+	void* mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (mapping == MAP_FAILED) {
+		return false;
+	}
+
+	const uint8_t* bytes = (const uint8_t*) mapping;
+	if (memcmp(bytes, BOOK_MAGIC, 8) != 0) {
+		munmap(mapping, size);
+		return false;
+	}
+
+	const uint64_t count = readLE64(bytes + 8);
+	if ((uint64_t) size != BOOK_HEADER_SIZE + count * BOOK_RECORD_SIZE) {
+		fprintf(stderr, "Book [%s] is truncated or corrupt.\n", fileName);
+		munmap(mapping, size);
+		*corrupt = true;
+		return false;
+	}
+
+	book->format = BOOK_FORMAT_BINARY;
+	book->mapping = mapping;
+	book->mappingSize = size;
+	book->records = bytes + BOOK_HEADER_SIZE;
+	book->recordCount = count;
+	return true;
+}
+
+bool book_open(const char* fileName, OpenBook* book) {
+	book->fileName = fileName;
+	book->format = BOOK_FORMAT_SQLITE;
+	book->mapping = NULL;
+	book->mappingSize = 0;
+	book->records = NULL;
+	book->recordCount = 0;
+
+	bool corrupt;
+	if (openBinary(fileName, book, &corrupt)) {
+		return true;
+	}
+
+	return !corrupt && access(book->fileName, F_OK) == 0;
+}
+
+bool book_close(OpenBook* book) {
+	if (book->mapping != NULL) {
+		munmap(book->mapping, book->mappingSize);
+		book->mapping = NULL;
+		book->records = NULL;
+		book->recordCount = 0;
+	}
+
+	return true;
+}
+
+int book_getMoves(GameState* gameState, MoveBuffer* buffer, OpenBook* book) {
+	int32_t weights[BOOK_MAX_MOVES];
+	return findMoves(gameState, book, buffer, weights);
+}
+
+bool book_chooseMove(GameState* gameState, OpenBook* book, Move* move) {
+	return book_chooseMoveWith(gameState, book, (uint64_t) rand(), move);
+}
+
+bool book_chooseMoveWith(GameState* gameState, OpenBook* book, uint64_t random, Move* move) {
+	int32_t weights[BOOK_MAX_MOVES];
+	MoveBuffer buffer;
+	createMoveBuffer(&buffer);
+	const int32_t count = findMoves(gameState, book, &buffer, weights);
+
+	int64_t total = 0;
+	for (int32_t i = 0; i < count; i++) {
+		total += weights[i];
+	}
+
+	// A position whose moves all have zero weight is in the book, but shouldn't be played from it.
+	const bool found = total > 0;
+	if (found) {
+		int64_t pick = (int64_t) (random % (uint64_t) total);
+		int32_t i = 0;
+		while (pick >= weights[i]) {
+			pick -= weights[i++];
+		}
+		*move = buffer.moves[i];
+	}
+
+	destroyMoveBuffer(&buffer);
+	return found;
+}
+
+static int compareBookEntries(const void* a, const void* b) {
+	const BookEntry* x = (const BookEntry*) a;
+	const BookEntry* y = (const BookEntry*) b;
+	if (x->hash != y->hash) {
+		return x->hash < y->hash ? -1 : 1;
+	}
+
+	return (int) x->move - (int) y->move;
+}
+
+int64_t book_writeBinary(const char* fileName, BookEntry* entries, int64_t count) {
+	qsort(entries, (size_t) count, sizeof(BookEntry), compareBookEntries);
+
+	// Merge duplicate moves in place.
+	int64_t unique = 0;
+	for (int64_t i = 0; i < count; i++) {
+		if (unique > 0 && entries[unique - 1].hash == entries[i].hash && entries[unique - 1].move == entries[i].move) {
+			const int32_t weight = entries[unique - 1].weight + entries[i].weight;
+			entries[unique - 1].weight = (uint16_t) MIN(weight, MAX_BOOK_WEIGHT);
+		} else {
+			entries[unique++] = entries[i];
+		}
+	}
+
+	FILE* fp = fopen(fileName, "wb");
+	if (!fp) {
+		perror("Unable to open book file for writing");
+		return -1;
+	}
+
+	uint8_t header[BOOK_HEADER_SIZE];
+	memcpy(header, BOOK_MAGIC, 8);
+	writeLE64(header + 8, (uint64_t) unique);
+	bool ok = fwrite(header, 1, sizeof(header), fp) == sizeof(header);
+
+	for (int64_t i = 0; i < unique && ok; i++) {
+		uint8_t record[BOOK_RECORD_SIZE];
+		memset(record, 0, sizeof(record));
+		writeLE64(record, entries[i].hash);
+		writeLE16(record + 8, entries[i].move);
+		writeLE16(record + 10, entries[i].weight);
+		ok = fwrite(record, 1, sizeof(record), fp) == sizeof(record);
+	}
+
+	ok = fclose(fp) == 0 && ok;
+	if (!ok) {
+		fprintf(stderr, "Error writing book file [%s]\n", fileName);
+		return -1;
+	}
+
+	return unique;
+}
+
+typedef struct {
+	uint64_t hash;
+	char move[BOOK_MAX_STR_LEN];
+} SqliteRow;
+
+// State for walking a SQLite book from the initial position.
+typedef struct {
+	SqliteRow* rows;        // Sorted by hash.
+	int64_t rowCount;
+	int64_t rowsReached;
+	uint64_t* visited;      // Open-addressed set of the position hashes already walked; 0 is empty.
+	uint64_t visitedMask;
+	BookEntry* entries;
+	int64_t entryCount;
+} Conversion;
+
+static int compareSqliteRows(const void* a, const void* b) {
+	const uint64_t x = ((const SqliteRow*) a)->hash;
+	const uint64_t y = ((const SqliteRow*) b)->hash;
+	return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+// Reads every row of the OPENING_BOOK table with a single sqlite3 process.
+static int64_t readSqliteRows(const char* fileName, SqliteRow** result) {
+	char command[1024];
+	snprintf(command, sizeof(command), "sqlite3 -separator '|' %s \"select POSITION_HASH, MOVE from OPENING_BOOK\"", fileName);
+
+	FILE* fp = popen(command, "r");
+	if (!fp) {
+		perror("Unable to run sqlite3");
+		return -1;
+	}
+
+	int64_t capacity = 1024;
+	int64_t count = 0;
+	SqliteRow* rows = ALLOC((size_t) capacity, SqliteRow, rows, "Unable to allocate book rows.");
+	char line[128];
+
+	while (fgets(line, sizeof(line), fp)) {
+		char* separator = strchr(line, '|');
+		if (separator == NULL) {
+			continue;
+		}
+
+		*separator = '\0';
+		char* move = separator + 1;
+		move[strcspn(move, "\r\n")] = '\0';
+
+		if (count == capacity) {
+			capacity *= 2;
+			rows = realloc(rows, (size_t) capacity * sizeof(SqliteRow));
+			if (!rows) {
+				perror("Unable to allocate book rows.");
+				exit(EXIT_FAILURE);
+			}
+		}
+
+		rows[count].hash = strtoull(line, NULL, 16);
+		snprintf(rows[count].move, BOOK_MAX_STR_LEN, "%s", move);
+		count++;
+	}
+
+	if (pclose(fp) != 0) {
+		fprintf(stderr, "Unable to read the OPENING_BOOK table from [%s]\n", fileName);
+		free(rows);
+		return -1;
+	}
+
+	qsort(rows, (size_t) count, sizeof(SqliteRow), compareSqliteRows);
+	*result = rows;
+	return count;
+}
+
+// Adds a hash to the visited set. Returns false if it was already there.
+static bool markVisited(Conversion* conversion, uint64_t hash) {
+	const uint64_t key = hash == 0 ? 1 : hash;
+	uint64_t slot = key & conversion->visitedMask;
+	while (conversion->visited[slot] != 0) {
+		if (conversion->visited[slot] == key) {
+			return false;
+		}
+		slot = (slot + 1) & conversion->visitedMask;
+	}
+
+	conversion->visited[slot] = key;
+	return true;
+}
+
+static void walkBook(GameState* state, Conversion* conversion) {
+	const uint64_t hash = book_bookHash(state);
+	if (!markVisited(conversion, hash)) {
+		return;
+	}
+
+	// Find the first row for this position.
+	int64_t low = 0;
+	int64_t high = conversion->rowCount;
+	while (low < high) {
+		const int64_t mid = low + (high - low) / 2;
+		if (conversion->rows[mid].hash < hash) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	for (int64_t i = low; i < conversion->rowCount && conversion->rows[i].hash == hash; i++) {
+		Move m;
+		if (!notation_matchMove(conversion->rows[i].move, state, &m)) {
+			continue;
+		}
+
+		conversion->rowsReached++;
+		BookEntry* entry = &conversion->entries[conversion->entryCount++];
+		entry->hash = hash;
+		entry->move = packMove(&m);
+		entry->weight = 1;
+
+		makeMove(state, &m);
+		walkBook(state, conversion);
+		unmakeMove(state, &m);
+	}
+}
+
+int64_t book_convertSqlite(const char* sqliteFile, const char* binaryFile) {
+	Conversion conversion;
+	conversion.rowCount = readSqliteRows(sqliteFile, &conversion.rows);
+	if (conversion.rowCount < 0) {
+		return -1;
+	}
+
+	uint64_t visitedSize = 1024;
+	while (visitedSize < (uint64_t) conversion.rowCount * 2) {
+		visitedSize *= 2;
+	}
+
+	conversion.rowsReached = 0;
+	conversion.visited = calloc(visitedSize, sizeof(uint64_t));
+	conversion.visitedMask = visitedSize - 1;
+	conversion.entries = ALLOC((size_t) MAX(conversion.rowCount, 1), BookEntry, conversion.entries, "Unable to allocate book entries.");
+	conversion.entryCount = 0;
+	if (!conversion.visited) {
+		perror("Unable to allocate the visited position set.");
+		exit(EXIT_FAILURE);
+	}
+
+	GameState state;
+	char fen[128];
+	snprintf(fen, sizeof(fen), "%s", INITIAL_FEN);
+	initializeGamestate(&state);
+	parseFen(&state, fen);
+	walkBook(&state, &conversion);
+	destroyGamestate(&state);
+
+	if (conversion.rowsReached < conversion.rowCount) {
+		fprintf(stderr, "Skipped %"PRId64" of %"PRId64" book rows not reachable from the initial position.\n",
+		        conversion.rowCount - conversion.rowsReached, conversion.rowCount);
+	}
+
+	const int64_t written = book_writeBinary(binaryFile, conversion.entries, conversion.entryCount);
+
+	free(conversion.entries);
+	free(conversion.visited);
+	free(conversion.rows);
+	return written;
+}
+
 uint64_t book_bookHash(GameState* gameState) {
    uint64_t h = 0;
 
@@ -146,3 +540,4 @@ uint64_t book_bookHash(GameState* gameState) {
 
 #undef BOOK_MAX_MOVES
 #undef BOOK_MAX_STR_LEN
+#undef MAX_BOOK_WEIGHT
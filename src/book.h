@@ -27,12 +27,38 @@
 #include "gamestate.h"
 #include "move.h"
 
+#define BOOK_FORMAT_BINARY 0
+#define BOOK_FORMAT_SQLITE 1
+
+// A binary book is a 16 byte header (the 8 byte magic "TULPBOOK" and a little-endian
+// 64-bit record count) followed by 16 byte little-endian records sorted by hash, then
+// move: a 64-bit book hash (see book_bookHash()), a 16-bit packed move (see packMove()),
+// a 16-bit weight and 32 reserved bits. The file is mapped into memory and probed with a
+// binary search.
+#define BOOK_MAGIC "TULPBOOK"
+#define BOOK_HEADER_SIZE 16
+#define BOOK_RECORD_SIZE 16
+
 // Structure defining a book. Essentially a "handle" to an open book.
 typedef struct {
         const char* fileName;
+        int32_t format;             // BOOK_FORMAT_BINARY, or BOOK_FORMAT_SQLITE for the older sqlite3 database.
+        const uint8_t* records;     // The mapped records of a binary book.
+        uint64_t recordCount;
+        void* mapping;              // The whole mapped file, for munmap().
+        size_t mappingSize;
 } OpenBook;
 
-// Opens a book given a file name. Returns true on success, else false.
+// An entry to be written to a binary book.
+typedef struct {
+        uint64_t hash;
+        uint16_t move;              // A packed move; see packMove().
+        uint16_t weight;            // Relative frequency; moves are chosen in proportion to it.
+} BookEntry;
+
+// Opens a book given a file name. Binary books are recognized by their header; any other
+// existing file is treated as a SQLite book and queried through the sqlite3 command.
+// Returns true on success, else false.
 bool book_open(const char* fileName, OpenBook* book);
 
 // Closes a book. Returns true on success, else false.
@@ -40,9 +66,27 @@ bool book_close(OpenBook* book);
 
 // Looks for moves in the book for the given position.
 // Places those moves in buffer, and returns the number of moves placed in the buffer.
-// Not suitable for tight loops.
+// Fast for binary books; SQLite books start a sqlite3 process on every call.
 int32_t book_getMoves(GameState* gameState, MoveBuffer* buffer, OpenBook* book);
 
+// Picks one of the book moves for the given position at random, in proportion to
+// their weights. Returns false if the position isn't in the book.
+bool book_chooseMove(GameState* gameState, OpenBook* book, Move* move);
+
+// As book_chooseMove(), but the choice is made from the given random number rather
+// than rand(), so callers with their own generator can reproduce it.
+bool book_chooseMoveWith(GameState* gameState, OpenBook* book, uint64_t random, Move* move);
+
+// Sorts the entries, merges duplicate moves by adding their weights, and writes them out
+// as a binary book. Returns the number of records written, or -1 on failure.
+int64_t book_writeBinary(const char* fileName, BookEntry* entries, int64_t count);
+
+// Converts the OPENING_BOOK table of a SQLite book to a binary book. The SQLite book only
+// stores position hashes, so the positions are recovered by walking every book line from
+// the initial position; rows that can't be reached that way are skipped.
+// Returns the number of records written, or -1 on failure.
+int64_t book_convertSqlite(const char* sqliteFile, const char* binaryFile);
+
 // Calculates a 64-bit book-specific hash. Similar to the normal hash, this
 // removes things like the EP file for better transposition detection.
 uint64_t book_bookHash(GameState* gameState);
@@ -0,0 +1,287 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "tulip.h"
+#include "bookbuild.h"
+#include "book.h"
+#include "fen.h"
+#include "gamestate.h"
+#include "makemove.h"
+#include "move.h"
+#include "notation.h"
+#include "pgn.h"
+#include "util.h"
+
+static const char* INITIAL_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+// How often a move was played from a position. A count of 0 marks an empty slot.
+typedef struct {
+	uint64_t hash;
+	uint32_t count;
+	uint16_t move;
+} MoveCount;
+
+// An open-addressed table of move counts, private to one worker.
+typedef struct {
+	MoveCount* slots;
+	uint64_t mask;
+	uint64_t size;
+} CountTable;
+
+typedef struct {
+	pthread_t thread;
+	BookBuildArgs* args;
+	const char* data;           // The games of this worker's slice of the file.
+	size_t length;
+	GameState gameState;
+	CountTable counts;
+	int64_t games;
+	int64_t errors;
+	int64_t positions;
+} BookWorker;
+
+static void createCountTable(CountTable* table, uint64_t capacity) {
+	table->slots = calloc(capacity, sizeof(MoveCount));
+	if (!table->slots) {
+		perror("Unable to allocate book move counts.");
+		exit(EXIT_FAILURE);
+	}
+
+	table->mask = capacity - 1;
+	table->size = 0;
+}
+
+static inline uint64_t countSlot(uint64_t hash, uint16_t move, uint64_t mask) {
+	return (hash ^ ((uint64_t) move * 0x9E3779B97F4A7C15ULL)) & mask;
+}
+
+static void addCount(CountTable* table, uint64_t hash, uint16_t move, uint32_t count);
+
+static void growCountTable(CountTable* table) {
+	CountTable larger;
+	createCountTable(&larger, (table->mask + 1) * 2);
+
+	for (uint64_t i = 0; i <= table->mask; i++) {
+		const MoveCount* mc = &table->slots[i];
+		if (mc->count > 0) {
+			addCount(&larger, mc->hash, mc->move, mc->count);
+		}
+	}
+
+	free(table->slots);
+	*table = larger;
+}
+
+static void addCount(CountTable* table, uint64_t hash, uint16_t move, uint32_t count) {
+	uint64_t slot = countSlot(hash, move, table->mask);
+
+	while (table->slots[slot].count > 0) {
+		MoveCount* mc = &table->slots[slot];
+		if (mc->hash == hash && mc->move == move) {
+			mc->count += count;
+			return;
+		}
+
+		slot = (slot + 1) & table->mask;
+	}
+
+	MoveCount* mc = &table->slots[slot];
+	mc->hash = hash;
+	mc->move = move;
+	mc->count = count;
+
+	// Keep the load under 3/4.
+	if (++table->size * 4 > (table->mask + 1) * 3) {
+		growCountTable(table);
+	}
+}
+
+// Replays the opening of one game, counting each move. Returns false if the game
+// couldn't be followed to the end of its opening.
+static bool replayGame(BookWorker* worker, PgnGame* game) {
+	GameState* state = &worker->gameState;
+	char fen[PGN_FEN_SIZE];
+	char token[32];
+	Move move;
+
+	snprintf(fen, sizeof(fen), "%s", game->fen[0] != '\0' ? game->fen : INITIAL_FEN);
+	if (!parseFenWithPrint(state, fen, false)) {
+		return false;
+	}
+
+	const char* cursor = game->moveText;
+	const int32_t plies = MIN(worker->args->plies, BOOKBUILD_MAX_PLIES);
+	for (int32_t ply = 0; ply < plies; ply++) {
+		if (!pgn_nextMove(&cursor, game->moveTextEnd, token, sizeof(token))) {
+			break;
+		}
+
+		if (!notation_matchMove(token, state, &move)) {
+			return false;
+		}
+
+		addCount(&worker->counts, book_bookHash(state), packMove(&move), 1);
+		worker->positions++;
+		makeMove(state, &move);
+	}
+
+	return true;
+}
+
+static void* runWorker(void* arg) {
+	BookWorker* worker = (BookWorker*) arg;
+	PgnReader reader;
+	PgnGame game;
+
+	pgn_initReader(&reader, worker->data, worker->length);
+	while (pgn_nextGame(&reader, &game)) {
+		worker->games++;
+		if (!replayGame(worker, &game)) {
+			worker->errors++;
+		}
+	}
+
+	return NULL;
+}
+
+static int compareMoveCounts(const void* a, const void* b) {
+	const MoveCount* x = (const MoveCount*) a;
+	const MoveCount* y = (const MoveCount*) b;
+	if (x->hash != y->hash) {
+		return x->hash < y->hash ? -1 : 1;
+	}
+
+	return (int) x->move - (int) y->move;
+}
+
+// Merges the workers' counts and writes the moves played at least minCount times.
+static int64_t writeBook(const char* bookFile, BookWorker* workers, int32_t threads, int32_t minCount) {
+	uint64_t total = 0;
+	for (int32_t i = 0; i < threads; i++) {
+		total += workers[i].counts.size;
+	}
+
+	MoveCount* all = ALLOC((size_t) MAX(total, 1), MoveCount, all, "Unable to allocate book move counts.");
+	uint64_t n = 0;
+	for (int32_t i = 0; i < threads; i++) {
+		const CountTable* table = &workers[i].counts;
+		for (uint64_t j = 0; j <= table->mask; j++) {
+			if (table->slots[j].count > 0) {
+				all[n++] = table->slots[j];
+			}
+		}
+
+		free(table->slots);
+		workers[i].counts.slots = NULL;
+	}
+
+	qsort(all, (size_t) n, sizeof(MoveCount), compareMoveCounts);
+
+	BookEntry* entries = ALLOC((size_t) MAX(n, 1), BookEntry, entries, "Unable to allocate book entries.");
+	int64_t entryCount = 0;
+	for (uint64_t i = 0; i < n;) {
+		const uint64_t hash = all[i].hash;
+		const uint16_t move = all[i].move;
+		uint64_t count = 0;
+		while (i < n && all[i].hash == hash && all[i].move == move) {
+			count += all[i++].count;
+		}
+
+		if (count >= (uint64_t) minCount) {
+			BookEntry* entry = &entries[entryCount++];
+			entry->hash = hash;
+			entry->move = move;
+			entry->weight = (uint16_t) MIN(count, UINT16_MAX);
+		}
+	}
+
+	free(all);
+	const int64_t written = book_writeBinary(bookFile, entries, entryCount);
+	free(entries);
+	return written;
+}
+
+bool bookbuild_run(const char* pgnFile, const char* bookFile, BookBuildArgs* args, BookBuildResult* result) {
+	PgnFile pgn;
+	if (!pgn_mapFile(pgnFile, &pgn)) {
+		perror("Unable to open PGN file");
+		return false;
+	}
+
+	const int64_t start = getCurrentTimeMillis();
+
+	// Each worker takes a contiguous slice of the file, split at game boundaries.
+	const int32_t threads = (int32_t) MIN((size_t) args->threads, MAX(pgn.length / 4096, 1));
+	BookWorker* workers = ALLOC((size_t) threads, BookWorker, workers, "Unable to allocate book workers.");
+	size_t sliceStart = 0;
+	for (int32_t i = 0; i < threads; i++) {
+		BookWorker* worker = &workers[i];
+		const size_t sliceEnd = i == threads - 1
+			? pgn.length
+			: pgn_findGameStart(pgn.data, pgn.length, pgn.length / (size_t) threads * (size_t) (i + 1));
+
+		worker->args = args;
+		worker->data = pgn.data + sliceStart;
+		worker->length = MAX(sliceEnd, sliceStart) - sliceStart;
+		worker->games = 0;
+		worker->errors = 0;
+		worker->positions = 0;
+		initializeGamestate(&worker->gameState);
+		createCountTable(&worker->counts, 1 << 16);
+		sliceStart = MAX(sliceEnd, sliceStart);
+	}
+
+	if (threads == 1) {
+		runWorker(&workers[0]);
+	} else {
+		for (int32_t i = 0; i < threads; i++) {
+			if (pthread_create(&workers[i].thread, NULL, runWorker, &workers[i]) != 0) {
+				perror("Unable to start book worker");
+				exit(EXIT_FAILURE);
+			}
+		}
+
+		for (int32_t i = 0; i < threads; i++) {
+			pthread_join(workers[i].thread, NULL);
+		}
+	}
+
+	memset(result, 0, sizeof(BookBuildResult));
+	for (int32_t i = 0; i < threads; i++) {
+		result->games += workers[i].games;
+		result->errors += workers[i].errors;
+		result->positions += workers[i].positions;
+		destroyGamestate(&workers[i].gameState);
+	}
+
+	pgn_unmapFile(&pgn);
+	result->records = writeBook(bookFile, workers, threads, args->minCount);
+	result->elapsedMillis = getCurrentTimeMillis() - start;
+	free(workers);
+
+	return result->records >= 0;
+}
@@ -0,0 +1,54 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef BOOKBUILD_H
+#define BOOKBUILD_H
+
+#include <stdbool.h>
+#include <inttypes.h>
+
+#define BOOKBUILD_DEFAULT_PLIES 14
+#define BOOKBUILD_MAX_PLIES 500     // A GameState can only replay so many moves.
+#define BOOKBUILD_MAX_THREADS 64
+
+// Options for building a book from a PGN file.
+typedef struct {
+	int32_t plies;              // Only the first this-many plies of each game go in the book.
+	int32_t threads;            // Workers replaying games in parallel, each with its own GameState.
+	int32_t minCount;           // Moves played fewer times than this are left out.
+} BookBuildArgs;
+
+// Totals for a book build.
+typedef struct {
+	int64_t games;              // Games read from the file.
+	int64_t errors;             // Games abandoned at an illegal or unreadable move or FEN.
+	int64_t positions;          // Book moves seen, counting repeats.
+	int64_t records;            // Records written to the book.
+	int64_t elapsedMillis;
+} BookBuildResult;
+
+// Replays the opening of every game in a PGN file and writes each (position, move)
+// played, weighted by how often it was played, to a binary book.
+// Returns false if the PGN can't be read or the book can't be written.
+bool bookbuild_run(const char* pgnFile, const char* bookFile, BookBuildArgs* args, BookBuildResult* result);
+
+#endif
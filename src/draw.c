@@ -20,106 +20,119 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
 #include <inttypes.h>
 
 #include "bitboard.h"
 #include "draw.h"
 #include "gamestate.h"
 #include "hashconsts.h"
+#include "material.h"
 #include "piece.h"
 #include "tulip.h"
 
-// Deal with king and arbitrary bishops vs king and arbitrary bishops.
-// If all the bishops are on the same color, and each side has at least
-// one bishop, and there are no other pieces, this is a draw.
-static inline bool moreThanFourPieces(GameState* g, const int32_t total) {
-	bool result = false;
-	const int32_t countWb = g->pieceCounts[ORD_WBISHOP];
-	const int32_t countBb = g->pieceCounts[ORD_BBISHOP];
+// True if every bishop on the board, of either color, stands on the same square color.
+static inline bool bishopsOnOneColor(GameState* g) {
+	const uint64_t bishops = g->bitboards[ORD_WBISHOP] | g->bitboards[ORD_BBISHOP];
+	return (bishops & BIT_SQUARES_LIGHT) == 0 || (bishops & BIT_SQUARES_DARK) == 0;
+}
 
-	if (countWb && countBb && (countWb + countBb + 2) == total) {
-		const uint64_t wbishop = g->bitboards[ORD_WBISHOP];
-		const uint64_t bbishop = g->bitboards[ORD_BBISHOP];
+bool draw_isMaterial(GameState* g) {
+	switch (material_probe(g)->drawType) {
+	case MATERIAL_DRAW: // KvK, KNvK or KBvK
+		return true;
+	case MATERIAL_DRAW_IF_BISHOPS_SAME_COLOR: // Kings and bishops, with bishops on both sides.
+		return bishopsOnOneColor(g);
+	default:
+		return false;
+	}
+}
 
-		const bool wbishopsOnLight = (BIT_SQUARES_LIGHT & wbishop) != 0;
-		const bool wbishopsOnDark = (BIT_SQUARES_DARK & wbishop) != 0;
-		const bool bbishopsOnLight = (BIT_SQUARES_LIGHT & bbishop) != 0;
-		const bool bbishopsOnDark = (BIT_SQUARES_DARK & bbishop) != 0;
+// Find the slot for the given hash: either the slot holding it, or the empty
+// slot where it would go. Linear probing.
+//
+// Clearing a slot when its count drops to zero is safe because pushes and pops
+// are strictly LIFO: every key inserted after this one (and so possibly probing
+// past it) has already been removed by the time this one is.
+static inline RepetitionEntry* findSlot(RepetitionTable* table, const uint64_t hash) {
+	uint32_t idx = (uint32_t) hash & (REPETITION_TABLE_SIZE - 1);
+	RepetitionEntry* e = &table->entries[idx];
+	while (e->count != 0 && e->hash != hash) {
+		idx = (idx + 1) & (REPETITION_TABLE_SIZE - 1);
+		e = &table->entries[idx];
+	}
+	return e;
+}
 
-		const bool allWBishopsOnSameColor = wbishopsOnLight ^ wbishopsOnDark;
-		const bool allBBishopsOnSameColor = bbishopsOnLight ^ bbishopsOnDark;
-		const bool allBishopsOnSameColor = ((wbishopsOnLight && bbishopsOnLight) || (wbishopsOnDark && bbishopsOnDark));
+void draw_pushPosition(GameState* g) {
+	RepetitionTable* table = &g->repetitions;
+	RepetitionEntry* e = findSlot(table, g->current->hash);
+	e->hash = g->current->hash;
+	e->count++;
+	if (g->current > table->searchRoot) {
+		e->treeCount++;
+	}
+}
 
-		result = allWBishopsOnSameColor && allBBishopsOnSameColor && allBishopsOnSameColor;
+void draw_popPosition(GameState* g) {
+	RepetitionTable* table = &g->repetitions;
+	RepetitionEntry* e = findSlot(table, g->current->hash);
+	e->count--;
+	if (g->current > table->searchRoot) {
+		e->treeCount--;
 	}
+}
 
-	return result;
+void draw_pushNullMove(GameState* g) {
+	g->repetitions.nullMoves++;
 }
 
-// Deal with KB vs KB with bishops on same square color.
-static inline bool fourPieces(GameState* g, const int32_t total) {
-	bool result = false;
+void draw_popNullMove(GameState* g) {
+	g->repetitions.nullMoves--;
+}
 
-	if (g->pieceCounts[ORD_WBISHOP] == 1 && g->pieceCounts[ORD_BBISHOP] == 1) {
-		const uint64_t wbishop = g->bitboards[ORD_WBISHOP];
-		const uint64_t bbishop = g->bitboards[ORD_BBISHOP];
-		result = ((BIT_SQUARES_LIGHT & wbishop) && (BIT_SQUARES_LIGHT & bbishop))
-				 || ((BIT_SQUARES_DARK & wbishop) && (BIT_SQUARES_DARK & bbishop));
-	}
+void draw_clearPositions(GameState* g) {
+	memset(g->repetitions.entries, 0, REPETITION_TABLE_SIZE * sizeof(RepetitionEntry));
+	g->repetitions.nullMoves = 0;
+	draw_clearSearchRoot(g);
+}
 
-	return result;
+void draw_setSearchRoot(GameState* g) {
+	g->repetitions.searchRoot = g->current;
 }
 
-static inline bool threePieces(GameState* g, const int32_t total) {
-	// If there are three pieces, two must be kings.
-	// That means there's one non-king piece.
-	// If that one piece is a knight or bishop of any color, we're in a draw.
-	return g->pieceCounts[ORD_WBISHOP] > 0
-		   || g->pieceCounts[ORD_BBISHOP] > 0
-		   || g->pieceCounts[ORD_WKNIGHT] > 0
-		   || g->pieceCounts[ORD_WKNIGHT] > 0;
+void draw_clearSearchRoot(GameState* g) {
+	g->repetitions.searchRoot = &g->dataStack[_GS_STACK_SIZE - 1];
 }
 
-bool draw_isMaterial(GameState* g) {
-	const int32_t total = g->current->whitePieceCount + g->current->blackPieceCount;
-	bool result;
-	switch (total) {
-	case 4: // Exactly four pieces looks for KBvKB with same-color bishops.
-		result = fourPieces(g, total);
-		break;
-	case 3:
-		result = threePieces(g, total); // Look for KNvK or KBvK
-		break;
-	case 2:
-		result = true; // Two pieces means KvK, a draw.
-		break;
-	default:
-		result = moreThanFourPieces(g, total); // Look for kings and bishops where bishops are same-color.
-		break;
+bool draw_isThreefold(GameState* g) {
+	return findSlot(&g->repetitions, g->current->hash)->count >= 3;
+}
+
+bool draw_isSearchRepetition(GameState* g) {
+	// A side passed somewhere on this line, so a match with an earlier position is an
+	// artifact of the lost tempo rather than a repetition.
+	if (g->repetitions.nullMoves > 0) {
+		return false;
 	}
 
-	return result;
+	// treeCount >= 1 puts the current occurrence inside the tree; count >= 2 means the
+	// position also occurred earlier, in the tree, at the root or in the game history.
+	const RepetitionEntry* e = findSlot(&g->repetitions, g->current->hash);
+	return e->count >= 3 || (e->treeCount >= 1 && e->count >= 2);
 }
 
-bool draw_isThreefold(GameState* g) {
-	StateData* currentData = g->current;
-	const uint64_t startingHash = currentData->hash;
-	bool result = false;
-	int32_t repeatCount = 0;
-	const int limit = MIN(currentData->fiftyMoveCount, currentData->halfMoveCount);
-
-	for (int32_t i = 0; i < limit; i++) {
-		currentData--;
-		const uint64_t currentHash = currentData->hash;
-		// Hash changes with toMove, so compare the hash with either white to move or black to move.
-		if (currentHash == startingHash || (currentHash ^ HASH_WHITE_TO_MOVE) == startingHash) {
-			repeatCount++;
-			if (repeatCount == 2) {
-				result = true;
-				break;
-			}
-		}
+void draw_createRepetitionTable(RepetitionTable* table) {
+	table->entries = calloc(REPETITION_TABLE_SIZE, sizeof(RepetitionEntry));
+	if (!table->entries) {
+		perror("Unable to allocate repetition table.");
+		exit(-1);
 	}
+	table->nullMoves = 0;
+}
 
-	return result;
+void draw_destroyRepetitionTable(RepetitionTable* table) {
+	free(table->entries);
 }
@@ -31,4 +31,37 @@ bool draw_isMaterial(GameState* g);
 // Determines if the given game state is in a threefold repetition draw situation.
 bool draw_isThreefold(GameState* g);
 
+// Determines if the current position should be scored as a repetition draw in search:
+// either a threefold repetition, or a position inside the search tree that has already
+// occurred on the current line, the root and the game history included. The side that
+// steered back into it can repeat it again at will. Nothing counts after a null move.
+bool draw_isSearchRepetition(GameState* g);
+
+// Record the current position in the repetition table. Called by makeMove().
+void draw_pushPosition(GameState* g);
+
+// Remove the current position from the repetition table. Called by unmakeMove()
+// before it pops the state stack; positions must be popped in the reverse order
+// they were pushed.
+void draw_popPosition(GameState* g);
+
+// Note a null move on the current line. Called by makeNullMove() and unmakeNullMove().
+// Null move positions aren't recorded: they never occur in a real game.
+void draw_pushNullMove(GameState* g);
+void draw_popNullMove(GameState* g);
+
+// Forget every position in the repetition table and clear the search root.
+void draw_clearPositions(GameState* g);
+
+// Mark the current position as the root of a search. Positions reached after
+// this count towards twofold repetition in draw_isSearchRepetition().
+void draw_setSearchRoot(GameState* g);
+
+// Stop treating any position as inside the search tree.
+void draw_clearSearchRoot(GameState* g);
+
+// Allocate and free the repetition table.
+void draw_createRepetitionTable(RepetitionTable* table);
+void draw_destroyRepetitionTable(RepetitionTable* table);
+
 #endif
@@ -0,0 +1,204 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <inttypes.h>
+
+#include "epd.h"
+
+#define EPD_POSITION_FIELDS 4
+#define EPD_FEN_FIELDS 6
+
+// Finds the next whitespace-delimited field, storing its start and length. Returns the
+// position just past the field, or NULL if there are no more fields.
+static const char* nextField(const char* p, const char** start, size_t* len) {
+	while (*p && isspace((unsigned char) *p)) {
+		p++;
+	}
+
+	if (!*p) {
+		return NULL;
+	}
+
+	*start = p;
+	while (*p && !isspace((unsigned char) *p)) {
+		p++;
+	}
+
+	*len = (size_t) (p - *start);
+	return p;
+}
+
+static bool isCounter(const char* str, size_t len) {
+	for (size_t i = 0; i < len; i++) {
+		if (!isdigit((unsigned char) str[i])) {
+			return false;
+		}
+	}
+
+	return len > 0;
+}
+
+// Copies the FEN portion of the line. Returns the position just past the fields that were
+// consumed, or NULL if the line doesn't start with a position.
+static const char* parsePosition(const char* line, char* fen, size_t size) {
+	const char* fields[EPD_FEN_FIELDS];
+	size_t lengths[EPD_FEN_FIELDS];
+	const char* ends[EPD_FEN_FIELDS];
+	int32_t count = 0;
+	const char* p = line;
+
+	while (count < EPD_FEN_FIELDS && (p = nextField(p, &fields[count], &lengths[count]))) {
+		ends[count++] = p;
+	}
+
+	if (count < EPD_POSITION_FIELDS) {
+		return NULL;
+	}
+
+	const bool hasCounters = count == EPD_FEN_FIELDS && isCounter(fields[4], lengths[4]) && isCounter(fields[5], lengths[5]);
+	const int32_t fieldCount = hasCounters ? EPD_FEN_FIELDS : EPD_POSITION_FIELDS;
+	size_t pos = 0;
+
+	for (int32_t i = 0; i < fieldCount; i++) {
+		if (pos + lengths[i] + 2 > size) {
+			return NULL;
+		}
+
+		if (i > 0) {
+			fen[pos++] = ' ';
+		}
+
+		memcpy(fen + pos, fields[i], lengths[i]);
+		pos += lengths[i];
+	}
+
+	fen[pos] = '\0';
+
+	if (!hasCounters) {
+		if (pos + 5 > size) {
+			return NULL;
+		}
+
+		strcpy(fen + pos, " 0 1");
+	}
+
+	return ends[fieldCount - 1];
+}
+
+bool epd_toFen(const char* line, char* fen, size_t size) {
+	return parsePosition(line, fen, size) != NULL;
+}
+
+// Reads one opcode name or operand into out (truncating to size). Operands may be quoted.
+// Returns the position after it, or NULL at the end of the line.
+static const char* readToken(const char* p, char* out, size_t size, bool* endOfOpcode) {
+	size_t len = 0;
+
+	while (*p && isspace((unsigned char) *p)) {
+		p++;
+	}
+
+	if (!*p) {
+		return NULL;
+	}
+
+	*endOfOpcode = false;
+
+	if (*p == ';') {
+		*endOfOpcode = true;
+		out[0] = '\0';
+		return p + 1;
+	}
+
+	if (*p == '"') {
+		for (p++; *p && *p != '"'; p++) {
+			if (len + 1 < size) {
+				out[len++] = *p;
+			}
+		}
+
+		if (*p == '"') {
+			p++;
+		}
+	} else {
+		for (; *p && *p != ';' && !isspace((unsigned char) *p); p++) {
+			if (len + 1 < size) {
+				out[len++] = *p;
+			}
+		}
+	}
+
+	out[len] = '\0';
+	return p;
+}
+
+static void copyTruncated(char* dest, const char* src, size_t size) {
+	size_t i = 0;
+	for (; i + 1 < size && src[i]; i++) {
+		dest[i] = src[i];
+	}
+
+	dest[i] = '\0';
+}
+
+bool epd_parse(const char* line, EpdRecord* record) {
+	char opcode[EPD_ID_LEN];
+	char operand[EPD_ID_LEN];
+	bool endOfOpcode;
+
+	record->id[0] = '\0';
+	record->bestMoveCount = 0;
+	record->avoidMoveCount = 0;
+
+	const char* p = parsePosition(line, record->fen, sizeof(record->fen));
+	if (!p) {
+		return false;
+	}
+
+	while ((p = readToken(p, opcode, sizeof(opcode), &endOfOpcode))) {
+		if (endOfOpcode) {
+			continue; // A stray semicolon.
+		}
+
+		int32_t operands = 0;
+		while ((p = readToken(p, operand, sizeof(operand), &endOfOpcode)) && !endOfOpcode) {
+			if (strcmp(opcode, "bm") == 0 && record->bestMoveCount < EPD_MAX_MOVES) {
+				copyTruncated(record->bestMoves[record->bestMoveCount++], operand, EPD_MOVE_LEN);
+			} else if (strcmp(opcode, "am") == 0 && record->avoidMoveCount < EPD_MAX_MOVES) {
+				copyTruncated(record->avoidMoves[record->avoidMoveCount++], operand, EPD_MOVE_LEN);
+			} else if (strcmp(opcode, "id") == 0 && operands == 0) {
+				copyTruncated(record->id, operand, EPD_ID_LEN);
+			}
+
+			operands++;
+		}
+
+		if (!p) {
+			return false; // The last opcode is missing its semicolon.
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,56 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef EPD_H
+#define EPD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <inttypes.h>
+
+#define EPD_FEN_LEN 128
+#define EPD_ID_LEN 64
+#define EPD_MOVE_LEN 16
+#define EPD_MAX_MOVES 8
+
+// The parts of an EPD record used by the test-suite runner.
+typedef struct {
+	char fen[EPD_FEN_LEN];
+	char id[EPD_ID_LEN];                            // The "id" opcode, or empty.
+	char bestMoves[EPD_MAX_MOVES][EPD_MOVE_LEN];    // Operands of "bm", in SAN.
+	int32_t bestMoveCount;
+	char avoidMoves[EPD_MAX_MOVES][EPD_MOVE_LEN];   // Operands of "am", in SAN.
+	int32_t avoidMoveCount;
+} EpdRecord;
+
+// Extracts a FEN string from a line of an EPD or FEN file. EPD records carry only the first
+// four FEN fields (board, side to move, castling, en passant) followed by opcodes, so the
+// move counters default to "0 1" unless the line supplies them. Returns false if the line
+// doesn't begin with four position fields or the result doesn't fit in size bytes.
+bool epd_toFen(const char* line, char* fen, size_t size);
+
+// Parses an EPD record: the position fields followed by opcodes, each of which is a name,
+// zero or more operands (bare or double-quoted) and a terminating semicolon. The bm, am
+// and id opcodes are kept and the rest ignored. Returns false on a malformed record.
+bool epd_parse(const char* line, EpdRecord* record);
+
+#endif
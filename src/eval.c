@@ -27,18 +27,12 @@
 #include "board.h"
 #include "gamestate.h"
 #include "evalconsts.h"
+#include "evalparams.h"
 #include "bitboard.h"
 #include "piece.h"
 #include "eval.h"
-
-static inline int32_t countBits(uint64_t n) {
-	// Thank you, Brian Kernighan!
-	int32_t c;
-	for (c = 0; n; c++) {
-		n &= n - 1;
-	}
-	return c;
-}
+#include "pawns.h"
+#include "material.h"
 
 static inline int32_t kingMovesBetweenSquares(int32_t sq1, int32_t sq2) {
 	const int32_t r1 = RANK_IDX(sq1);
@@ -55,308 +49,252 @@ static inline int32_t kingMovesBetweenSquares(int32_t sq1, int32_t sq2) {
 }
 
 // Determine if the given square shares a file with the given rook or queen.
-static inline int32_t onSameFileWithPowerPiece(GameState* gs, int32_t sq, int32_t ordinalRook, int32_t ordinalQueen) {
+static inline bool onSameFileWithPowerPiece(GameState* gs, int32_t sq, int32_t ordinalRook, int32_t ordinalQueen) {
 	uint64_t* bb = gs->bitboards;
 	const int32_t file = FILE_IDX(sq);
 	const uint64_t fileMask = BITS_FILES[file] & ~BITS_SQ[sq];
-	const bool onRank = ((fileMask & bb[ordinalRook]) != 0) | ((fileMask & bb[ordinalQueen]) != 0);
-	return onRank ? BONUS_RQ_SHARE_RANK : 0;
+	return ((fileMask & bb[ordinalRook]) != 0) | ((fileMask & bb[ordinalQueen]) != 0);
 }
 
 // The idea here is to penalize open long diagonals or files leading to the king.
 // We'll count the open squares of diagonals and files leading "towards" the enemy side of the board.
-#define COUNT_DIRECTION(offset) sp = sq + (offset); while(b[sp]->ordinal == ORD_EMPTY) {sp += (offset); count++;}
-static inline int exposureWhite(const Piece** b, int32_t sq) {
-	int32_t count = 0;
-	int32_t sp;
-
-	COUNT_DIRECTION(OFFSET_N);
-	COUNT_DIRECTION(OFFSET_NE);
-	COUNT_DIRECTION(OFFSET_NW);
-
-	return count;
+// The rays from a single square are disjoint, so the fills can be OR'd before counting;
+// the king's own square is in every fill and is subtracted once.
+static inline int32_t exposureWhite(const uint64_t empty, const uint64_t king) {
+	return countBits(fillNorth(king, empty) | fillNorthEast(king, empty) | fillNorthWest(king, empty)) - 1;
 }
 
-static inline int32_t exposureBlack(const Piece** b, int sq) {
-	int32_t count = 0;
-	int32_t sp;
-
-	COUNT_DIRECTION(OFFSET_S);
-	COUNT_DIRECTION(OFFSET_SE);
-	COUNT_DIRECTION(OFFSET_SW);
-
-	return count;
+static inline int32_t exposureBlack(const uint64_t empty, const uint64_t king) {
+	return countBits(fillSouth(king, empty) | fillSouthEast(king, empty) | fillSouthWest(king, empty)) - 1;
 }
 
-static inline int32_t bishopMobility(const Piece** b, int sq) {
-	// TODO: Figure out some leet way to do this with bitboards.
-	int32_t count = 0;
-	int32_t sp;
-
-	COUNT_DIRECTION(OFFSET_NE);
-	COUNT_DIRECTION(OFFSET_SE);
-	COUNT_DIRECTION(OFFSET_NW);
-	COUNT_DIRECTION(OFFSET_SW);
-
-	return count;
+// Count the empty squares each bishop can slide to, summed over all the given bishops.
+// A bishop's ray in a given direction stops at the first occupied square, so two bishops'
+// rays in the same direction never overlap and each direction can be filled set-wise.
+static inline int32_t bishopMobility(const uint64_t empty, const uint64_t bishops) {
+	return countBits(fillNorthEast(bishops, empty) & ~bishops)
+	       + countBits(fillNorthWest(bishops, empty) & ~bishops)
+	       + countBits(fillSouthEast(bishops, empty) & ~bishops)
+	       + countBits(fillSouthWest(bishops, empty) & ~bishops);
 }
-#undef COUNT_DIRECTION
 
 int32_t countKingRectangleSize(int sq) {
 	// TODO: Consider if calculating is faster than lookup.
 	return KING_RECT_SIZES[sq];
 }
 
-// Compute the raw material score ignoring position.
-static inline int32_t materialScore(GameState* g) {
-	int* counts = g->pieceCounts;
-	int score = 0;
+void computeStaticScores(GameState* g, int32_t* mgScore, int32_t* egScore) {
+	int32_t mg = 0;
+	int32_t eg = 0;
 
-	score += (counts[ORD_WPAWN] - counts[ORD_BPAWN]) * SCORE_PAWN;
-	score += (counts[ORD_WKNIGHT] - counts[ORD_BKNIGHT]) * SCORE_KNIGHT;
-	score += (counts[ORD_WBISHOP] - counts[ORD_BBISHOP]) * SCORE_BISHOP;
-	score += (counts[ORD_WROOK] - counts[ORD_BROOK]) * SCORE_ROOK;
-	score += (counts[ORD_WQUEEN] - counts[ORD_BQUEEN]) * SCORE_QUEEN;
+	for (int32_t i = 0; i < 64; i++) {
+		const int32_t sq = BOARD_SQUARES[i];
+		const int32_t ord = g->board[sq]->ordinal;
+		mg += PSQ_MG(ord, sq);
+		eg += PSQ_EG(ord, sq);
+	}
+
+	*mgScore = mg;
+	*egScore = eg;
+}
 
-	return score;
+int32_t computePhase(GameState* g) {
+	int32_t phase = 0;
+	for (int32_t ord = 0; ord < ORD_MAX; ord++) {
+		phase += g->pieceCounts[ord] * PIECE_PHASES[ord];
+	}
+	return phase;
 }
 
 int32_t classifyEndgame(GameState* g) {
-	StateData* sd = g->current;
-	int32_t* counts = g->pieceCounts;
+	return material_probe(g)->endgameType;
+}
+
+// Score for the side with the extra material in a mating endgame: drive the
+// weak king towards the target squares and bring the strong king up to help.
+#define MOP_UP(weakKing, strongKing) (EVAL_PARAMS->kingEndgameDistance * kingMovesBetweenSquares((weakKing), (strongKing)))
 
-	// Remove pawn counts from this calculation
-	const int32_t wPieces = sd->whitePieceCount - counts[ORD_WPAWN];
-	const int32_t bPieces = sd->blackPieceCount - counts[ORD_BPAWN];
+int32_t evaluateKXK(GameState* state) {
+	StateData* sd = state->current;
 
-	if (wPieces + bPieces == 3) {
-		// This is the one situation where I don't put braces on my ifs.
-		if (counts[ORD_BROOK] || counts[ORD_BQUEEN]) return ENDGAME_BROOKvKING;
-		if (counts[ORD_WROOK] || counts[ORD_WQUEEN]) return ENDGAME_WROOKvKING;
+	// If in a rook endgame, penalize having the kings far apart.
+	// This is to encourage the player with the advantage to push the king up
+	// into a normal checkmate position.
+	// Also penalize the player with the advantage for leaving the opposing king near the center of the board.
+	if (sd->blackPieceCount == 1) {
+		return sd->egScore
+		       + MOP_UP(sd->blackKingSquare, sd->whiteKingSquare)
+		       + EVAL_PARAMS->kingEndgameRectangle * countKingRectangleSize(sd->blackKingSquare);
+	} else {
+		return sd->egScore
+		       - MOP_UP(sd->whiteKingSquare, sd->blackKingSquare)
+		       - EVAL_PARAMS->kingEndgameRectangle * countKingRectangleSize(sd->whiteKingSquare);
 	}
+}
 
-	return ENDGAME_UNCLASSIFIED;
+// Distance from the king to the nearer of the two corners the bishop can cover.
+static inline int32_t kbnkCornerDistance(const int32_t kingSq, const uint64_t bishops) {
+	const bool light = (bishops & BIT_SQUARES_LIGHT) != 0;
+	const int32_t c1 = light ? SQ_A8 : SQ_A1;
+	const int32_t c2 = light ? SQ_H1 : SQ_H8;
+	return MIN(kingMovesBetweenSquares(kingSq, c1), kingMovesBetweenSquares(kingSq, c2));
 }
 
-static inline int32_t basicWPawnBonus(const int32_t sq, const Piece** board, uint64_t* bb) {
-	int32_t score = 0;
-	score += SQ_SCORE_PAWN_OPENING_WHITE[sq];
-	if (board[sq + OFFSET_N] == &WPAWN) {
-		score += PENALTY_DOUBLED_PAWN;
-	}
+int32_t evaluateKBNK(GameState* state) {
+	StateData* sd = state->current;
+	uint64_t* bb = state->bitboards;
 
-	// If the squares to the SE or SW are also white pawns, add a bonus.
-	const uint64_t defendingPawns = bb[ORD_WPAWN] & BITS_WPAWN[sq];
-	if (defendingPawns) {
-		score += PAWN_CHAIN_BONUS;
+	// Mate is only possible in a corner the bishop controls.
+	if (sd->blackPieceCount == 1) {
+		return sd->egScore
+		       + MOP_UP(sd->blackKingSquare, sd->whiteKingSquare)
+		       + EVAL_PARAMS->kbnkCorner * kbnkCornerDistance(sd->blackKingSquare, bb[ORD_WBISHOP]);
+	} else {
+		return sd->egScore
+		       - MOP_UP(sd->whiteKingSquare, sd->blackKingSquare)
+		       - EVAL_PARAMS->kbnkCorner * kbnkCornerDistance(sd->whiteKingSquare, bb[ORD_BBISHOP]);
 	}
-	return score;
 }
 
-static inline int32_t basicBPawnBonus(const int32_t sq, const Piece** board, uint64_t* bb) {
-	int32_t score = 0;
-	score += SQ_SCORE_PAWN_OPENING_BLACK[sq];
-	if (board[sq + OFFSET_S] == &BPAWN) {
-		score += PENALTY_DOUBLED_PAWN;
+#undef MOP_UP
+
+// Score a lone pawn against a bare king from the pawn's side. The pawn is
+// described from its own point of view: ranks to go, and a step toward promotion.
+static int32_t kpkScore(const int32_t pawnSq, const int32_t ranksToGo, const int32_t forward,
+                        const int32_t promoteSq, const int32_t weakKingSq, const bool weakToMove) {
+	// Rule of the square. A pawn on its starting rank can move two squares.
+	const int32_t pawnMoves = ranksToGo == 6 ? 5 : ranksToGo;
+	const int32_t kingMoves = kingMovesBetweenSquares(weakKingSq, promoteSq) - (weakToMove ? 1 : 0);
+	const int32_t base = EVAL_PARAMS->pawn + EVAL_PARAMS->kpkPawnAdvance * (6 - ranksToGo);
+
+	if (kingMoves > pawnMoves) {
+		return base + EVAL_PARAMS->kpkUnstoppable;
 	}
 
-	// If the squares to the NE or NW are also black pawns, add a bonus.
-	const uint64_t defendingPawns = bb[ORD_BPAWN] & BITS_BPAWN[sq];
-	if (defendingPawns) {
-		score += PAWN_CHAIN_BONUS;
+	// With the defending king in front of the pawn the result is usually a draw.
+	for (int32_t sq = pawnSq + forward; sq != promoteSq + forward; sq += forward) {
+		if (sq == weakKingSq) {
+			return base / KPK_BLOCKED_DIVISOR;
+		}
 	}
 
-	return score;
+	return base;
 }
 
-int32_t evaluateOpening(GameState* state) {
-	const Piece** board = state->board;
-	int32_t score = materialScore(state);
+int32_t evaluateKPK(GameState* state) {
+	StateData* sd = state->current;
 	uint64_t* bb = state->bitboards;
 
-	uint64_t mobilityWhite = 0;
-	uint64_t mobilityBlack = 0;
-
-	for (int32_t sq = SQ_A1; sq <= SQ_H8; sq++) {
-		const Piece* p = board[sq];
-
-		switch (p->ordinal) {
-		case ORD_WPAWN:
-			score += basicWPawnBonus(sq, board, bb);
-			break;
-		case ORD_BPAWN:
-			score -= basicBPawnBonus(sq, board, bb);
-			break;
-		case ORD_WKNIGHT:
-			score += SQ_SCORE_KNIGHT_OPENING_WHITE[sq];
-			mobilityWhite |= BITS_KNIGHT[sq];
-			break;
-		case ORD_BKNIGHT:
-			score -= SQ_SCORE_KNIGHT_OPENING_BLACK[sq];
-			mobilityBlack |= BITS_KNIGHT[sq];
-			break;
-		case ORD_WBISHOP:
-			score += bishopMobility(board, sq) * MINOR_PIECE_MOBILITY_BONUS;
-			break;
-		case ORD_BBISHOP:
-			score -= bishopMobility(board, sq) * MINOR_PIECE_MOBILITY_BONUS;
-			break;
-		case ORD_WQUEEN:
-			score += SQ_SCORE_QUEEN_OPENING_WHITE[sq];
-			break;
-		case ORD_BQUEEN:
-			score -= SQ_SCORE_QUEEN_OPENING_BLACK[sq];
-			break;
-		case ORD_WKING:
-			score += KING_EXPOSURE * exposureWhite(board, sq);
-			break;
-		case ORD_BKING:
-			score -= KING_EXPOSURE * exposureBlack(board, sq);
-			break;
-		default:
-			break;
-		}
+	if (bb[ORD_WPAWN]) {
+		const int32_t sq = BOARD_SQUARES[lowestBitIndex(bb[ORD_WPAWN])];
+		return kpkScore(sq, RANK_8 - RANK_IDX(sq), OFFSET_N, B_IDX(FILE_IDX(sq), RANK_8),
+		                sd->blackKingSquare, sd->toMove == COLOR_BLACK);
+	} else {
+		const int32_t sq = BOARD_SQUARES[lowestBitIndex(bb[ORD_BPAWN])];
+		return -kpkScore(sq, RANK_IDX(sq) - RANK_1, OFFSET_S, B_IDX(FILE_IDX(sq), RANK_1),
+		                 sd->whiteKingSquare, sd->toMove == COLOR_WHITE);
 	}
-
-	// Remove any mobility score that refers to a square covered by a friendly pawn.
-	mobilityWhite &= ~bb[ORD_WPAWN];
-	mobilityBlack &= ~bb[ORD_BPAWN];
-
-	score += MINOR_PIECE_MOBILITY_BONUS * (countBits(mobilityWhite) - countBits(mobilityBlack));
-
-	return score;
 }
 
-static int32_t evaluateMidgame(GameState* state) {
-	const Piece** board = state->board;
-	int32_t score = materialScore(state);
-	uint64_t* bb = state->bitboards;
-	uint64_t mobilityWhite = 0;
-	uint64_t mobilityBlack = 0;
-	for (int32_t sq = SQ_A1; sq <= SQ_H8; sq++) {
-		const Piece* p = board[sq];
-
-		switch (p->ordinal) {
-		case ORD_WPAWN:
-			score += basicWPawnBonus(sq, board, bb);
-			break;
-		case ORD_BPAWN:
-			score -= basicBPawnBonus(sq, board, bb);
-			break;
-		case ORD_WKNIGHT:
-			mobilityWhite |= BITS_KNIGHT[sq];
-			break;
-		case ORD_BKNIGHT:
-			mobilityBlack |= BITS_KNIGHT[sq];
-			break;
-		default:
-			break;
-		}
+// Union of the knight moves from every knight on the given bitboard.
+static inline uint64_t knightMobility(uint64_t knights) {
+	uint64_t moves = 0;
+	while (knights) {
+		moves |= BITS_KNIGHT[BOARD_SQUARES[lowestBitIndex(knights)]];
+		knights &= knights - 1;
 	}
+	return moves;
+}
 
-	// Remove any mobility score that refers to a square covered by a friendly pawn.
-	mobilityWhite &= ~bb[ORD_WPAWN];
-	mobilityBlack &= ~bb[ORD_BPAWN];
-
-	score += MINOR_PIECE_MOBILITY_BONUS * (countBits(mobilityWhite) - countBits(mobilityBlack));
-
-	return score;
+// The number of the given rooks sharing a file with another rook or a queen.
+static inline int32_t rookFileCount(GameState* state, uint64_t rooks, int32_t ordinalRook, int32_t ordinalQueen) {
+	int32_t count = 0;
+	while (rooks) {
+		count += onSameFileWithPowerPiece(state, BOARD_SQUARES[lowestBitIndex(rooks)], ordinalRook, ordinalQueen) ? 1 : 0;
+		rooks &= rooks - 1;
+	}
+	return count;
 }
 
-#define KING_DISTANCE_PENALTY() (kingMovesBetweenSquares(sd->whiteKingSquare, sd->blackKingSquare)) * KING_ENDGAME_DISTANCE_PENALTY
+#define KING_DISTANCE_PENALTY() (kingMovesBetweenSquares(sd->whiteKingSquare, sd->blackKingSquare)) * params->kingEndgameDistance
 
-static int32_t evaluateEndgame(GameState* state) {
-	const Piece** board = state->board;
-	int32_t score = materialScore(state);
-	uint64_t* bb = state->bitboards;
+int32_t evaluate(GameState* state) {
 	StateData* sd = state->current;
-	uint64_t mobilityWhite = 0;
-	uint64_t mobilityBlack = 0;
+	uint64_t* bb = state->bitboards;
+	const uint64_t empty = bb[ORD_EMPTY];
+	const uint64_t wPawns = bb[ORD_WPAWN];
+	const uint64_t bPawns = bb[ORD_BPAWN];
+	const EvalParams* params = EVAL_PARAMS;
+
+	// Each term goes into the middlegame score, the endgame score, or (via
+	// "shared") both. The two are blended by the game phase at the end.
+	int32_t mg = sd->mgScore;
+	int32_t eg = sd->egScore;
+	int32_t shared = 0;
+
+	const int32_t mult = sd->toMove == COLOR_WHITE ? 1 : -1;
+
+	const MaterialEntry* material = material_probe(state);
+	if (material->endgame != NULL) {
+		return mult * material->endgame(state);
+	}
 
-	const int endgame = classifyEndgame(state);
+	mg += material->mgImbalance;
+	eg += material->egImbalance;
 
-	// If in a rook endgame, penalize having the kings far apart.
-	// This is to encourage the player with the advantage to push the king up
-	// into a normal checkmate position.
-	// Also penalize the player with the advantage for leaving the opposing king near the center of the board.
+	// Rook (or queen) endgames that still have pawns on the board don't get the
+	// specialized evaluation, but the same mop-up terms apply.
+	const int32_t endgame = material->endgameType;
 	if (endgame == ENDGAME_WROOKvKING) {
-		score += KING_DISTANCE_PENALTY();
-		score += KING_ENDGAME_RECTANGLE_PENALTY * countKingRectangleSize(sd->blackKingSquare);
+		eg += KING_DISTANCE_PENALTY();
+		eg += params->kingEndgameRectangle * countKingRectangleSize(sd->blackKingSquare);
 	} else if (endgame == ENDGAME_BROOKvKING) {
-		score -= KING_DISTANCE_PENALTY();
-		score -= KING_ENDGAME_RECTANGLE_PENALTY * countKingRectangleSize(sd->whiteKingSquare);
+		eg -= KING_DISTANCE_PENALTY();
+		eg -= params->kingEndgameRectangle * countKingRectangleSize(sd->whiteKingSquare);
 	}
 
-	for (int32_t sq = SQ_A1; sq <= SQ_H8; sq++) {
-		const Piece* p = board[sq];
-
-		switch (p->ordinal) {
-		case ORD_WPAWN:
-			if ((BITS_PASSED_PAWN_W[sq] & state->bitboards[ORD_BPAWN]) == 0) {
-				score += SCORE_PASSED_PAWN;
-			}
-			break;
-		case ORD_BPAWN:
-			if ((BITS_PASSED_PAWN_B[sq] & state->bitboards[ORD_WPAWN]) == 0) {
-				score -= SCORE_PASSED_PAWN;
-			}
-			break;
-		case ORD_WKNIGHT:
-			mobilityWhite |= BITS_KNIGHT[sq];
-			break;
-		case ORD_BKNIGHT:
-			mobilityBlack |= BITS_KNIGHT[sq];
-			break;
-		case ORD_WROOK:
-			score += onSameFileWithPowerPiece(state, sq, ORD_WROOK, ORD_WQUEEN);
-			break;
-		case ORD_BROOK:
-			score -= onSameFileWithPowerPiece(state, sq, ORD_BROOK, ORD_BQUEEN);
-			break;
-		case ORD_WKING:
-			score += SQ_SCORE_ENDGAME_KING[sq];
-			break;
-		case ORD_BKING:
-			score -= SQ_SCORE_ENDGAME_KING[sq];
-			break;
-		default:
-			break;
-		}
-	}
+	const PawnEntry* pawns = pawns_probe(state);
+	mg += pawns->mgScore;
+	eg += pawns->egScore;
 
-	// Remove squares covered by pawns from the mobility mask.
-	// Having a friendly pawn structure that inhibits bishop and knight moves is a liability.
-	mobilityWhite &= ~bb[ORD_WPAWN];
-	mobilityBlack &= ~bb[ORD_BPAWN];
+	eg += params->rqShareRank * (rookFileCount(state, bb[ORD_WROOK], ORD_WROOK, ORD_WQUEEN)
+	                             - rookFileCount(state, bb[ORD_BROOK], ORD_BROOK, ORD_BQUEEN));
 
-	score += MINOR_PIECE_MOBILITY_BONUS * (countBits(mobilityWhite) - countBits(mobilityBlack));
+	// Remove any mobility score that refers to a square covered by a friendly pawn.
+	// Having a friendly pawn structure that inhibits knight moves is a liability.
+	const uint64_t mobilityWhite = knightMobility(bb[ORD_WKNIGHT]) & ~wPawns;
+	const uint64_t mobilityBlack = knightMobility(bb[ORD_BKNIGHT]) & ~bPawns;
+	shared += params->minorMobility * (countBits(mobilityWhite) - countBits(mobilityBlack));
 
-	return score;
-}
+	mg += params->minorMobility * (bishopMobility(empty, bb[ORD_WBISHOP]) - bishopMobility(empty, bb[ORD_BBISHOP]));
+	mg += params->kingExposure * (exposureWhite(empty, BITS_SQ[sd->whiteKingSquare]) - exposureBlack(empty, BITS_SQ[sd->blackKingSquare]));
 
-#undef KING_DISTANCE_PENALTY
+	const int32_t phase = material->phase;
+	const int32_t result = shared + (mg * phase + eg * (PHASE_MAX - phase)) / PHASE_MAX;
 
-int32_t evaluate(GameState* state) {
-	StateData* current = state->current;
+	return mult * result;
+}
 
-	const int32_t totalPieces = current->whitePieceCount
-	                            + current->blackPieceCount
-	                            - state->pieceCounts[ORD_WPAWN]
-	                            - state->pieceCounts[ORD_BPAWN];
+#undef KING_DISTANCE_PENALTY
 
-	int32_t result;
+bool evaluateTrace(GameState* state, EvalTrace* trace) {
+	StateData* sd = state->current;
+	uint64_t* bb = state->bitboards;
+	const uint64_t empty = bb[ORD_EMPTY];
 
-	if (totalPieces >= 12) {
-		result = evaluateOpening(state);
-	} else if (totalPieces >= 6) {
-		result = evaluateMidgame(state);
-	} else {
-		result = evaluateEndgame(state);
+	const MaterialEntry* material = material_probe(state);
+	if (material->endgame != NULL) {
+		return false;
 	}
 
-	const int32_t mult = state->current->toMove == COLOR_WHITE ? 1 : -1;
-
-	return mult * result;
+	trace->phase = material->phase;
+	trace->knightMobility = countBits(knightMobility(bb[ORD_WKNIGHT]) & ~bb[ORD_WPAWN])
+	                        - countBits(knightMobility(bb[ORD_BKNIGHT]) & ~bb[ORD_BPAWN]);
+	trace->bishopMobility = bishopMobility(empty, bb[ORD_WBISHOP]) - bishopMobility(empty, bb[ORD_BBISHOP]);
+	trace->kingExposure = exposureWhite(empty, BITS_SQ[sd->whiteKingSquare]) - exposureBlack(empty, BITS_SQ[sd->blackKingSquare]);
+	trace->rookFiles = rookFileCount(state, bb[ORD_WROOK], ORD_WROOK, ORD_WQUEEN)
+	                   - rookFileCount(state, bb[ORD_BROOK], ORD_BROOK, ORD_BQUEEN);
+	return true;
 }
 
 double friendlyScore(GameState* state, int32_t rawScore) {
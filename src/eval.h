@@ -34,11 +34,42 @@
 // If black is to move, a positive number is good for black.
 int32_t evaluate(GameState* state);
 
+// Counts of the evaluation terms that evaluate() computes itself, each white minus
+// black. The tuner uses these to treat the evaluation as a weighted sum.
+typedef struct {
+	int32_t phase;              // The game phase the middlegame and endgame scores are blended by.
+	int32_t knightMobility;     // Scored in both phases.
+	int32_t bishopMobility;     // Middlegame only.
+	int32_t kingExposure;       // Middlegame only.
+	int32_t rookFiles;          // Rooks sharing a file with a rook or queen; endgame only.
+} EvalTrace;
+
+// Fills in the term counts of the position. Returns false if the position is scored by a
+// specialized endgame evaluation instead.
+bool evaluateTrace(GameState* state, EvalTrace* trace);
+
 // Take an internal represntation of a score (integer, according to the side to
 // move) and return a friendly version (double, with white advantage > 0 and
 // black advantage < 0).
 double friendlyScore(GameState* state, int32_t rawScore);
 
+// Computes the middlegame and endgame material + piece-square scores of the
+// given state from scratch. makeMove() keeps these up to date in StateData
+// incrementally; this is for setting up a new position and for verification.
+// SLOW. Do not use in tight loops.
+void computeStaticScores(GameState* state, int32_t* mgScore, int32_t* egScore);
+
+// Computes the game phase of the given state from its piece counts: PHASE_MAX
+// with all minor and major pieces on the board, falling towards 0 as they come
+// off. The material table caches this per material signature.
+int32_t computePhase(GameState* state);
+
+// Specialized evaluations for endgames against a bare king, chosen by the
+// material table. Each returns a white-relative score.
+int32_t evaluateKXK(GameState* state);  // Lone rook or queen vs king
+int32_t evaluateKBNK(GameState* state); // Bishop and knight vs king
+int32_t evaluateKPK(GameState* state);  // Pawn vs king
+
 // Classify an endgame into one of several general types.
 int32_t classifyEndgame(GameState* state);
 
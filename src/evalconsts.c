@@ -19,6 +19,7 @@
 #include <inttypes.h>
 
 #include "eval.h"
+#include "evalconsts.h"
 
 // Generate these with the board_scores.py script in /utils.
 
@@ -37,21 +38,6 @@ const int32_t SQ_SCORE_PAWN_OPENING_WHITE[144] = {
 	0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
 };
 
-const int32_t SQ_SCORE_PAWN_OPENING_BLACK[144] = {
-	0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
-	0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
-	0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
-	0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
-	0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
-	0,    0,    0,    0,    0,   20,   20,    0,    0,    0,    0,    0,
-	0,    0,    0,    0,    8,   20,   20,    8,    0,    0,    0,    0,
-	0,    0,    0,    0,   10,   10,   10,   10,    0,    0,    0,    0,
-	0,    0,    0,    0,   -5,  -10,  -10,   -5,    0,    0,    0,    0,
-	0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
-	0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
-	0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
-};
-
 const int32_t SQ_SCORE_KNIGHT_OPENING_WHITE[144] = {
 	0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
 	0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
@@ -67,21 +53,6 @@ const int32_t SQ_SCORE_KNIGHT_OPENING_WHITE[144] = {
 	0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
 };
 
-const int32_t SQ_SCORE_KNIGHT_OPENING_BLACK[144] = {
-	0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
-	0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
-	0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
-	0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
-	0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
-	0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
-	0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
-	0,    0,  -10,    0,   10,    0,    0,   10,    0,  -10,    0,    0,
-	0,    0,  -10,    0,    0,    5,    0,    5,    0,  -10,    0,    0,
-	0,    0,  -20,   -5,    0,    0,    0,    0,   -5,  -20,    0,    0,
-	0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
-	0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
-};
-
 const int32_t SQ_SCORE_ENDGAME_KING[144] = {
 	0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
 	0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
@@ -112,21 +83,6 @@ const int32_t SQ_SCORE_QUEEN_OPENING_WHITE[144] = {
 	0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
 };
 
-const int32_t SQ_SCORE_QUEEN_OPENING_BLACK[144] = {
-	0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
-	0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
-	0,    0,  -10,  -10,  -10,  -10,  -10,  -10,  -10,  -10,    0,    0,
-	0,    0,  -10,  -10,  -10,  -10,  -10,  -10,  -10,  -10,    0,    0,
-	0,    0,  -10,  -10,  -10,  -10,  -10,  -10,  -10,  -10,    0,    0,
-	0,    0,  -10,  -10,  -10,  -10,  -10,  -10,  -10,  -10,    0,    0,
-	0,    0,  -10,  -10,  -10,  -10,  -10,  -10,  -10,  -10,    0,    0,
-	0,    0,  -10,  -10,  -10,  -10,  -10,  -10,  -10,  -10,    0,    0,
-	0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
-	0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
-	0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
-	0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
-};
-
 const int32_t KING_RECT_SIZES[144] = {
 	0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
 	0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
@@ -141,3 +97,23 @@ const int32_t KING_RECT_SIZES[144] = {
 	0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
 	0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
 };
+
+const int32_t PIECE_SIGNS[ORD_MAX + 1] = {
+	1, -1,
+	1, -1,
+	1, -1,
+	1, -1,
+	1, -1,
+	1, -1,
+	0, 0,
+};
+
+const int32_t PIECE_PHASES[ORD_MAX + 1] = {
+	0, 0,
+	PHASE_KNIGHT, PHASE_KNIGHT,
+	PHASE_BISHOP, PHASE_BISHOP,
+	PHASE_ROOK, PHASE_ROOK,
+	PHASE_QUEEN, PHASE_QUEEN,
+	0, 0,
+	0, 0,
+};
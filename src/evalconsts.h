@@ -25,6 +25,11 @@
 
 #include <inttypes.h>
 
+#include "piece.h"
+
+// The compiled-in evaluation weights. The evaluation reads the active set through
+// EVAL_PARAMS (see evalparams.h), which a parameter file can override at runtime.
+
 // Basic piece values
 #define SCORE_PAWN      100
 #define SCORE_KNIGHT    300
@@ -47,24 +52,63 @@
 // Bonus for having a pawn defending another pawn
 #define PAWN_CHAIN_BONUS 6
 
+// Penalty for a pawn with no friendly pawns on either adjacent file.
+#define PENALTY_ISOLATED_PAWN_MG -10
+#define PENALTY_ISOLATED_PAWN_EG -15
+
+// Penalty for a pawn whose advance square is attacked by an enemy pawn, and
+// which no friendly pawn can move up to defend.
+#define PENALTY_BACKWARD_PAWN_MG -8
+#define PENALTY_BACKWARD_PAWN_EG -8
+
+// Bonus for a pawn on a half-open file that has enough support to force its way through.
+#define SCORE_CANDIDATE_PASSER_MG 5
+#define SCORE_CANDIDATE_PASSER_EG 20
+
 // Penalty designed to promote moving kings inward in KRvK and KQvK endgames
 #define KING_ENDGAME_DISTANCE_PENALTY -20
 
 // Penalty designed to promote moving the opposing king to the corners of the board in KRvK and KQvK endgames
 #define KING_ENDGAME_RECTANGLE_PENALTY -20
 
+// Bonus for owning both bishops.
+#define BONUS_BISHOP_PAIR_MG 25
+#define BONUS_BISHOP_PAIR_EG 50
+
+// Per king-move penalty for the bare king's distance from a corner the bishop controls in KBNvK.
+#define KBNK_CORNER_PENALTY -20
+
+// Bonus in KPvK for a pawn the defending king can't catch, and per rank advanced.
+#define KPK_UNSTOPPABLE_BONUS 600
+#define KPK_PAWN_ADVANCE_BONUS 10
+
+// KPvK with the defending king in front of the pawn is scaled down by this much.
+#define KPK_BLOCKED_DIVISOR 8
+
 // A per-square penalty for opening a king on files and diagonals.
 #define KING_EXPOSURE -3
 
 extern const int32_t KING_RECT_SIZES[144];
+// Opening piece-square tables from white's point of view. Black's are mirrored
+// when the tables in EVAL_PARAMS are built.
 extern const int32_t SQ_SCORE_PAWN_OPENING_WHITE[144];
-extern const int32_t SQ_SCORE_PAWN_OPENING_BLACK[144];
-extern const int32_t SQ_SCORE_KNIGHT_OPENING_BLACK[144];
 extern const int32_t SQ_SCORE_KNIGHT_OPENING_WHITE[144];
 extern const int32_t SQ_SCORE_QUEEN_OPENING_WHITE[144];
-extern const int32_t SQ_SCORE_QUEEN_OPENING_BLACK[144];
 
 // A board square array to encourage driving enemy kings to the edge of the
 // board in the endgame.
 extern const int32_t SQ_SCORE_ENDGAME_KING[144];
+
+// Contribution of each minor and major piece to the game phase used to blend
+// middlegame and endgame scores. The starting position has a phase of PHASE_MAX.
+#define PHASE_KNIGHT 1
+#define PHASE_BISHOP 1
+#define PHASE_ROOK   2
+#define PHASE_QUEEN  4
+#define PHASE_MAX    24
+
+// PIECE_SIGNS is +1 for white pieces, -1 for black pieces and 0 for everything else.
+extern const int32_t PIECE_SIGNS[ORD_MAX + 1];
+extern const int32_t PIECE_PHASES[ORD_MAX + 1];
+
 #endif
@@ -0,0 +1,322 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#define _POSIX_C_SOURCE 200112L // For posix_memalign() with -std=c99
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <ctype.h>
+#include <errno.h>
+
+#include "tulip.h"
+#include "evalparams.h"
+#include "evalconsts.h"
+#include "board.h"
+
+typedef struct {
+	const char* name;
+	size_t offset;
+	int32_t count;
+} ParamField;
+
+#define SCALAR(name, field) {name, offsetof(EvalParams, field), 1}
+#define TABLE(name, field) {name, offsetof(EvalParams, field), 64}
+
+// Every weight a parameter file can set, in the order they're written.
+static const ParamField FIELDS[] = {
+	SCALAR("SCORE_PAWN", pawn),
+	SCALAR("SCORE_KNIGHT", knight),
+	SCALAR("SCORE_BISHOP", bishop),
+	SCALAR("SCORE_ROOK", rook),
+	SCALAR("SCORE_QUEEN", queen),
+	SCALAR("PENALTY_DOUBLED_PAWN", doubledPawn),
+	SCALAR("PAWN_CHAIN_BONUS", pawnChain),
+	SCALAR("SCORE_PASSED_PAWN", passedPawn),
+	SCALAR("PENALTY_ISOLATED_PAWN_MG", isolatedPawnMg),
+	SCALAR("PENALTY_ISOLATED_PAWN_EG", isolatedPawnEg),
+	SCALAR("PENALTY_BACKWARD_PAWN_MG", backwardPawnMg),
+	SCALAR("PENALTY_BACKWARD_PAWN_EG", backwardPawnEg),
+	SCALAR("SCORE_CANDIDATE_PASSER_MG", candidatePasserMg),
+	SCALAR("SCORE_CANDIDATE_PASSER_EG", candidatePasserEg),
+	SCALAR("MINOR_PIECE_MOBILITY_BONUS", minorMobility),
+	SCALAR("BONUS_RQ_SHARE_RANK", rqShareRank),
+	SCALAR("KING_EXPOSURE", kingExposure),
+	SCALAR("BONUS_BISHOP_PAIR_MG", bishopPairMg),
+	SCALAR("BONUS_BISHOP_PAIR_EG", bishopPairEg),
+	SCALAR("KING_ENDGAME_DISTANCE_PENALTY", kingEndgameDistance),
+	SCALAR("KING_ENDGAME_RECTANGLE_PENALTY", kingEndgameRectangle),
+	SCALAR("KBNK_CORNER_PENALTY", kbnkCorner),
+	SCALAR("KPK_UNSTOPPABLE_BONUS", kpkUnstoppable),
+	SCALAR("KPK_PAWN_ADVANCE_BONUS", kpkPawnAdvance),
+	TABLE("SQ_SCORE_PAWN_OPENING", pawnSquares),
+	TABLE("SQ_SCORE_KNIGHT_OPENING", knightSquares),
+	TABLE("SQ_SCORE_QUEEN_OPENING", queenSquares),
+	TABLE("SQ_SCORE_ENDGAME_KING", kingSquares),
+};
+
+#undef SCALAR
+#undef TABLE
+
+#define FIELD_COUNT ((int32_t) (sizeof(FIELDS) / sizeof(FIELDS[0])))
+
+const EvalParams* EVAL_PARAMS = NULL;
+
+static EvalParams* allocParams(void) {
+	void* params = NULL;
+	if (posix_memalign(&params, EVAL_PARAMS_ALIGNMENT, sizeof(EvalParams)) != 0) {
+		perror("Unable to allocate evaluation parameters.");
+		exit(EXIT_FAILURE);
+	}
+	return (EvalParams*) params;
+}
+
+static void activate(EvalParams* params) {
+	EvalParams* previous = (EvalParams*) EVAL_PARAMS;
+	EVAL_PARAMS = params;
+	free(previous);
+}
+
+void evalparams_init(void) {
+	EvalParams* params = allocParams();
+	evalparams_setDefaults(params);
+	activate(params);
+}
+
+void evalparams_setDefaults(EvalParams* params) {
+	memset(params, 0, sizeof(EvalParams));
+
+	params->pawn = SCORE_PAWN;
+	params->knight = SCORE_KNIGHT;
+	params->bishop = SCORE_BISHOP;
+	params->rook = SCORE_ROOK;
+	params->queen = SCORE_QUEEN;
+	params->minorMobility = MINOR_PIECE_MOBILITY_BONUS;
+	params->rqShareRank = BONUS_RQ_SHARE_RANK;
+	params->kingExposure = KING_EXPOSURE;
+	params->kingEndgameDistance = KING_ENDGAME_DISTANCE_PENALTY;
+	params->kingEndgameRectangle = KING_ENDGAME_RECTANGLE_PENALTY;
+	params->doubledPawn = PENALTY_DOUBLED_PAWN;
+	params->pawnChain = PAWN_CHAIN_BONUS;
+	params->passedPawn = SCORE_PASSED_PAWN;
+	params->isolatedPawnMg = PENALTY_ISOLATED_PAWN_MG;
+	params->isolatedPawnEg = PENALTY_ISOLATED_PAWN_EG;
+	params->backwardPawnMg = PENALTY_BACKWARD_PAWN_MG;
+	params->backwardPawnEg = PENALTY_BACKWARD_PAWN_EG;
+	params->candidatePasserMg = SCORE_CANDIDATE_PASSER_MG;
+	params->candidatePasserEg = SCORE_CANDIDATE_PASSER_EG;
+	params->bishopPairMg = BONUS_BISHOP_PAIR_MG;
+	params->bishopPairEg = BONUS_BISHOP_PAIR_EG;
+	params->kbnkCorner = KBNK_CORNER_PENALTY;
+	params->kpkUnstoppable = KPK_UNSTOPPABLE_BONUS;
+	params->kpkPawnAdvance = KPK_PAWN_ADVANCE_BONUS;
+
+	for (int32_t i = 0; i < 64; i++) {
+		const int32_t sq = BOARD_SQUARES[i];
+		params->pawnSquares[i] = SQ_SCORE_PAWN_OPENING_WHITE[sq];
+		params->knightSquares[i] = SQ_SCORE_KNIGHT_OPENING_WHITE[sq];
+		params->queenSquares[i] = SQ_SCORE_QUEEN_OPENING_WHITE[sq];
+		params->kingSquares[i] = SQ_SCORE_ENDGAME_KING[sq];
+	}
+
+	evalparams_update(params);
+}
+
+void evalparams_update(EvalParams* params) {
+	const int32_t values[ORD_MAX + 1] = {
+		params->pawn, params->pawn,
+		params->knight, params->knight,
+		params->bishop, params->bishop,
+		params->rook, params->rook,
+		params->queen, params->queen,
+		0, 0,
+		0, 0,
+	};
+
+	memset(params->psqMg, 0, sizeof(params->psqMg));
+	memset(params->psqEg, 0, sizeof(params->psqEg));
+
+	for (int32_t ord = 0; ord <= ORD_MAX; ord++) {
+		if (PIECE_SIGNS[ord] == 0) {
+			continue;
+		}
+
+		for (int32_t i = 0; i < 64; i++) {
+			const int32_t sq = BOARD_SQUARES[i];
+			const int32_t own = PIECE_SIGNS[ord] > 0 ? i : i ^ 56;
+			int32_t mg = values[ord];
+			int32_t eg = values[ord];
+
+			switch (ord) {
+			case ORD_WPAWN:
+			case ORD_BPAWN:
+				mg += params->pawnSquares[own];
+				break;
+			case ORD_WKNIGHT:
+			case ORD_BKNIGHT:
+				mg += params->knightSquares[own];
+				break;
+			case ORD_WQUEEN:
+			case ORD_BQUEEN:
+				mg += params->queenSquares[own];
+				break;
+			case ORD_WKING:
+			case ORD_BKING:
+				eg += params->kingSquares[i];
+				break;
+			}
+
+			params->psqMg[ord][sq] = PIECE_SIGNS[ord] * mg;
+			params->psqEg[ord][sq] = PIECE_SIGNS[ord] * eg;
+		}
+	}
+}
+
+int32_t* evalparams_find(EvalParams* params, const char* name, int32_t* count) {
+	for (int32_t i = 0; i < FIELD_COUNT; i++) {
+		if (strcmp(FIELDS[i].name, name) == 0) {
+			*count = FIELDS[i].count;
+			return (int32_t*) ((char*) params + FIELDS[i].offset);
+		}
+	}
+	return NULL;
+}
+
+// Reads the next whitespace-delimited token, skipping comments from # to the end
+// of the line. Returns false at the end of the file or if the token is too long.
+static bool readToken(FILE* fp, char* token, size_t size) {
+	int c = fgetc(fp);
+	while (c != EOF && (isspace(c) || c == '#')) {
+		if (c == '#') {
+			while (c != EOF && c != '\n') {
+				c = fgetc(fp);
+			}
+		} else {
+			c = fgetc(fp);
+		}
+	}
+
+	size_t length = 0;
+	while (c != EOF && !isspace(c)) {
+		if (length + 1 >= size) {
+			return false;
+		}
+		token[length++] = (char) c;
+		c = fgetc(fp);
+	}
+
+	token[length] = '\0';
+	return length > 0;
+}
+
+static bool readValue(FILE* fp, int32_t* value) {
+	char token[EVAL_PARAMS_MAX_NAME];
+	if (!readToken(fp, token, sizeof(token))) {
+		return false;
+	}
+
+	char* end;
+	errno = 0;
+	const long parsed = strtol(token, &end, 10);
+	if (errno != 0 || *end != '\0' || parsed < INT32_MIN || parsed > INT32_MAX) {
+		return false;
+	}
+
+	*value = (int32_t) parsed;
+	return true;
+}
+
+bool evalparams_load(const char* fileName) {
+	FILE* fp = fopen(fileName, "r");
+	if (!fp) {
+		fprintf(stderr, "Unable to read evaluation parameters from [%s].\n", fileName);
+		return false;
+	}
+
+	EvalParams* params = allocParams();
+	evalparams_setDefaults(params);
+
+	char name[EVAL_PARAMS_MAX_NAME];
+	bool ok = true;
+	while (ok && readToken(fp, name, sizeof(name))) {
+		int32_t count;
+		int32_t* values = evalparams_find(params, name, &count);
+		if (values == NULL) {
+			fprintf(stderr, "Unknown evaluation parameter [%s] in [%s].\n", name, fileName);
+			ok = false;
+			break;
+		}
+
+		for (int32_t i = 0; i < count; i++) {
+			if (!readValue(fp, &values[i])) {
+				fprintf(stderr, "Expected %i values for [%s] in [%s].\n", count, name, fileName);
+				ok = false;
+				break;
+			}
+		}
+	}
+
+	fclose(fp);
+
+	if (!ok) {
+		free(params);
+		return false;
+	}
+
+	evalparams_update(params);
+	activate(params);
+	return true;
+}
+
+bool evalparams_save(const char* fileName, const EvalParams* params) {
+	FILE* out = fileName == NULL ? stdout : fopen(fileName, "w");
+	if (!out) {
+		perror("Unable to open evaluation parameter file");
+		return false;
+	}
+
+	fprintf(out, "# Tulip evaluation parameters. Tables are from white's point of view,\n");
+	fprintf(out, "# one rank per line from a1-h1 up to a8-h8.\n");
+
+	for (int32_t i = 0; i < FIELD_COUNT; i++) {
+		const int32_t* values = (const int32_t*) ((const char*) params + FIELDS[i].offset);
+		if (FIELDS[i].count == 1) {
+			fprintf(out, "%s %i\n", FIELDS[i].name, values[0]);
+			continue;
+		}
+
+		fprintf(out, "\n%s\n", FIELDS[i].name);
+		for (int32_t rank = 0; rank < 8; rank++) {
+			for (int32_t file = 0; file < 8; file++) {
+				fprintf(out, "%5i", values[rank * 8 + file]);
+			}
+			fprintf(out, "\n");
+		}
+	}
+
+	const bool ok = !ferror(out);
+	if (out == stdout) {
+		return fflush(out) == 0 && ok;
+	}
+	return fclose(out) == 0 && ok;
+}
@@ -0,0 +1,107 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef EVALPARAMS_H
+#define EVALPARAMS_H
+
+#include <stdbool.h>
+#include <inttypes.h>
+
+#include "piece.h"
+
+#define EVAL_PARAMS_ALIGNMENT 64
+#define EVAL_PARAMS_MAX_NAME 64
+
+// The evaluation weights in use. The compiled-in defaults are the constants of
+// evalconsts.h; a parameter file can replace any of them at runtime. Names in a
+// file are those of the constants, and tables take 64 values from a1 to h8.
+typedef struct {
+	// Scalar weights, first so the ones evaluate() reads share a cache line.
+	int32_t pawn;
+	int32_t knight;
+	int32_t bishop;
+	int32_t rook;
+	int32_t queen;
+	int32_t minorMobility;
+	int32_t rqShareRank;
+	int32_t kingExposure;
+	int32_t kingEndgameDistance;
+	int32_t kingEndgameRectangle;
+	int32_t doubledPawn;
+	int32_t pawnChain;
+	int32_t passedPawn;
+	int32_t isolatedPawnMg;
+	int32_t isolatedPawnEg;
+	int32_t backwardPawnMg;
+	int32_t backwardPawnEg;
+	int32_t candidatePasserMg;
+	int32_t candidatePasserEg;
+	int32_t bishopPairMg;
+	int32_t bishopPairEg;
+	int32_t kbnkCorner;
+	int32_t kpkUnstoppable;
+	int32_t kpkPawnAdvance;
+
+	// White-relative piece value plus square score by ordinal and board square,
+	// negated for black pieces. Built from the tables below by evalparams_update().
+	int32_t psqMg[ORD_MAX + 1][144];
+	int32_t psqEg[ORD_MAX + 1][144];
+
+	// Square tables from white's point of view, indexed from a1 to h8. Black's pawn,
+	// knight and queen tables are vertical mirrors; both kings share one table.
+	int32_t pawnSquares[64];
+	int32_t knightSquares[64];
+	int32_t queenSquares[64];
+	int32_t kingSquares[64];
+} EvalParams;
+
+// The active parameters. Never NULL once evalparams_init() has run.
+extern const EvalParams* EVAL_PARAMS;
+
+// The white-relative middlegame and endgame value of a piece standing on a square.
+#define PSQ_MG(ordinal, sq) (EVAL_PARAMS->psqMg[(ordinal)][(sq)])
+#define PSQ_EG(ordinal, sq) (EVAL_PARAMS->psqEg[(ordinal)][(sq)])
+
+// Activates the compiled-in defaults. Must run before anything is evaluated.
+void evalparams_init(void);
+
+// Fills in the compiled-in defaults.
+void evalparams_setDefaults(EvalParams* params);
+
+// Rebuilds the combined piece-square tables after the weights change.
+void evalparams_update(EvalParams* params);
+
+// Finds a weight by name, setting count to the number of values it holds.
+// Returns NULL if there's no such weight.
+int32_t* evalparams_find(EvalParams* params, const char* name, int32_t* count);
+
+// Reads a parameter file over the compiled-in defaults and makes it the active
+// set. Weights the file doesn't list keep their defaults. Returns false, leaving
+// the active set alone, if the file can't be read or has an unknown name or a
+// malformed value. Nothing may be evaluating while the set is replaced.
+bool evalparams_load(const char* fileName);
+
+// Writes the parameters in the format evalparams_load() reads; to stdout if
+// fileName is NULL.
+bool evalparams_save(const char* fileName, const EvalParams* params);
+
+#endif
@@ -33,6 +33,9 @@
 #include "board.h"
 #include "piece.h"
 #include "hash.h"
+#include "eval.h"
+#include "material.h"
+#include "draw.h"
 #include "gamestate.h"
 #include "statedata.h"
 #include "piece.h"
@@ -221,6 +224,48 @@ parse_board_err:
     return result;
 }
 
+void completePosition(GameState* state, int32_t toMove, int32_t castleFlags, int32_t epFile, int32_t fiftyMove) {
+    // Do additional validation on castle flags.
+    // Some FEN producers send castle flags that don't match positions.
+    if (state->current->whiteKingSquare != SQ_E1) {
+        castleFlags &= ~(CASTLE_WK | CASTLE_WQ);
+    }
+
+    if (state->current->blackKingSquare != SQ_E8) {
+        castleFlags &= ~(CASTLE_BK | CASTLE_BQ);
+    }
+
+    if (state->board[SQ_H1] != &WROOK) {
+        castleFlags &= ~CASTLE_WK;
+    }
+
+    if (state->board[SQ_A1] != &WROOK) {
+        castleFlags &= ~CASTLE_WQ;
+    }
+
+    if (state->board[SQ_H8] != &BROOK) {
+        castleFlags &= ~CASTLE_BK;
+    }
+
+    if (state->board[SQ_A8] != &BROOK) {
+        castleFlags &= ~CASTLE_BQ;
+    }
+
+    state->current->castleFlags = castleFlags;
+    state->current->toMove = toMove;
+    state->current->epFile = epFile;
+    state->current->fiftyMoveCount = fiftyMove;
+
+    reinitBitboards(state);
+    state->current->hash = computeHash(state);
+    state->current->pawnHash = computePawnHash(state);
+    computeStaticScores(state, &state->current->mgScore, &state->current->egScore);
+    state->current->materialKey = computeMaterialKey(state);
+
+    draw_clearPositions(state);
+    draw_pushPosition(state);
+}
+
 bool parseFenWithPrint(GameState* state, char* fenStr, bool printErrors) {
     bool result = true;
     char** tokenBuffer;
@@ -272,41 +317,7 @@ bool parseFenWithPrint(GameState* state, char* fenStr, bool printErrors) {
         goto clean_tokens;
     }
 
-    // Do additional validation on castle flags.
-    // Some FEN producers send castle flags that don't match positions.
-    if (state->current->whiteKingSquare != SQ_E1) {
-        castleFlags &= ~(CASTLE_WK | CASTLE_WQ);
-    }
-
-    if (state->current->blackKingSquare != SQ_E8) {
-        castleFlags &= ~(CASTLE_BK | CASTLE_BQ);
-    }
-
-    if (state->board[SQ_H1] != &WROOK) {
-        castleFlags &= ~CASTLE_WK;
-    }
-
-    if (state->board[SQ_A1] != &WROOK) {
-        castleFlags &= ~CASTLE_WQ;
-    }
-
-    if (state->board[SQ_H8] != &BROOK) {
-        castleFlags &= ~CASTLE_BK;
-    }
-
-    if (state->board[SQ_A8] != &BROOK) {
-        castleFlags &= ~CASTLE_BQ;
-    }
-
-    state->current->castleFlags = castleFlags;
-    state->current->toMove = toMove;
-    state->current->epFile = epFile;
-    state->current->fiftyMoveCount = fiftyMove;
-
-    hash_clearZTable(&state->zTable);
-
-    reinitBitboards(state);
-    state->current->hash = computeHash(state);
+    completePosition(state, toMove, castleFlags, epFile, fiftyMove);
 
 clean_tokens:
     freeTokenBuffer(tokenBuffer, _FEN_MAX_TOKENS);
@@ -32,6 +32,11 @@ bool parseFen(GameState* state, char* fenStr);
 // As parseFen, with optional suppressing of errors to stdout/err.
 bool parseFenWithPrint(GameState* state, char* fenStr, bool printErrors);
 
+// Finishes setting up a state whose board, piece counts and king squares are in place:
+// drops castle flags that don't match the board, and computes the bitboards, hashes
+// and scores. Shared by the FEN parser and other position formats.
+void completePosition(GameState* state, int32_t toMove, int32_t castleFlags, int32_t epFile, int32_t fiftyMove);
+
 // Prints a FEN to the given buffer, not exceeding the given length.
 // Returns the number of printed characters.
 // Output will be null-terminated.
@@ -0,0 +1,435 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#define _POSIX_C_SOURCE 200112L // For mmap() and friends with -std=c99
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "tulip.h"
+#include "gamefile.h"
+#include "attack.h"
+#include "fen.h"
+#include "makemove.h"
+#include "move.h"
+#include "movegen.h"
+#include "notation.h"
+#include "pgn.h"
+#include "util.h"
+
+#define PGN_LINE_LENGTH 80
+
+static const char* INITIAL_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+// Fills keys with the packed values of the legal moves, in order, and moves with the
+// moves themselves. Returns the number of legal moves.
+static int32_t orderedLegalMoves(GameState* state, Move* moves, uint16_t* keys) {
+	MoveBuffer pseudoMoves;
+	int32_t count = 0;
+
+	createMoveBuffer(&pseudoMoves);
+	generatePseudoMoves(state, &pseudoMoves);
+
+	for (int32_t i = 0; i < pseudoMoves.length; i++) {
+		Move* m = &pseudoMoves.moves[i];
+		makeMove(state, m);
+		const bool legal = isLegalPosition(state);
+		unmakeMove(state, m);
+
+		if (!legal) {
+			continue;
+		}
+
+		// Insertion sort; there are only a few dozen moves.
+		const uint16_t key = packMove(m);
+		int32_t j = count++;
+		while (j > 0 && keys[j - 1] > key) {
+			keys[j] = keys[j - 1];
+			moves[j] = moves[j - 1];
+			j--;
+		}
+
+		keys[j] = key;
+		moves[j] = *m;
+	}
+
+	destroyMoveBuffer(&pseudoMoves);
+	return count;
+}
+
+int32_t gamefile_encodeMove(GameState* state, Move* move) {
+	Move moves[MOVE_BUFFER_LENGTH];
+	uint16_t keys[MOVE_BUFFER_LENGTH];
+	const int32_t count = orderedLegalMoves(state, moves, keys);
+	const uint16_t key = packMove(move);
+
+	for (int32_t i = 0; i < count; i++) {
+		if (keys[i] == key) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+bool gamefile_open(const char* fileName, GameFile* file) {
+	const int fd = open(fileName, O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size < GAMEFILE_HEADER_SIZE) {
+		close(fd);
+		return false;
+	}
+
+	const size_t size = (size_t) st.st_size;
+	void* mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (mapping == MAP_FAILED) {
+		return false;
+	}
+
+	if (memcmp(mapping, GAMEFILE_MAGIC, GAMEFILE_HEADER_SIZE) != 0) {
+		munmap(mapping, size);
+		return false;
+	}
+
+	posix_madvise(mapping, size, POSIX_MADV_SEQUENTIAL);
+	file->mapping = mapping;
+	file->data = (const uint8_t*) mapping;
+	file->length = size;
+	file->pos = GAMEFILE_HEADER_SIZE;
+	return true;
+}
+
+void gamefile_close(GameFile* file) {
+	if (file->mapping != NULL) {
+		munmap(file->mapping, file->length);
+		file->mapping = NULL;
+		file->data = NULL;
+	}
+}
+
+bool gamefile_nextGame(GameFile* file, BinaryGame* game) {
+	const uint8_t* p = file->data + file->pos;
+	size_t remaining = file->length - file->pos;
+	if (remaining < 4) {
+		if (remaining > 0) {
+			fprintf(stderr, "Game file is truncated.\n");
+		}
+		return false;
+	}
+
+	game->result = p[0];
+	const uint8_t flags = p[1];
+	game->plies = readLE16(p + 2);
+	game->next = 0;
+	game->fen[0] = '\0';
+	size_t used = 4;
+
+	if (flags & GAMEFILE_FLAG_FEN) {
+		const size_t fenLength = remaining > used ? p[used] : GAMEFILE_FEN_SIZE;
+		if (fenLength >= GAMEFILE_FEN_SIZE || remaining < used + 1 + fenLength) {
+			fprintf(stderr, "Game file is truncated or corrupt.\n");
+			return false;
+		}
+
+		memcpy(game->fen, p + used + 1, fenLength);
+		game->fen[fenLength] = '\0';
+		used += 1 + fenLength;
+	}
+
+	if (game->plies > GAMEFILE_MAX_PLIES) {
+		fprintf(stderr, "Game file is corrupt.\n");
+		return false;
+	}
+
+	if (remaining < used + (size_t) game->plies) {
+		fprintf(stderr, "Game file is truncated.\n");
+		return false;
+	}
+
+	game->moves = p + used;
+	file->pos += used + (size_t) game->plies;
+	return true;
+}
+
+bool gamefile_startPosition(BinaryGame* game, GameState* state) {
+	char fen[GAMEFILE_FEN_SIZE];
+	snprintf(fen, sizeof(fen), "%s", game->fen[0] != '\0' ? game->fen : INITIAL_FEN);
+	return parseFenWithPrint(state, fen, false);
+}
+
+bool gamefile_nextMove(BinaryGame* game, GameState* state, Move* move) {
+	if (game->next >= game->plies) {
+		return false;
+	}
+
+	Move moves[MOVE_BUFFER_LENGTH];
+	uint16_t keys[MOVE_BUFFER_LENGTH];
+	const int32_t count = orderedLegalMoves(state, moves, keys);
+	const int32_t index = game->moves[game->next];
+	if (index >= count) {
+		return false;
+	}
+
+	game->next++;
+	*move = moves[index];
+	return true;
+}
+
+bool gamefile_writeHeader(FILE* fp) {
+	return fwrite(GAMEFILE_MAGIC, 1, GAMEFILE_HEADER_SIZE, fp) == GAMEFILE_HEADER_SIZE;
+}
+
+bool gamefile_writeGame(FILE* fp, int32_t result, const char* fen, const uint8_t* moves, int32_t plies) {
+	const size_t fenLength = strlen(fen);
+	uint8_t header[4];
+	header[0] = (uint8_t) result;
+	header[1] = (uint8_t) (fenLength > 0 ? GAMEFILE_FLAG_FEN : 0);
+	writeLE16(header + 2, (uint16_t) plies);
+
+	bool ok = fwrite(header, 1, sizeof(header), fp) == sizeof(header);
+	if (fenLength > 0) {
+		const uint8_t length = (uint8_t) fenLength;
+		ok = ok && fwrite(&length, 1, 1, fp) == 1 && fwrite(fen, 1, fenLength, fp) == fenLength;
+	}
+
+	return ok && fwrite(moves, 1, (size_t) plies, fp) == (size_t) plies;
+}
+
+int32_t gamefile_parseResult(const char* result) {
+	if (strcmp(result, "1-0") == 0) {
+		return GAMEFILE_RESULT_WHITE_WINS;
+	} else if (strcmp(result, "0-1") == 0) {
+		return GAMEFILE_RESULT_BLACK_WINS;
+	} else if (strcmp(result, "1/2-1/2") == 0) {
+		return GAMEFILE_RESULT_DRAW;
+	}
+
+	return GAMEFILE_RESULT_UNKNOWN;
+}
+
+const char* gamefile_resultString(int32_t result) {
+	switch (result) {
+	case GAMEFILE_RESULT_WHITE_WINS: return "1-0";
+	case GAMEFILE_RESULT_BLACK_WINS: return "0-1";
+	case GAMEFILE_RESULT_DRAW: return "1/2-1/2";
+	default: return "*";
+	}
+}
+
+// Encodes the moves of one PGN game. Returns the number of plies, or -1 if a move or
+// the FEN couldn't be read.
+static int32_t encodeGame(GameState* state, PgnGame* game, uint8_t* moves) {
+	char fen[PGN_FEN_SIZE];
+	char token[32];
+	Move move;
+
+	snprintf(fen, sizeof(fen), "%s", game->fen[0] != '\0' ? game->fen : INITIAL_FEN);
+	if (strlen(game->fen) >= GAMEFILE_FEN_SIZE || !parseFenWithPrint(state, fen, false)) {
+		return -1;
+	}
+
+	const char* cursor = game->moveText;
+	int32_t plies = 0;
+	while (pgn_nextMove(&cursor, game->moveTextEnd, token, sizeof(token))) {
+		if (plies == GAMEFILE_MAX_PLIES || !notation_matchMove(token, state, &move)) {
+			return -1;
+		}
+
+		moves[plies++] = (uint8_t) gamefile_encodeMove(state, &move);
+		makeMove(state, &move);
+	}
+
+	return plies;
+}
+
+bool gamefile_fromPgn(const char* pgnFile, const char* gameFile, GameFileStats* stats) {
+	PgnFile pgn;
+	if (!pgn_mapFile(pgnFile, &pgn)) {
+		perror("Unable to open PGN file");
+		return false;
+	}
+
+	FILE* fp = fopen(gameFile, "wb");
+	if (!fp) {
+		perror("Unable to open game file for writing");
+		pgn_unmapFile(&pgn);
+		return false;
+	}
+
+	const int64_t start = getCurrentTimeMillis();
+	memset(stats, 0, sizeof(GameFileStats));
+
+	GameState state;
+	PgnReader reader;
+	PgnGame game;
+	uint8_t moves[GAMEFILE_MAX_PLIES];
+	initializeGamestate(&state);
+	pgn_initReader(&reader, pgn.data, pgn.length);
+
+	bool ok = gamefile_writeHeader(fp);
+	while (ok && pgn_nextGame(&reader, &game)) {
+		const int32_t plies = encodeGame(&state, &game, moves);
+		if (plies < 0) {
+			stats->errors++;
+			continue;
+		}
+
+		ok = gamefile_writeGame(fp, gamefile_parseResult(game.result), game.fen, moves, plies);
+		stats->games++;
+		stats->plies += plies;
+	}
+
+	stats->bytes = ftell(fp);
+	ok = fclose(fp) == 0 && ok;
+	if (!ok) {
+		fprintf(stderr, "Error writing game file [%s]\n", gameFile);
+	}
+
+	destroyGamestate(&state);
+	pgn_unmapFile(&pgn);
+	stats->elapsedMillis = getCurrentTimeMillis() - start;
+	return ok;
+}
+
+// The full move number of a FEN, which the GameState doesn't keep.
+static int32_t startingMoveNumber(const char* fen) {
+	const char* lastField = strrchr(fen, ' ');
+	const int32_t moveNumber = lastField != NULL ? atoi(lastField + 1) : 1;
+	return MAX(moveNumber, 1);
+}
+
+// Writes a game's moves as PGN move text, wrapping lines.
+static bool writeMoveText(FILE* fp, GameState* state, BinaryGame* game) {
+	char san[16];
+	char word[32];
+	int32_t column = 0;
+	Move move;
+
+	int32_t moveNumber = startingMoveNumber(game->fen);
+	bool first = true;
+	while (gamefile_nextMove(game, state, &move)) {
+		const bool white = state->current->toMove == COLOR_WHITE;
+		if (white && !first) {
+			moveNumber++;
+		}
+		notation_printShortAlg(&move, state, san);
+
+		int32_t length;
+		if (white) {
+			length = snprintf(word, sizeof(word), "%i. %s", moveNumber, san);
+		} else if (first) {
+			length = snprintf(word, sizeof(word), "%i... %s", moveNumber, san);
+		} else {
+			length = snprintf(word, sizeof(word), "%s", san);
+		}
+
+		if (column > 0 && column + 1 + length > PGN_LINE_LENGTH) {
+			fputc('\n', fp);
+			column = 0;
+		} else if (column > 0) {
+			fputc(' ', fp);
+			column++;
+		}
+
+		fputs(word, fp);
+		column += length;
+		first = false;
+		makeMove(state, &move);
+	}
+
+	const char* result = gamefile_resultString(game->result);
+	if (column > 0 && column + 1 + (int32_t) strlen(result) > PGN_LINE_LENGTH) {
+		fputc('\n', fp);
+	} else if (column > 0) {
+		fputc(' ', fp);
+	}
+
+	fprintf(fp, "%s\n\n", result);
+
+	// A bad move index means the file is corrupt; the game is cut short there.
+	return game->next == game->plies;
+}
+
+bool gamefile_toPgn(const char* gameFile, const char* pgnFile, GameFileStats* stats) {
+	GameFile file;
+	if (!gamefile_open(gameFile, &file)) {
+		fprintf(stderr, "Unable to open game file [%s]\n", gameFile);
+		return false;
+	}
+
+	FILE* fp = fopen(pgnFile, "w");
+	if (!fp) {
+		perror("Unable to open PGN file for writing");
+		gamefile_close(&file);
+		return false;
+	}
+
+	const int64_t start = getCurrentTimeMillis();
+	memset(stats, 0, sizeof(GameFileStats));
+
+	GameState state;
+	BinaryGame game;
+	initializeGamestate(&state);
+
+	while (gamefile_nextGame(&file, &game)) {
+		if (!gamefile_startPosition(&game, &state)) {
+			stats->errors++;
+			continue;
+		}
+
+		const char* result = gamefile_resultString(game.result);
+		fprintf(fp, "[Event \"?\"]\n[Site \"?\"]\n[Date \"????.??.??\"]\n[Round \"?\"]\n");
+		fprintf(fp, "[White \"?\"]\n[Black \"?\"]\n[Result \"%s\"]\n", result);
+		if (game.fen[0] != '\0') {
+			fprintf(fp, "[FEN \"%s\"]\n[SetUp \"1\"]\n", game.fen);
+		}
+		fputc('\n', fp);
+
+		if (!writeMoveText(fp, &state, &game)) {
+			stats->errors++;
+		}
+
+		stats->games++;
+		stats->plies += game.next;
+	}
+
+	stats->bytes = ftell(fp);
+	bool ok = fclose(fp) == 0;
+	if (!ok) {
+		fprintf(stderr, "Error writing PGN file [%s]\n", pgnFile);
+	}
+
+	destroyGamestate(&state);
+	gamefile_close(&file);
+	stats->elapsedMillis = getCurrentTimeMillis() - start;
+	return ok;
+}
@@ -0,0 +1,116 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef GAMEFILE_H
+#define GAMEFILE_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <inttypes.h>
+
+#include "gamestate.h"
+#include "move.h"
+
+// A game file is the 8 byte magic "TULPGAME" followed by game records:
+//   a result byte (GAMEFILE_RESULT_*), a flags byte, a little-endian 16-bit ply count,
+//   then, with GAMEFILE_FLAG_FEN, a length byte and the starting FEN,
+//   then one byte per ply: the index of the move played among the legal moves of the
+//   position, ordered by their packed values (see packMove()).
+// The ordering depends only on the position, not on how the move generator happens to
+// order moves, so files stay readable as the generator changes. No tags other than the
+// result and starting position are kept.
+#define GAMEFILE_MAGIC "TULPGAME"
+#define GAMEFILE_HEADER_SIZE 8
+#define GAMEFILE_FLAG_FEN 1
+#define GAMEFILE_MAX_PLIES 500     // A GameState can only replay so many moves.
+
+#define GAMEFILE_RESULT_UNKNOWN 0
+#define GAMEFILE_RESULT_WHITE_WINS 1
+#define GAMEFILE_RESULT_BLACK_WINS 2
+#define GAMEFILE_RESULT_DRAW 3
+
+#define GAMEFILE_FEN_SIZE 128
+
+// A mapped game file being read front to back.
+typedef struct {
+	const uint8_t* data;
+	size_t length;
+	size_t pos;
+	void* mapping;
+} GameFile;
+
+// One game read from a game file. Its moves are decoded one at a time with
+// gamefile_nextMove(), playing each on a GameState set up by gamefile_startPosition().
+typedef struct {
+	int32_t result;                 // One of the GAMEFILE_RESULT_* constants.
+	char fen[GAMEFILE_FEN_SIZE];    // The starting position, or an empty string for the standard one.
+	int32_t plies;
+	const uint8_t* moves;
+	int32_t next;                   // The ply of the next move to decode.
+} BinaryGame;
+
+// Totals for a conversion between PGN and a game file.
+typedef struct {
+	int64_t games;              // Games written.
+	int64_t errors;             // Games skipped for an illegal or unreadable move or FEN.
+	int64_t plies;              // Moves written.
+	int64_t bytes;              // Size of the output file.
+	int64_t elapsedMillis;
+} GameFileStats;
+
+// Maps a game file. Returns false if it can't be read or isn't a game file.
+bool gamefile_open(const char* fileName, GameFile* file);
+
+// Unmaps a game file.
+void gamefile_close(GameFile* file);
+
+// Reads the next game record. Returns false at the end of the file, or at a truncated record.
+bool gamefile_nextGame(GameFile* file, BinaryGame* game);
+
+// Sets up the starting position of a game. Returns false if its FEN is invalid.
+bool gamefile_startPosition(BinaryGame* game, GameState* state);
+
+// Decodes the next move of a game, which must be played from the given state.
+// Returns false at the end of the game, or if the move isn't legal in the state.
+bool gamefile_nextMove(BinaryGame* game, GameState* state, Move* move);
+
+// Returns a move's index among the ordered legal moves of a position, or -1 if it isn't legal.
+int32_t gamefile_encodeMove(GameState* state, Move* move);
+
+// Writes the file magic. Every game file starts with it.
+bool gamefile_writeHeader(FILE* fp);
+
+// Writes a game record. The fen is empty for the standard starting position.
+bool gamefile_writeGame(FILE* fp, int32_t result, const char* fen, const uint8_t* moves, int32_t plies);
+
+// Maps a PGN result string ("1-0" and so on) to a GAMEFILE_RESULT_* constant, and back.
+int32_t gamefile_parseResult(const char* result);
+const char* gamefile_resultString(int32_t result);
+
+// Converts every game of a PGN file to a game file.
+bool gamefile_fromPgn(const char* pgnFile, const char* gameFile, GameFileStats* stats);
+
+// Converts every game of a game file to PGN, with SAN moves.
+bool gamefile_toPgn(const char* gameFile, const char* pgnFile, GameFileStats* stats);
+
+#endif
@@ -33,6 +33,9 @@
 #include "move.h"
 #include "bitboard.h"
 #include "hash.h"
+#include "pawns.h"
+#include "material.h"
+#include "draw.h"
 
 void initializeGamestate(GameState* gs) {
     // Allocate memory space for arrays.
@@ -60,12 +63,27 @@ void initializeGamestate(GameState* gs) {
         }
     }
 
-    gs->moveBuffers = ALLOC(MAX_MOVE_BUFFER, MoveBuffer, gs->moveBuffers, "Unable to allocate move buffers.");
-    for (int32_t i = 0; i < MAX_MOVE_BUFFER; i++) {
-        createMoveBuffer(&gs->moveBuffers[i]);
+    // Search-only storage is allocated on demand; see prepareForSearch.
+    gs->moveBuffers = NULL;
+    gs->zTable = NULL;
+
+    pawns_createTable(&gs->pawnTable);
+    material_createTable(&gs->materialTable);
+    draw_createRepetitionTable(&gs->repetitions);
+    draw_clearSearchRoot(gs);
+}
+
+void prepareForSearch(GameState* gs) {
+    if (!gs->moveBuffers) {
+        gs->moveBuffers = ALLOC(MAX_MOVE_BUFFER, MoveBuffer, gs->moveBuffers, "Unable to allocate move buffers.");
+        for (int32_t i = 0; i < MAX_MOVE_BUFFER; i++) {
+            createMoveBuffer(&gs->moveBuffers[i]);
+        }
     }
 
-    hash_createZTable(&gs->zTable);
+    if (!gs->zTable) {
+        gs->zTable = hash_sharedZTable();
+    }
 }
 
 void reinitBitboards(GameState* gs) {
@@ -93,12 +111,20 @@ void destroyGamestate(GameState* gs) {
     free(gs->board);
     free(gs->pieceCounts);
 
-    for (int32_t i = 0; i < MAX_MOVE_BUFFER; i++) {
-        destroyMoveBuffer(&gs->moveBuffers[i]);
+    if (gs->moveBuffers) {
+        for (int32_t i = 0; i < MAX_MOVE_BUFFER; i++) {
+            destroyMoveBuffer(&gs->moveBuffers[i]);
+        }
+
+        free(gs->moveBuffers);
+        gs->moveBuffers = NULL;
     }
 
-    free(gs->moveBuffers);
-    hash_destroyZTable(&gs->zTable);
+    // The transposition table is borrowed, not owned; just detach it.
+    gs->zTable = NULL;
+    pawns_destroyTable(&gs->pawnTable);
+    material_destroyTable(&gs->materialTable);
+    draw_destroyRepetitionTable(&gs->repetitions);
 
     gs->created = false;
 }
@@ -32,6 +32,9 @@
 #include "move.h"
 #include "statedata.h"
 #include "ztable.h"
+#include "pawntable.h"
+#include "materialtable.h"
+#include "repetition.h"
 
 // This is the maximum number of half-moves supportable in a game.
 #define _GS_STACK_SIZE  512
@@ -51,8 +54,11 @@ typedef struct {
     StateData* current;     // The current state data object.
     bool created;           // Indicates that this structure has been initialized.
     uint64_t* bitboards;    // An array of bitboards, indexable by piece ordinal.
-    MoveBuffer* moveBuffers;     // A series of move buffers for efficient search storage
-    ZTable zTable;	// A Zobrist hash table for position hashing.
+    MoveBuffer* moveBuffers;     // Move buffers for search storage; NULL until the first search.
+    ZTable* zTable;         // Borrowed transposition table used by search; NULL until the first search.
+    PawnTable pawnTable;    // Cached pawn structure evaluations, keyed by pawn hash.
+    MaterialTable materialTable; // Cached material signature data, keyed by material key.
+    RepetitionTable repetitions; // Counts of the positions on the current line, for repetition draws.
 } GameState;
 
 // Allocate memory and otherwise initialize a GameState to a default state.
@@ -61,6 +67,10 @@ void initializeGamestate(GameState*);
 // Free memory and otherwise release resources of a GameState.
 void destroyGamestate(GameState*);
 
+// Allocate the search move buffers and attach the shared transposition table if no table
+// has been attached yet. Does nothing on subsequent calls.
+void prepareForSearch(GameState* gs);
+
 // Recalculate the bitboards array on the given state. Not performant.
 void reinitBitboards(GameState* gs);
 
@@ -0,0 +1,410 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "tulip.h"
+#include "gendata.h"
+#include "attack.h"
+#include "eval.h"
+#include "fen.h"
+#include "gamestate.h"
+#include "hash.h"
+#include "makemove.h"
+#include "movegen.h"
+#include "packedpos.h"
+#include "result.h"
+#include "search.h"
+#include "util.h"
+#include "ztable.h"
+
+// Scores at least this large decide the game: such positions aren't written, and a game
+// whose searches agree on it for GENDATA_DECIDED_PLIES plies in a row is adjudicated.
+#define GENDATA_DECIDED_SCORE 2000
+#define GENDATA_DECIDED_PLIES 4
+
+// Random openings that leave either side this far ahead are thrown away.
+#define GENDATA_MAX_OPENING_SCORE 300
+
+// The output is flushed, and progress reported, every time this many positions are written.
+#define GENDATA_FLUSH_POSITIONS 16384
+
+#define GENDATA_FILE_BUFFER (1024 * 1024)
+
+static const char* INITIAL_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+// A set of the hashes written so far; open addressing, with 0 marking an empty slot.
+typedef struct {
+	uint64_t* slots;
+	uint64_t mask;
+	uint64_t count;
+} HashSet;
+
+typedef struct {
+	GenDataArgs* args;
+	GenDataResult* result;
+	FILE* file;
+	HashSet written;
+	int64_t nextGame;       // Number of the next game to start; also guarded by lock.
+	int64_t lastFlush;      // Positions written at the last flush.
+	bool done;              // Set once enough positions are written, or on a write error.
+	bool failed;
+	int64_t start;
+	pthread_mutex_t lock;
+} GenDataQueue;
+
+typedef struct {
+	pthread_t thread;
+	GenDataQueue* queue;
+	GameState gameState;
+	ZTable zTable;
+	SearchResult searchResult;
+	uint64_t random;        // The xorshift state for the current game's opening.
+	uint8_t positions[GENDATA_MAX_PLIES][PACKED_POSITION_SIZE];
+	uint64_t hashes[GENDATA_MAX_PLIES];
+	int32_t positionCount;
+} GenDataWorker;
+
+// Game outcomes, from white's point of view.
+#define OUTCOME_WHITE_WINS   1
+#define OUTCOME_DRAW         0
+#define OUTCOME_BLACK_WINS  -1
+
+static void createHashSet(HashSet* set) {
+	set->mask = (1 << 16) - 1;
+	set->count = 0;
+	set->slots = ALLOC(set->mask + 1, uint64_t, set->slots, "Unable to allocate hash set.");
+	memset(set->slots, 0, (set->mask + 1) * sizeof(uint64_t));
+}
+
+static void destroyHashSet(HashSet* set) {
+	free(set->slots);
+}
+
+static bool insertSlot(uint64_t* slots, uint64_t mask, uint64_t hash) {
+	uint64_t i = hash & mask;
+	while (slots[i] != 0) {
+		if (slots[i] == hash) {
+			return false;
+		}
+		i = (i + 1) & mask;
+	}
+
+	slots[i] = hash;
+	return true;
+}
+
+// Adds a hash to the set. Returns false if it was already there.
+static bool addHash(HashSet* set, uint64_t hash) {
+	hash = hash != 0 ? hash : 1;
+
+	if (set->count * 2 >= set->mask) {
+		const uint64_t mask = set->mask * 2 + 1;
+		uint64_t* slots = ALLOC(mask + 1, uint64_t, slots, "Unable to grow hash set.");
+		memset(slots, 0, (mask + 1) * sizeof(uint64_t));
+		for (uint64_t i = 0; i <= set->mask; i++) {
+			if (set->slots[i] != 0) {
+				insertSlot(slots, mask, set->slots[i]);
+			}
+		}
+
+		free(set->slots);
+		set->slots = slots;
+		set->mask = mask;
+	}
+
+	const bool added = insertSlot(set->slots, set->mask, hash);
+	set->count += added ? 1 : 0;
+	return added;
+}
+
+// Plays random legal moves from the initial position. Returns false if the game ended on the way.
+static bool playRandomOpening(GenDataWorker* worker) {
+	GameState* state = &worker->gameState;
+	char fen[128];
+	MoveBuffer buffer;
+
+	strcpy(fen, INITIAL_FEN);
+	parseFen(state, fen);
+	createMoveBuffer(&buffer);
+
+	bool ok = true;
+	for (int32_t i = 0; ok && i < worker->queue->args->randomPlies; i++) {
+		const int32_t count = generateLegalMoves(state, &buffer);
+		ok = count > 0;
+		if (ok) {
+			Move m = buffer.moves[nextRandom(&worker->random) % (uint64_t) count];
+			makeMove(state, &m);
+		}
+	}
+
+	destroyMoveBuffer(&buffer);
+	return ok && getResult(state) == STATUS_NONE;
+}
+
+static void searchPosition(GenDataWorker* worker) {
+	GenDataArgs* args = worker->queue->args;
+	SearchArgs searchArgs;
+
+	initSearchArgs(&searchArgs);
+	searchArgs.depth = args->depth;
+	searchArgs.nodeLimit = args->nodes;
+	searchArgs.timeToThinkMillis = INT32_MAX;
+	search(&worker->gameState, &searchArgs, &worker->searchResult);
+}
+
+// Keeps the current position if it's quiet and undecided. The score is the search score,
+// from the perspective of the side to move.
+static bool recordPosition(GenDataWorker* worker, int32_t score) {
+	GameState* state = &worker->gameState;
+
+	if (score <= -GENDATA_DECIDED_SCORE || score >= GENDATA_DECIDED_SCORE || isCheck(state)) {
+		return false;
+	}
+
+	const int32_t noise = quiescenceScore(state, &worker->searchResult) - evaluate(state);
+	if (noise > worker->queue->args->maxNoise || noise < -worker->queue->args->maxNoise) {
+		return false;
+	}
+
+	uint8_t* packed = worker->positions[worker->positionCount];
+	if (!packPosition(state, packed)) {
+		return false;
+	}
+
+	const int32_t whiteScore = state->current->toMove == COLOR_WHITE ? score : -score;
+	packedpos_setLabels(packed, whiteScore, PACKED_RESULT_NONE);
+	worker->hashes[worker->positionCount++] = state->current->hash;
+	return true;
+}
+
+// Plays one game, collecting its positions. Returns the outcome from white's point of view,
+// or false in played if the opening was thrown away.
+static int32_t playGame(GenDataWorker* worker, int64_t* filtered, bool* played) {
+	GameState* state = &worker->gameState;
+	int32_t decidedPlies = 0;
+	int32_t decidedSign = 0;
+
+	worker->positionCount = 0;
+	*filtered = 0;
+	*played = false;
+
+	if (!playRandomOpening(worker)) {
+		return OUTCOME_DRAW;
+	}
+
+	hash_clearZTable(&worker->zTable);
+
+	for (int32_t ply = 0; ply < GENDATA_MAX_PLIES; ply++) {
+		switch (getResult(state)) {
+		case STATUS_WHITE_CHECKMATED:
+			return OUTCOME_BLACK_WINS;
+		case STATUS_BLACK_CHECKMATED:
+			return OUTCOME_WHITE_WINS;
+		case STATUS_NONE:
+			break;
+		default:
+			return OUTCOME_DRAW;
+		}
+
+		searchPosition(worker);
+		const int32_t score = worker->searchResult.score;
+		const int32_t whiteScore = state->current->toMove == COLOR_WHITE ? score : -score;
+		Move move = worker->searchResult.move;
+
+		if (ply == 0) {
+			if (whiteScore > GENDATA_MAX_OPENING_SCORE || whiteScore < -GENDATA_MAX_OPENING_SCORE) {
+				return OUTCOME_DRAW;
+			}
+			*played = true;
+		}
+
+		if (!recordPosition(worker, score)) {
+			(*filtered)++;
+		}
+
+		const int32_t sign = whiteScore >= GENDATA_DECIDED_SCORE ? 1 : (whiteScore <= -GENDATA_DECIDED_SCORE ? -1 : 0);
+		decidedPlies = sign != 0 && sign == decidedSign ? decidedPlies + 1 : (sign != 0 ? 1 : 0);
+		decidedSign = sign;
+		if (decidedPlies >= GENDATA_DECIDED_PLIES) {
+			return sign > 0 ? OUTCOME_WHITE_WINS : OUTCOME_BLACK_WINS;
+		}
+
+		makeMove(state, &move);
+	}
+
+	return OUTCOME_DRAW;
+}
+
+static void printProgress(GenDataQueue* queue) {
+	GenDataResult* result = queue->result;
+	const int64_t elapsed = getCurrentTimeMillis() - queue->start;
+	fprintf(stderr, "%"PRId64" positions from %"PRId64" games (%"PRId64" duplicates, %"PRId64" filtered), %.0f positions/s\n",
+	        result->positions, result->games, result->duplicates, result->filtered,
+	        elapsed > 0 ? (double) result->positions / (double) elapsed * 1000.0 : 0.0);
+}
+
+// Labels the game's positions with its outcome and writes the new ones. Called under the lock.
+static void writeGame(GenDataWorker* worker, int32_t outcome) {
+	GenDataQueue* queue = worker->queue;
+	GenDataResult* result = queue->result;
+	const int32_t label = outcome == OUTCOME_WHITE_WINS ? PACKED_RESULT_WHITE_WINS
+	                      : (outcome == OUTCOME_BLACK_WINS ? PACKED_RESULT_BLACK_WINS : PACKED_RESULT_DRAW);
+
+	for (int32_t i = 0; i < worker->positionCount && !queue->done; i++) {
+		if (!addHash(&queue->written, worker->hashes[i])) {
+			result->duplicates++;
+			continue;
+		}
+
+		uint8_t* packed = worker->positions[i];
+		packedpos_setLabels(packed, packedpos_score(packed), label);
+		if (fwrite(packed, 1, PACKED_POSITION_SIZE, queue->file) != PACKED_POSITION_SIZE) {
+			queue->failed = true;
+			queue->done = true;
+			return;
+		}
+
+		result->positions++;
+		queue->done = result->positions >= queue->args->positions;
+	}
+
+	if (result->positions - queue->lastFlush >= GENDATA_FLUSH_POSITIONS) {
+		queue->lastFlush = result->positions;
+		if (fflush(queue->file) != 0) {
+			queue->failed = true;
+			queue->done = true;
+		}
+		printProgress(queue);
+	}
+}
+
+static void* runWorker(void* arg) {
+	GenDataWorker* worker = (GenDataWorker*) arg;
+	GenDataQueue* queue = worker->queue;
+
+	while (true) {
+		pthread_mutex_lock(&queue->lock);
+		const int64_t game = queue->done ? -1 : queue->nextGame++;
+		pthread_mutex_unlock(&queue->lock);
+
+		if (game < 0) {
+			break;
+		}
+
+		worker->random = seedRandom(queue->args->seed, game);
+
+		int64_t filtered;
+		bool played;
+		const int32_t outcome = playGame(worker, &filtered, &played);
+		if (!played) {
+			continue;
+		}
+
+		pthread_mutex_lock(&queue->lock);
+		if (!queue->done) {
+			queue->result->games++;
+			queue->result->filtered += filtered;
+			writeGame(worker, outcome);
+		}
+		pthread_mutex_unlock(&queue->lock);
+	}
+
+	return NULL;
+}
+
+bool gendata_run(const char* fileName, GenDataArgs* args, GenDataResult* result) {
+	memset(result, 0, sizeof(GenDataResult));
+
+	FILE* file = fopen(fileName, "wb");
+	if (!file) {
+		perror("Unable to open output file");
+		return false;
+	}
+
+	setvbuf(file, NULL, _IOFBF, GENDATA_FILE_BUFFER);
+
+	GenDataQueue queue;
+	queue.args = args;
+	queue.result = result;
+	queue.file = file;
+	queue.nextGame = 0;
+	queue.lastFlush = 0;
+	queue.done = false;
+	queue.failed = fwrite(PACKED_FILE_MAGIC, 1, PACKED_FILE_HEADER_SIZE, file) != PACKED_FILE_HEADER_SIZE;
+	queue.start = getCurrentTimeMillis();
+	createHashSet(&queue.written);
+	pthread_mutex_init(&queue.lock, NULL);
+
+	const int32_t threads = args->threads;
+	GenDataWorker* workers = ALLOC((size_t) threads, GenDataWorker, workers, "Unable to allocate generation workers.");
+
+	for (int32_t i = 0; i < threads; i++) {
+		GenDataWorker* worker = &workers[i];
+		worker->queue = &queue;
+		initializeGamestate(&worker->gameState);
+		hash_createZTable(&worker->zTable);
+		worker->gameState.zTable = &worker->zTable;
+		createSearchResult(&worker->searchResult);
+	}
+
+	if (!queue.failed) {
+		if (threads == 1) {
+			runWorker(&workers[0]);
+		} else {
+			for (int32_t i = 0; i < threads; i++) {
+				if (pthread_create(&workers[i].thread, NULL, runWorker, &workers[i]) != 0) {
+					perror("Unable to start generation worker");
+					exit(EXIT_FAILURE);
+				}
+			}
+
+			for (int32_t i = 0; i < threads; i++) {
+				pthread_join(workers[i].thread, NULL);
+			}
+		}
+	}
+
+	for (int32_t i = 0; i < threads; i++) {
+		destroySearchResult(&workers[i].searchResult);
+		destroyGamestate(&workers[i].gameState);
+		hash_destroyZTable(&workers[i].zTable);
+	}
+
+	const bool ok = fclose(file) == 0 && !queue.failed;
+	if (!ok) {
+		fprintf(stderr, "Unable to write [%s].\n", fileName);
+	}
+
+	result->bytes = PACKED_FILE_HEADER_SIZE + result->positions * PACKED_POSITION_SIZE;
+	result->elapsedMillis = getCurrentTimeMillis() - queue.start;
+
+	pthread_mutex_destroy(&queue.lock);
+	destroyHashSet(&queue.written);
+	free(workers);
+
+	return ok;
+}
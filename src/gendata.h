@@ -0,0 +1,61 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef GENDATA_H
+#define GENDATA_H
+
+#include <stdbool.h>
+#include <inttypes.h>
+
+#define GENDATA_MAX_THREADS 256
+
+// Games still running after this many plies are adjudicated as draws.
+#define GENDATA_MAX_PLIES 400
+
+// Options for generating training positions from self-play.
+typedef struct {
+	int64_t positions;          // Stop once this many positions are written.
+	int32_t threads;            // Games played at once, each with its own GameState and table.
+	int64_t nodes;              // Node limit of each move's search.
+	int32_t depth;              // Depth limit of each move's search.
+	int32_t randomPlies;        // Random moves played from the initial position to open each game.
+	int32_t maxNoise;           // Skip positions whose quiescence score and static evaluation differ by more.
+	uint64_t seed;              // Seeds the random openings; with one thread the output is reproducible.
+} GenDataArgs;
+
+// Totals of a generation run.
+typedef struct {
+	int64_t games;
+	int64_t positions;          // Positions written.
+	int64_t duplicates;         // Positions skipped because they were already written.
+	int64_t filtered;           // Positions skipped for being in check, noisy or decided.
+	int64_t bytes;
+	int64_t elapsedMillis;
+} GenDataResult;
+
+// Plays fixed-node self-play games from random openings and writes their quiet positions
+// to a packed position file (see packedpos.h), each labeled with the search score and the
+// game result. Positions are deduplicated by hash, and the file is flushed as it grows.
+// Returns false if the file can't be written.
+bool gendata_run(const char* fileName, GenDataArgs* args, GenDataResult* result);
+
+#endif
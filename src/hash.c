@@ -31,15 +31,20 @@
 #include "ztable.h"
 #include "string.h"
 
-int32_t hash_probe(GameState* state, int32_t currentDepth, int32_t alpha, int32_t beta) {
+int32_t hash_probe(GameState* state, int32_t draft, int32_t alpha, int32_t beta) {
+    bool hit;
+    return hash_probeWithHit(state, draft, alpha, beta, &hit);
+}
+
+int32_t hash_probeWithHit(GameState* state, int32_t draft, int32_t alpha, int32_t beta, bool* hit) {
     const uint64_t hash = state->current->hash;
-    ZTable* table = &state->zTable;
+    ZTable* table = state->zTable;
 
     ZTableEntry* entry = &table->data[hash % ZTABLE_SIZE];
+    *hit = entry->hash == hash && entry->generation == table->generation;
 
-    // Lower depths mean the hash was computer "higher" on the tree, so it's a more accurate score.
-    // E.g. a depth of MAX_DEPTH would be a leaf node, which has pretty shallow evaluation.
-    if (entry->hash == hash && currentDepth < entry->depth) {
+    // Only trust entries that were searched at least as deeply as we're about to search.
+    if (*hit && entry->depth >= draft) {
         if (entry->flag == HASHF_EXACT) {
             return entry->score;
         }
@@ -56,23 +61,35 @@ int32_t hash_probe(GameState* state, int32_t currentDepth, int32_t alpha, int32_
     return HASH_NOT_FOUND;
 }
 
-void hash_put(GameState* state, int32_t score, int32_t depth, int32_t flag) {
+void hash_put(GameState* state, int32_t score, int32_t draft, int32_t flag) {
     const uint64_t hash = state->current->hash;
-    ZTable* table = &state->zTable;
+    ZTable* table = state->zTable;
 
     ZTableEntry* entry = &table->data[hash % ZTABLE_SIZE];
 
     entry->score = score;
-    entry->depth = depth;
+    entry->depth = draft;
     entry->hash = hash;
     entry->flag = flag;
+    entry->generation = table->generation;
 }
 
 void hash_clearZTable(ZTable* table) {
     memset(table->data, 0, ZTABLE_SIZE * sizeof(ZTableEntry));
+    table->generation = 0;
+}
+
+void hash_newGeneration(ZTable* table) {
+    table->generation++;
+
+    // After wrapping around, entries from long ago would look current again.
+    if (table->generation == 0) {
+        hash_clearZTable(table);
+    }
 }
 
 void hash_createZTable(ZTable* table) {
+    table->generation = 0;
     table->data = calloc(ZTABLE_SIZE, sizeof(ZTableEntry));
     if (!table->data) {
         perror("Unable to allocate Zobrist table.");
@@ -84,6 +101,22 @@ void hash_destroyZTable(ZTable* table) {
     free(table->data);
 }
 
+static ZTable sharedZTable = {NULL, 0};
+
+static void destroySharedZTable() {
+    hash_destroyZTable(&sharedZTable);
+    sharedZTable.data = NULL;
+}
+
+ZTable* hash_sharedZTable() {
+    if (!sharedZTable.data) {
+        hash_createZTable(&sharedZTable);
+        atexit(destroySharedZTable);
+    }
+
+    return &sharedZTable;
+}
+
 uint64_t computeHash(GameState* gameState) {
     uint64_t h = 0;
 
@@ -106,6 +139,21 @@ uint64_t computeHash(GameState* gameState) {
     return h;
 }
 
+uint64_t computePawnHash(GameState* gameState) {
+    uint64_t h = 0;
+
+    for (int32_t i = 0; i < 64; i++) {
+        const int32_t sq = BOARD_SQUARES[i];
+        const int32_t ord = gameState->board[sq]->ordinal;
+
+        if (ord == ORD_WPAWN || ord == ORD_BPAWN) {
+            h ^= HASH_PIECE_SQ[sq][ord];
+        }
+    }
+
+    return h;
+}
+
 size_t hash_zTableSizeBytes() {
     return ZTABLE_SIZE * sizeof(ZTableEntry);
 }
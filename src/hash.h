@@ -35,11 +35,20 @@
 #define HASHF_ALPHA 1
 #define HASHF_BETA 2
 
-// Probe the hash table for a given state. Returns the score (if found) or HASH_NOT_FOUND otherwise.
-int32_t hash_probe(GameState* state, int32_t currentDepth, int32_t alpha, int32_t beta);
+// Draft for scores that no amount of further searching can change (mates and stalemates).
+#define HASH_DRAFT_FINAL INT_MAX
 
-// Put a new value in the hash table.
-void hash_put(GameState* state, int32_t score, int32_t depth, int32_t flag);
+// Probe the hash table for a given state. The draft is the number of plies left to search
+// below this node; only entries searched at least that deeply are used.
+// Returns the score (if found) or HASH_NOT_FOUND otherwise.
+int32_t hash_probe(GameState* state, int32_t draft, int32_t alpha, int32_t beta);
+
+// As hash_probe(), but also reports whether the table held an entry for this position at
+// all, whether or not it was deep enough or had a usable bound.
+int32_t hash_probeWithHit(GameState* state, int32_t draft, int32_t alpha, int32_t beta, bool* hit);
+
+// Put a new value in the hash table, along with the number of plies searched below it.
+void hash_put(GameState* state, int32_t score, int32_t draft, int32_t flag);
 
 // Creates a new ZTable of the given size.
 void hash_createZTable(ZTable* table);
@@ -47,9 +56,16 @@ void hash_createZTable(ZTable* table);
 // Clean up a ZTable
 void hash_destroyZTable(ZTable* table);
 
+// Get the process-wide ZTable, allocating it on first use. Not thread-safe: concurrent
+// searchers should create their own table and point their GameState's zTable at it.
+ZTable* hash_sharedZTable();
+
 // Reset a ZTable without reallocating memory
 void hash_clearZTable(ZTable* table);
 
+// Empty a ZTable in constant time: later probes ignore everything stored so far.
+void hash_newGeneration(ZTable* table);
+
 // Get the size of the ZTable in bytes.
 size_t hash_zTableSizeBytes();
 
@@ -60,4 +76,8 @@ void hash_friendlySize(char* str, size_t size);
 // SLOW. Do not use in tight loops.
 uint64_t computeHash(GameState* gameState);
 
+// Computes the hash of only the pawns in the given state.
+// SLOW. Do not use in tight loops.
+uint64_t computePawnHash(GameState* gameState);
+
 #endif
@@ -0,0 +1,77 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef INSTRUMENT_H
+#define INSTRUMENT_H
+
+#include <inttypes.h>
+
+// Hot-path instrumentation for the search. Build with -DTULIP_INSTRUMENT (see the
+// "instrumented" makefile target) to count calls and time spent in each subsystem below.
+// Without that flag every macro here expands to nothing, so normal builds pay no cost.
+//
+// Counters live in the SearchResult passed down through the search, so each searching
+// thread accumulates its own. Times are wall-clock nanoseconds from clock_gettime and
+// include the timer's own overhead; compare them against each other, not against an
+// uninstrumented build.
+
+#define INSTR_MOVEGEN       0 // generatePseudoMoves()
+#define INSTR_MAKEMOVE      1 // makeMove() and unmakeMove(), including null moves
+#define INSTR_LEGALITY      2 // isLegalPosition() and isCheck()
+#define INSTR_EVAL          3 // evaluate() at the leaves
+#define INSTR_TT_PROBE      4 // hash_probe()
+#define INSTR_TT_STORE      5 // hash_put()
+#define INSTR_QSEARCH       6 // qsearch(), inclusive of everything it calls
+#define INSTR_REPETITION    7 // draw_isSearchRepetition() and draw_isMaterial()
+#define INSTR_COUNT         8
+
+// A short name for the given subsystem, used as the JSON key and in the log.
+const char* instrument_name(int32_t subsystem);
+
+#ifdef TULIP_INSTRUMENT
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "util.h"
+
+typedef struct {
+	int64_t calls[INSTR_COUNT];
+	int64_t nanos[INSTR_COUNT];
+} InstrumentCounters;
+
+#define INSTRUMENT_RESET(counters) memset((counters), 0, sizeof(InstrumentCounters))
+#define INSTRUMENT_START(timer) const int64_t timer = getMonotonicTimeNanos()
+#define INSTRUMENT_STOP(counters, subsystem, timer) do { \
+		(counters)->calls[subsystem]++; \
+		(counters)->nanos[subsystem] += getMonotonicTimeNanos() - (timer); \
+	} while (0)
+
+#else
+
+#define INSTRUMENT_RESET(counters) ((void) 0)
+#define INSTRUMENT_START(timer) ((void) 0)
+#define INSTRUMENT_STOP(counters, subsystem, timer) ((void) 0)
+
+#endif
+
+#endif
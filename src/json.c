@@ -33,6 +33,8 @@
 #include "result.h"
 #include "search.h"
 #include "eval.h"
+#include "material.h"
+#include "movegen.h"
 
 #define __STDC_FORMAT_MACROS
 
@@ -92,6 +94,8 @@ static const char* printColor(int32_t color) {
     }
 }
 
+static void printGameStateObject(char* position, GameState* state);
+
 void printMovelistJson(char* position, char* listType, GameState* gameState, MoveBuffer* buffer) {
     char strBuff[16];
 
@@ -173,11 +177,16 @@ void printMakeMoveResult(char* position, Move* m, GameState* state) {
     printf("\"move\": \"%s\", ", moveStr);
     printf("\"originalState\": \"%s\", ", position);
     printf("\"resultingState\": ");
-    printGameState("", state);
+    printGameStateObject("", state);
     printf("}\n");
 }
 
 void printGameState(char* position, GameState* state) {
+    printGameStateObject(position, state);
+    printf("\n");
+}
+
+static void printGameStateObject(char* position, GameState* state) {
     char squareStr[8];
     StateData* stateData;
 
@@ -213,6 +222,15 @@ void printGameState(char* position, GameState* state) {
 
     printf("\"hash\": \"%016"PRIX64"\", ", state->current->hash);
     printf("\"recalculatedHash\": \"%016"PRIX64"\", ", computeHash(state));
+    printf("\"pawnHash\": \"%016"PRIX64"\", ", state->current->pawnHash);
+    printf("\"recalculatedPawnHash\": \"%016"PRIX64"\", ", computePawnHash(state));
+
+    int32_t mgScore, egScore;
+    computeStaticScores(state, &mgScore, &egScore);
+    printf("\"mgScore\": %i, \"recalculatedMgScore\": %i, ", stateData->mgScore, mgScore);
+    printf("\"egScore\": %i, \"recalculatedEgScore\": %i, ", stateData->egScore, egScore);
+    printf("\"materialKey\": \"%016"PRIX64"\", ", stateData->materialKey);
+    printf("\"recalculatedMaterialKey\": \"%016"PRIX64"\", ", computeMaterialKey(state));
 
     printf("\"board\": {");
     bool printedSq = false;
@@ -259,7 +277,7 @@ void printGameState(char* position, GameState* state) {
         printf("\"%c\": \"%016"PRIX64"\"", p->name, state->bitboards[p->ordinal]);
     }
     printf("}");
-    printf("}\n");
+    printf("}");
 }
 
 void printMatchMoveResult(Move* move) {
@@ -368,6 +386,299 @@ void printKingRectSize(char* sq, int32_t size) {
     printf("{\"square\": \"%s\", \"rectangleSize\": %d}\n", sq, size);
 }
 
+void printEvalBench(int32_t positions, int64_t evaluations, int64_t elapsedNanos, int64_t checksum) {
+    const double seconds = (double) elapsedNanos / 1e9;
+    printf("{");
+    printf("\"positions\": %i, ", positions);
+    printf("\"evaluations\": %"PRId64", ", evaluations);
+    printf("\"elapsedMillis\": %"PRId64", ", elapsedNanos / 1000000);
+    printf("\"nanosPerEval\": %.1f, ", evaluations > 0 ? (double) elapsedNanos / (double) evaluations : 0.0);
+    printf("\"evalsPerSecond\": %.0f, ", seconds > 0 ? (double) evaluations / seconds : 0.0);
+    printf("\"checksum\": %"PRId64"", checksum);
+    printf("}\n");
+}
+
+void printBenchResult(int32_t positions, int32_t depth, int64_t nodes, int64_t elapsedNanos) {
+    const double seconds = (double) elapsedNanos / 1e9;
+    printf("{");
+    printf("\"positions\": %i, ", positions);
+    printf("\"depth\": %i, ", depth);
+    printf("\"nodes\": %"PRId64", ", nodes);
+    printf("\"elapsedMillis\": %"PRId64", ", elapsedNanos / 1000000);
+    printf("\"nodesPerSecond\": %.0f", seconds > 0 ? (double) nodes / seconds : 0.0);
+    printf("}\n");
+}
+
+void printMicrobenchResults(MicrobenchResult* results, int32_t count, int32_t positions) {
+    printf("{");
+    printf("\"positions\": %i, ", positions);
+    printf("\"results\": [");
+    for (int32_t i = 0; i < count; i++) {
+        MicrobenchResult* r = &results[i];
+        if (i > 0) {
+            printf(", ");
+        }
+
+        printf("{\"name\": \"%s\", ", r->name);
+        printf("\"opsPerSample\": %"PRId64", ", r->opsPerSample);
+        printf("\"samples\": %i, ", r->samples);
+        printf("\"nanosPerOp\": %.3f, ", r->meanNanosPerOp);
+        printf("\"minNanosPerOp\": %.3f, ", r->minNanosPerOp);
+        printf("\"varianceNanosPerOp\": %.6f, ", r->varianceNanosPerOp);
+        printf("\"opsPerSecond\": %.0f}", r->opsPerSecond);
+    }
+
+    printf("]}\n");
+}
+
+void printBookWriteResult(const char* fileName, int64_t records) {
+    printf("{\"bookFile\": \"%s\", \"records\": %"PRId64"}\n", fileName, records);
+}
+
+void printBookBuildResult(const char* fileName, BookBuildResult* result) {
+    printf("{");
+    printf("\"bookFile\": \"%s\", ", fileName);
+    printf("\"games\": %"PRId64", ", result->games);
+    printf("\"errors\": %"PRId64", ", result->errors);
+    printf("\"positions\": %"PRId64", ", result->positions);
+    printf("\"records\": %"PRId64", ", result->records);
+    printf("\"elapsedMillis\": %"PRId64"", result->elapsedMillis);
+    printf("}\n");
+}
+
+void printGameFileStats(const char* fileName, GameFileStats* stats) {
+    printf("{");
+    printf("\"outputFile\": \"%s\", ", fileName);
+    printf("\"games\": %"PRId64", ", stats->games);
+    printf("\"errors\": %"PRId64", ", stats->errors);
+    printf("\"plies\": %"PRId64", ", stats->plies);
+    printf("\"bytes\": %"PRId64", ", stats->bytes);
+    printf("\"elapsedMillis\": %"PRId64"", stats->elapsedMillis);
+    printf("}\n");
+}
+
+static void printEngineConfig(EngineConfig* engine) {
+    printf("{\"depth\": %i, ", engine->depth);
+    printf("\"baseMillis\": %"PRId64", ", engine->baseMillis);
+    printf("\"incrementMillis\": %"PRId64"}", engine->incrementMillis);
+}
+
+void printSelfPlayResult(SelfPlayArgs* args, SelfPlayResult* result) {
+    printf("{");
+    printf("\"engine\": ");
+    printEngineConfig(&args->engines[0]);
+    printf(", \"baseline\": ");
+    printEngineConfig(&args->engines[1]);
+    printf(", \"games\": %i, ", result->games);
+    printf("\"wins\": %i, ", result->wins);
+    printf("\"draws\": %i, ", result->draws);
+    printf("\"losses\": %i, ", result->losses);
+    printf("\"timeLosses\": %i, ", result->timeLosses);
+    printf("\"openings\": %i, ", result->openings);
+    printf("\"plies\": %"PRId64", ", result->plies);
+    printf("\"elo\": %.2f, ", result->elo);
+    printf("\"eloError\": %.2f, ", result->eloError);
+    printf("\"elo0\": %.2f, ", args->elo0);
+    printf("\"elo1\": %.2f, ", args->elo1);
+    printf("\"llr\": %.3f, ", result->llr);
+    printf("\"lowerBound\": %.3f, ", result->lowerBound);
+    printf("\"upperBound\": %.3f, ", result->upperBound);
+    printf("\"verdict\": \"%s\", ", selfplay_verdictString(result->verdict));
+    printf("\"elapsedMillis\": %"PRId64"", result->elapsedMillis);
+    printf("}\n");
+}
+
+void printGenDataResult(const char* fileName, GenDataResult* result) {
+    printf("{");
+    printf("\"outputFile\": \"%s\", ", fileName);
+    printf("\"games\": %"PRId64", ", result->games);
+    printf("\"positions\": %"PRId64", ", result->positions);
+    printf("\"duplicates\": %"PRId64", ", result->duplicates);
+    printf("\"filtered\": %"PRId64", ", result->filtered);
+    printf("\"bytes\": %"PRId64", ", result->bytes);
+    printf("\"elapsedMillis\": %"PRId64"", result->elapsedMillis);
+    printf("}\n");
+}
+
+void printTuneResult(const char* fileName, TuneResult* result) {
+    printf("{");
+    printf("\"outputFile\": \"%s\", ", fileName);
+    printf("\"positions\": %"PRId64", ", result->positions);
+    printf("\"skipped\": %"PRId64", ", result->skipped);
+    printf("\"parameters\": %i, ", result->parameters);
+    printf("\"k\": %.4f, ", result->k);
+    printf("\"initialLoss\": %.6f, ", result->initialLoss);
+    printf("\"finalLoss\": %.6f, ", result->finalLoss);
+    printf("\"loadMillis\": %"PRId64", ", result->loadMillis);
+    printf("\"elapsedMillis\": %"PRId64"", result->elapsedMillis);
+    printf("}\n");
+}
+
+void printPackedFileStats(const char* fileName, PackedFileStats* stats) {
+    printf("{");
+    printf("\"outputFile\": \"%s\", ", fileName);
+    printf("\"positions\": %"PRId64", ", stats->positions);
+    printf("\"errors\": %"PRId64", ", stats->errors);
+    printf("\"bytes\": %"PRId64", ", stats->bytes);
+    printf("\"elapsedMillis\": %"PRId64"", stats->elapsedMillis);
+    printf("}\n");
+}
+
+void printIndexBuildResult(const char* fileName, PgnIndexResult* result) {
+    printf("{");
+    printf("\"indexFile\": \"%s\", ", fileName);
+    printf("\"games\": %"PRId64", ", result->games);
+    printf("\"errors\": %"PRId64", ", result->errors);
+    printf("\"postings\": %"PRId64", ", result->postings);
+    printf("\"totalGames\": %"PRIu64", ", result->totalGames);
+    printf("\"totalPostings\": %"PRIu64", ", result->totalPostings);
+    printf("\"elapsedMillis\": %"PRId64"", result->elapsedMillis);
+    printf("}\n");
+}
+
+void printIndexQueryResult(char* fen, GameState* state, IndexQueryResult* result) {
+    char coordStr[8];
+    char sanStr[16];
+    Move m;
+
+    printf("{");
+    printf("\"fenString\": \"%s\", ", fen);
+    printf("\"positionHash\": \"%016"PRIX64"\", ", result->hash);
+    printf("\"occurrences\": %"PRId64", ", result->postings);
+    printf("\"games\": %"PRId64", ", result->games);
+    printf("\"moves\": [");
+    for (int32_t i = 0; i < result->moveCount; i++) {
+        const IndexMoveCount* mc = &result->moves[i];
+
+        // A game that ended here has no next move; a hash collision can name an illegal one.
+        if (mc->move == PACKED_MOVE_NONE || !unpackMove(state, mc->move, &m)) {
+            coordStr[0] = sanStr[0] = '\0';
+        } else {
+            notation_printMoveCoordinate(&m, coordStr);
+            notation_printShortAlg(&m, state, sanStr);
+        }
+
+        printf("{\"move\": \"%s\", \"san\": \"%s\", \"count\": %"PRId64"}", coordStr, sanStr, mc->count);
+        if (i < result->moveCount - 1) {
+            printf(", ");
+        }
+    }
+    printf("], ");
+
+    printf("\"gameIds\": [");
+    for (int32_t i = 0; i < result->gameIdCount; i++) {
+        printf("%"PRIu32, result->gameIds[i]);
+        if (i < result->gameIdCount - 1) {
+            printf(", ");
+        }
+    }
+    printf("]");
+    printf("}\n");
+}
+
+void printPerftResult(char* position, int32_t depth, int64_t nodes, int64_t elapsedNanos) {
+    printf("{");
+    printf("\"fenString\": \"%s\", ", position);
+    printf("\"depth\": %i, ", depth);
+    printf("\"nodes\": %"PRId64", ", nodes);
+    printf("\"elapsedMillis\": %"PRId64"", elapsedNanos / 1000000);
+    printf("}\n");
+}
+
+void escapeJsonString(const char* str, char* out, size_t size) {
+    size_t len = 0;
+    for (const char* c = str; *c && len + 2 < size; c++) {
+        if (*c == '"' || *c == '\\') {
+            out[len++] = '\\';
+            out[len++] = *c;
+        } else if ((unsigned char) *c >= 0x20) {
+            out[len++] = *c;
+        }
+    }
+    out[len] = '\0';
+}
+
+void printServerError(const char* message) {
+    char escaped[512];
+    escapeJsonString(message, escaped, sizeof(escaped));
+    printf("{\"error\": \"%s\"}\n", escaped);
+}
+
+static void printStringArray(char strings[][EPD_MOVE_LEN], int32_t count) {
+    printf("[");
+    for (int32_t i = 0; i < count; i++) {
+        if (i > 0) {
+            printf(", ");
+        }
+
+        printf("\"%s\"", strings[i]);
+    }
+    printf("]");
+}
+
+void printSuiteReport(SuiteItem* items, int32_t count, int64_t moveTimeMillis, int64_t wallMillis) {
+    int32_t solved = 0;
+    int32_t invalid = 0;
+    int64_t nodes = 0;
+    int64_t searchMillis = 0;
+
+    for (int32_t i = 0; i < count; i++) {
+        if (!items[i].valid) {
+            invalid++;
+            continue;
+        }
+
+        solved += items[i].solved ? 1 : 0;
+        nodes += items[i].nodes;
+        searchMillis += items[i].elapsedMillis;
+    }
+
+    printf("{");
+    printf("\"positions\": %i, ", count);
+    printf("\"solved\": %i, ", solved);
+    printf("\"invalid\": %i, ", invalid);
+    printf("\"moveTimeMillis\": %"PRId64", ", moveTimeMillis);
+    printf("\"nodes\": %"PRId64", ", nodes);
+    printf("\"searchMillis\": %"PRId64", ", searchMillis);
+    printf("\"wallMillis\": %"PRId64", ", wallMillis);
+    printf("\"nodesPerSecond\": %.0f, ", wallMillis > 0 ? (double) nodes / (double) wallMillis * 1000.0 : 0.0);
+    printf("\"results\": [");
+
+    for (int32_t i = 0; i < count; i++) {
+        SuiteItem* item = &items[i];
+        if (i > 0) {
+            printf(", ");
+        }
+
+        printf("{\"line\": %"PRId64", ", item->lineNumber);
+        printf("\"id\": \"%s\", ", item->record.id);
+        printf("\"fenString\": \"%s\", ", item->record.fen);
+        printf("\"bestMoves\": ");
+        printStringArray(item->record.bestMoves, item->record.bestMoveCount);
+        printf(", \"avoidMoves\": ");
+        printStringArray(item->record.avoidMoves, item->record.avoidMoveCount);
+
+        if (!item->valid) {
+            printf(", \"error\": \"Unable to read position or its bm/am moves.\"}");
+            continue;
+        }
+
+        printf(", \"move\": \"%s\", ", item->move);
+        printf("\"score\": %i, ", item->score);
+        printf("\"solved\": %s, ", item->solved ? "true" : "false");
+        printf("\"timeToSolutionMillis\": ");
+        if (item->solved) {
+            printf("%"PRId64", ", item->solveTimeMillis);
+        } else {
+            printf("null, ");
+        }
+        printf("\"nodes\": %"PRId64", ", item->nodes);
+        printf("\"elapsedMillis\": %"PRId64"}", item->elapsedMillis);
+    }
+
+    printf("]}\n");
+}
+
 void printEndgameClassification(int32_t type) {
     const char* typeStr;
     if (type == ENDGAME_UNCLASSIFIED) {
@@ -383,6 +694,64 @@ void printEndgameClassification(int32_t type) {
     printf("{\"endgameType\":\"%s\"}\n", typeStr);
 }
 
+static double ratio(int64_t numerator, int64_t denominator) {
+    return denominator > 0 ? (double) numerator / (double) denominator : 0.0;
+}
+
+static void printSearchStats(SearchResult* result) {
+    SearchStats* stats = &result->stats;
+
+    printf("{\"betaCutoffs\": %i, ", result->betaCutoffs);
+    printf("\"betaCutoffRate\": %.4f, ", ratio(result->betaCutoffs, result->nodes));
+    printf("\"qsearchNodes\": %"PRId64", ", stats->qsearchNodes);
+    printf("\"qsearchShare\": %.4f, ", ratio(stats->qsearchNodes, result->nodes + stats->qsearchNodes));
+
+    // Effective branching factor: the growth in nodes from one iteration to the next. It's null when the
+    // previous depth wasn't searched, as when the deep search skips ahead of iterative deepening.
+    printf("\"iterations\": [");
+    bool first = true;
+    for (int32_t depth = 1; depth < SEARCH_STATS_PLIES; depth++) {
+        const int64_t nodes = stats->iterationNodes[depth];
+        const int64_t previousNodes = stats->iterationNodes[depth - 1];
+        if (nodes == 0) {
+            continue;
+        }
+
+        printf("%s{\"depth\": %i, \"nodes\": %"PRId64", \"ebf\": ", first ? "" : ", ", depth, nodes);
+        if (previousNodes > 0) {
+            printf("%.3f}", ratio(nodes, previousNodes));
+        } else {
+            printf("null}");
+        }
+
+        first = false;
+    }
+
+    printf("], \"plies\": [");
+    first = true;
+    for (int32_t ply = 0; ply < SEARCH_STATS_PLIES; ply++) {
+        PlyStats* p = &stats->plies[ply];
+        if (p->nodes == 0) {
+            continue;
+        }
+
+        printf("%s{\"ply\": %i, ", first ? "" : ", ", ply);
+        printf("\"nodes\": %"PRId64", ", p->nodes);
+        printf("\"pvNodes\": %"PRId64", ", p->pvNodes);
+        printf("\"cutNodes\": %"PRId64", ", p->cutNodes);
+        printf("\"allNodes\": %"PRId64", ", p->allNodes);
+        printf("\"firstMoveCutoffRate\": %.4f, ", ratio(p->firstMoveCutoffs, p->cutNodes));
+        printf("\"ttProbes\": %"PRId64", ", p->ttProbes);
+        printf("\"ttHitRate\": %.4f, ", ratio(p->ttHits, p->ttProbes));
+        printf("\"ttCutoffRate\": %.4f, ", ratio(p->ttCutoffs, p->ttProbes));
+        printf("\"nullMoveTries\": %"PRId64", ", p->nullMoveTries);
+        printf("\"nullMoveSuccessRate\": %.4f}", ratio(p->nullMoveCutoffs, p->nullMoveTries));
+        first = false;
+    }
+
+    printf("]}");
+}
+
 void printSearchResult(SearchResult* result, GameState* state) {
     char moveStr[16];
     const bool printMove = result->searchStatus == SEARCH_STATUS_NONE;
@@ -391,7 +760,14 @@ void printSearchResult(SearchResult* result, GameState* state) {
         notation_printShortAlg(&result->move, state, moveStr);
     }
 
-    const char* statusStr = result->searchStatus == SEARCH_STATUS_NONE ? "none" : "noLegalMoves";
+    const char* statusStr;
+    if (result->searchStatus == SEARCH_STATUS_NONE) {
+        statusStr = "none";
+    } else if (result->searchStatus == SEARCH_STATUS_NO_LEGAL_MOVES) {
+        statusStr = "noLegalMoves";
+    } else {
+        statusStr = "invalidDepth";
+    }
 
     printf("{\"searchResult\": {");
     printf("\"move\": ");
@@ -424,5 +800,26 @@ void printSearchResult(SearchResult* result, GameState* state) {
         notation_printShortAlg(&score.move, state, moveStr);
         printf("{\"move\":\"%s\", \"score\":%i, \"depth\":%i}", moveStr, score.score, score.depth);
     }
-    printf("]}}");
+    printf("]");
+
+    printf(", \"stats\": ");
+    printSearchStats(result);
+
+#ifdef TULIP_INSTRUMENT
+    printf(", \"instrumentation\": {");
+    for (int32_t i = 0; i < INSTR_COUNT; i++) {
+        const int64_t calls = result->instrument.calls[i];
+        const int64_t nanos = result->instrument.nanos[i];
+        if (i != 0) {
+            printf(", ");
+        }
+
+        printf("\"%s\": {\"calls\": %"PRId64", \"callsPerNode\": %.3f, \"elapsedMs\": %.3f, \"nanosPerCall\": %.1f}",
+               instrument_name(i), calls, result->nodes > 0 ? (double) calls / (double) result->nodes : 0.0,
+               (double) nanos / 1e6, calls > 0 ? (double) nanos / (double) calls : 0.0);
+    }
+    printf("}");
+#endif
+
+    printf("}}");
 }
@@ -27,6 +27,15 @@
 #include "gamestate.h"
 #include "statedata.h"
 #include "search.h"
+#include "suite.h"
+#include "microbench.h"
+#include "bookbuild.h"
+#include "pgnindex.h"
+#include "gamefile.h"
+#include "packedpos.h"
+#include "selfplay.h"
+#include "gendata.h"
+#include "tune.h"
 
 void printMovelistJson(char*, char*, GameState*, MoveBuffer*);
 void printGameState(char*, GameState*);
@@ -40,6 +49,41 @@ void printSearchResult(SearchResult* result, GameState* state);
 void printEndgameClassification(int32_t type);
 void printPassedPawns(char* position, int32_t* wPawns, int32_t wCount, int32_t* bPawns, int32_t bCount);
 void printKingRectSize(char* squareStr, int32_t size);
+void printEvalBench(int32_t positions, int64_t evaluations, int64_t elapsedNanos, int64_t checksum);
+void printBenchResult(int32_t positions, int32_t depth, int64_t nodes, int64_t elapsedNanos);
+void printBookWriteResult(const char* fileName, int64_t records);
+
+// Print the totals of a book built from a PGN file.
+void printBookBuildResult(const char* fileName, BookBuildResult* result);
+
+// Print the totals of a conversion between PGN and a game file.
+void printGameFileStats(const char* fileName, GameFileStats* stats);
+
+// Print the outcome of a self-play match.
+void printSelfPlayResult(SelfPlayArgs* args, SelfPlayResult* result);
+
+// Print the totals of a training data generation run.
+void printGenDataResult(const char* fileName, GenDataResult* result);
+
+// Print the totals of an evaluation tuning run.
+void printTuneResult(const char* fileName, TuneResult* result);
+
+// Print the totals of a conversion between FEN and packed positions.
+void printPackedFileStats(const char* fileName, PackedFileStats* stats);
+
+// Print the totals of indexing a PGN file.
+void printIndexBuildResult(const char* fileName, PgnIndexResult* result);
+
+// Print what a PGN index knows about a position: the moves played from it and the games that reached it.
+void printIndexQueryResult(char* fen, GameState* state, IndexQueryResult* result);
+void printPerftResult(char* position, int32_t depth, int64_t nodes, int64_t elapsedNanos);
+void printServerError(const char* message);
+
+// Copy a string into out, escaped for use inside a JSON string literal. Quotes and backslashes are
+// escaped and control characters dropped; the result is truncated to fit in size bytes.
+void escapeJsonString(const char* str, char* out, size_t size);
+void printSuiteReport(SuiteItem* items, int32_t count, int64_t moveTimeMillis, int64_t wallMillis);
+void printMicrobenchResults(MicrobenchResult* results, int32_t count, int32_t positions);
 
 typedef struct {
     char move[8];
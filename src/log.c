@@ -20,91 +20,178 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#define _POSIX_C_SOURCE 200112L // For localtime_r() and nanosleep() with -std=c99
+
 #include <stdio.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <time.h>
 #include <unistd.h>
 #include <stdarg.h>
+#include <inttypes.h>
+#include <pthread.h>
 
 #include "log.h"
 
 #define DATE_BUFF_SIZE 32
 #define FILE_NAME_SIZE 128
+#define RING_MASK (LOG_RING_SIZE - 1)
+
+// How long the writer thread sleeps when it finds the ring empty.
+#define WRITER_IDLE_NANOS (5 * 1000000L)
+
+// Each slot's sequence number says who owns it. A slot for position p is free for a
+// writer when its sequence equals p; once the message is in place the writer sets it to
+// p + 1, handing it to the writer thread, which sets it to p + LOG_RING_SIZE when done so
+// the next lap's writer can claim it.
 
-static void printDt(char* buff, const char* format) {
-	struct tm* tm_info;
-	time_t timer;
+static const char* LEVEL_NAMES[] = {"DEBUG", "INFO", "WARN"};
 
-	time(&timer);
-	tm_info = localtime(&timer);
-	strftime(buff, DATE_BUFF_SIZE, format, tm_info);
+static void printDt(char* buff, const char* format, time_t timer) {
+	struct tm tm_info;
+
+	localtime_r(&timer, &tm_info);
+	strftime(buff, DATE_BUFF_SIZE, format, &tm_info);
 }
 
-static void writeEntry(GameLog* log, const char* message) {
-	if (log != NULL) {
-		char dateBuff[DATE_BUFF_SIZE];
-		printDt(dateBuff, "%F %H:%M:%S%z");
+static void writeEntry(GameLog* log, time_t timer, int32_t level, const char* message) {
+	char dateBuff[DATE_BUFF_SIZE];
+	printDt(dateBuff, "%F %H:%M:%S%z", timer);
+
+	fprintf(log->fh, "%s\t%s\t%s\n", dateBuff, LEVEL_NAMES[level], message);
+}
+
+// Write out every record that's ready. Returns the number written.
+static int32_t drainRecords(GameLog* log) {
+	int32_t written = 0;
 
-		fprintf(log->fh, "%s\t%s\n", dateBuff, message);
-		fflush(log->fh);
+	const uint64_t dropped = __atomic_exchange_n(&log->dropped, 0, __ATOMIC_RELAXED);
+	if (dropped > 0) {
+		char message[64];
+		snprintf(message, sizeof(message), "Log buffer full; dropped %"PRIu64" records.", dropped);
+		writeEntry(log, time(NULL), LOG_LEVEL_WARN, message);
+		written++;
 	}
+
+	for (;;) {
+		LogRecord* record = &log->records[log->tail & RING_MASK];
+		if (__atomic_load_n(&record->sequence, __ATOMIC_ACQUIRE) != log->tail + 1) {
+			break;
+		}
+
+		writeEntry(log, record->time, record->level, record->message);
+		__atomic_store_n(&record->sequence, log->tail + LOG_RING_SIZE, __ATOMIC_RELEASE);
+		log->tail++;
+		written++;
+	}
+
+	return written;
+}
+
+static void* runWriter(void* arg) {
+	GameLog* log = (GameLog*) arg;
+	const struct timespec idle = {0, WRITER_IDLE_NANOS};
+
+	for (;;) {
+		// Check for shutdown before draining, so that everything queued before log_close()
+		// is written out before the thread exits.
+		const bool stopping = __atomic_load_n(&log->stopping, __ATOMIC_ACQUIRE);
+
+		if (drainRecords(log) > 0) {
+			fflush(log->fh);
+		} else if (stopping) {
+			break;
+		} else {
+			nanosleep(&idle, NULL);
+		}
+	}
+
+	return NULL;
 }
 
 bool log_open(GameLog* log) {
-	char* fname;
+	char fname[FILE_NAME_SIZE];
 	char dateBuff[DATE_BUFF_SIZE];
 
-	fname = malloc(FILE_NAME_SIZE * sizeof(char));
-	if (!fname) {
-		perror("Unable allocate memory for log file name.");
+	printDt(dateBuff, "%F-%H%M%S", time(NULL));
+	snprintf(fname, FILE_NAME_SIZE, "game-%s-p%i.log", dateBuff, getpid());
+
+	log->fh = fopen(fname, "w");
+	if (!log->fh) {
+		perror("Unable to open log file.");
+		return false;
+	}
+
+	log->records = malloc(LOG_RING_SIZE * sizeof(LogRecord));
+	if (!log->records) {
+		perror("Unable to allocate the log buffer.");
 		exit(-1);
 	}
 
-	printDt(dateBuff, "%F-%H%M%S");
-	snprintf(fname, FILE_NAME_SIZE, "game-%s-p%i.log", dateBuff, getpid());
+	for (uint64_t i = 0; i < LOG_RING_SIZE; i++) {
+		log->records[i].sequence = i;
+	}
 
-	bool result = false;
-	log->fh = fopen(fname, "w");
+	log->head = 0;
+	log->tail = 0;
+	log->dropped = 0;
+	log->stopping = false;
 
-	if (log->fh) {
-		result = true;
-		writeEntry(log, "Opened log.");
-	} else {
-		perror("Unable to open log file.");
-		goto open_log_fail;
+	if (pthread_create(&log->writer, NULL, runWriter, log) != 0) {
+		perror("Unable to start the log writer thread.");
+		fclose(log->fh);
+		free(log->records);
+		return false;
 	}
 
-open_log_fail:
-	free(fname);
-	return result;
+	log_write(log, "Opened log.");
+	return true;
 }
 
-void log_write(GameLog* log, const char* format, ...) {
-	if (log != NULL) {
-		char* outputMessage = malloc(LOG_BUFFER_SIZE * sizeof(char));
+void log_writeLevel(GameLog* log, int32_t level, const char* format, ...) {
+	if (log == NULL) {
+		return;
+	}
 
-		if (!outputMessage) {
-			perror("Error: Unable to allocate log message buffer.\n");
-			exit(-1);
+	// Claim the next free slot, or give up if the writer thread is a full lap behind.
+	uint64_t pos = __atomic_load_n(&log->head, __ATOMIC_RELAXED);
+	LogRecord* record;
+	for (;;) {
+		record = &log->records[pos & RING_MASK];
+		const uint64_t sequence = __atomic_load_n(&record->sequence, __ATOMIC_ACQUIRE);
+
+		if (sequence == pos) {
+			if (__atomic_compare_exchange_n(&log->head, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+				break;
+			}
+		} else if (sequence < pos) {
+			__atomic_add_fetch(&log->dropped, 1, __ATOMIC_RELAXED);
+			return;
+		} else {
+			pos = __atomic_load_n(&log->head, __ATOMIC_RELAXED);
 		}
+	}
 
-		va_list argptr;
-		va_start(argptr, format);
-		vsnprintf(outputMessage, LOG_BUFFER_SIZE, format, argptr);
-		va_end(argptr);
-
-		writeEntry(log, outputMessage);
+	va_list argptr;
+	va_start(argptr, format);
+	vsnprintf(record->message, LOG_BUFFER_SIZE, format, argptr);
+	va_end(argptr);
 
-		free(outputMessage);
-	}
+	record->time = time(NULL);
+	record->level = level;
+	__atomic_store_n(&record->sequence, pos + 1, __ATOMIC_RELEASE);
 }
 
 void log_close(GameLog* log) {
 	if (log != NULL) {
+		__atomic_store_n(&log->stopping, true, __ATOMIC_RELEASE);
+		pthread_join(log->writer, NULL);
 		fclose(log->fh);
+		free(log->records);
 	}
 }
 
 #undef DATE_BUFF_SIZE
 #undef FILE_NAME_SIZE
+#undef RING_MASK
+#undef WRITER_IDLE_NANOS
@@ -25,22 +25,68 @@
 
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
 
+// The maximum size of a log message.
+#define LOG_BUFFER_SIZE 2048
+
+// The number of records the log can hold before the writer thread catches up.
+// Must be a power of two.
+#define LOG_RING_SIZE 256
+
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO  1
+#define LOG_LEVEL_WARN  2
+
+// Records below this level are compiled out entirely; build with
+// -DTULIP_LOG_MIN_LEVEL=1 to drop debug records.
+#ifndef TULIP_LOG_MIN_LEVEL
+#define TULIP_LOG_MIN_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+// One pre-formatted message waiting in the ring buffer.
+typedef struct {
+	uint64_t sequence;      // Slot state; see log.c.
+	time_t time;
+	int32_t level;
+	char message[LOG_BUFFER_SIZE];
+} LogRecord;
+
+// Writers format their message into a slot of a fixed ring buffer without taking a
+// lock or allocating; a background thread timestamps, writes and flushes the records
+// in batches. If the ring is full the record is dropped (and counted) rather than
+// making the caller wait.
 typedef struct {
 	FILE* fh;
+	LogRecord* records;     // The ring buffer, LOG_RING_SIZE records.
+	uint64_t head;          // The next slot to be claimed by a writer.
+	uint64_t tail;          // The next slot to be written out; writer thread only.
+	uint64_t dropped;       // Records dropped because the ring was full.
+	bool stopping;          // Set by log_close() to stop the writer thread.
+	pthread_t writer;
 } GameLog;
 
-// The maximum size of a log message.
-#define LOG_BUFFER_SIZE 2048
-
-// Open up a game log for writing.
+// Open up a game log for writing and start its writer thread.
 // Returns true on success, false on failure.
 bool log_open(GameLog* log);
 
+// Queue a formatted message at the given level. Safe to call from any thread, and
+// a no-op if log is NULL.
+void log_writeLevel(GameLog* log, int32_t level, const char* format, ...);
+
 // Write a formatted message to the log.
-void log_write(GameLog* log, const char* format, ...);
+#define log_write(log, ...) log_writeLevel((log), LOG_LEVEL_INFO, __VA_ARGS__)
+
+// Write a formatted debug message to the log; compiled out below TULIP_LOG_MIN_LEVEL.
+#define log_debug(log, ...) do { \
+		if (TULIP_LOG_MIN_LEVEL <= LOG_LEVEL_DEBUG) { \
+			log_writeLevel((log), LOG_LEVEL_DEBUG, __VA_ARGS__); \
+		} \
+	} while (0)
 
-// Close a log.
+// Write out any queued messages, stop the writer thread and close the log.
 void log_close(GameLog* log);
 
 #endif
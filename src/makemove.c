@@ -31,10 +31,34 @@
 #include "board.h"
 #include "makemove.h"
 #include "statedata.h"
+#include "evalparams.h"
+#include "material.h"
+#include "draw.h"
 
 // Useful to debug what's being hashed in to the position
 #define APPLY_MASK(mask) /*printf("applying mask to %016"PRIX64": %016"PRIX64"\n", hash, (uint64_t) (mask));*/ hash ^= (mask);
 
+// Add or remove a piece's material and piece-square value from the running scores
+// and the material key, and toggle it in the pawn hash if it's a pawn.
+// There's nothing to do on unmake; the previous StateData on the stack still has the old values.
+static inline void addPieceScore(StateData* sd, const int32_t ordinal, const int32_t sq) {
+        sd->mgScore += PSQ_MG(ordinal, sq);
+        sd->egScore += PSQ_EG(ordinal, sq);
+        sd->materialKey += MATERIAL_KEY_UNITS[ordinal];
+        if (ordinal == ORD_WPAWN || ordinal == ORD_BPAWN) {
+                sd->pawnHash ^= HASH_PIECE_SQ[sq][ordinal];
+        }
+}
+
+static inline void removePieceScore(StateData* sd, const int32_t ordinal, const int32_t sq) {
+        sd->mgScore -= PSQ_MG(ordinal, sq);
+        sd->egScore -= PSQ_EG(ordinal, sq);
+        sd->materialKey -= MATERIAL_KEY_UNITS[ordinal];
+        if (ordinal == ORD_WPAWN || ordinal == ORD_BPAWN) {
+                sd->pawnHash ^= HASH_PIECE_SQ[sq][ordinal];
+        }
+}
+
 static void unCastleRook(GameState* gameState, const int homeSq, const int rookCastledSq, const int rookOrdinal, const Piece* rook) {
         const Piece** board = gameState->board;
         uint64_t* emptyBb = &gameState->bitboards[ORD_EMPTY];
@@ -51,6 +75,8 @@ static void whiteKingCastle(Move* move, GameState* gs, uint64_t* runningHash) {
                 gs->board[SQ_H1] = &EMPTY;
                 gs->board[SQ_F1] = &WROOK;
                 APPLY_MASK(HASH_MASK_CASTLE_WK);
+                removePieceScore(gs->current, ORD_WROOK, SQ_H1);
+                addPieceScore(gs->current, ORD_WROOK, SQ_F1);
                 uint64_t* rb = &gs->bitboards[ORD_WROOK];
                 uint64_t* eb = &gs->bitboards[ORD_EMPTY];
                 *rb = (*rb & ~((uint64_t)BIT_SQ_H1)) | ((uint64_t)BIT_SQ_F1);
@@ -59,6 +85,8 @@ static void whiteKingCastle(Move* move, GameState* gs, uint64_t* runningHash) {
                 gs->board[SQ_A1] = &EMPTY;
                 gs->board[SQ_D1] = &WROOK;
                 APPLY_MASK(HASH_MASK_CASTLE_WQ);
+                removePieceScore(gs->current, ORD_WROOK, SQ_A1);
+                addPieceScore(gs->current, ORD_WROOK, SQ_D1);
                 uint64_t* rb = &gs->bitboards[ORD_WROOK];
                 uint64_t* eb = &gs->bitboards[ORD_EMPTY];
                 *rb = (*rb & ~BIT_SQ_A1) | BIT_SQ_D1;
@@ -73,6 +101,8 @@ static void blackKingCastle(Move* move, GameState* gs, uint64_t* runningHash) {
                 gs->board[SQ_H8] = &EMPTY;
                 gs->board[SQ_F8] = &BROOK;
                 APPLY_MASK(HASH_MASK_CASTLE_BK);
+                removePieceScore(gs->current, ORD_BROOK, SQ_H8);
+                addPieceScore(gs->current, ORD_BROOK, SQ_F8);
                 uint64_t* rb = &gs->bitboards[ORD_BROOK];
                 uint64_t* eb = &gs->bitboards[ORD_EMPTY];
                 *rb = (*rb & ~BIT_SQ_H8) | BIT_SQ_F8;
@@ -81,6 +111,8 @@ static void blackKingCastle(Move* move, GameState* gs, uint64_t* runningHash) {
                 gs->board[SQ_A8] = &EMPTY;
                 gs->board[SQ_D8] = &BROOK;
                 APPLY_MASK(HASH_MASK_CASTLE_BQ);
+                removePieceScore(gs->current, ORD_BROOK, SQ_A8);
+                addPieceScore(gs->current, ORD_BROOK, SQ_D8);
                 uint64_t* rb = &gs->bitboards[ORD_BROOK];
                 uint64_t* eb = &gs->bitboards[ORD_EMPTY];
                 *rb = (*rb & ~BIT_SQ_A8) | BIT_SQ_D8;
@@ -113,6 +145,10 @@ static void promotePawn(Move* move, GameState* gs, const int color, const int pa
         gs->board[move->to] = promotePiece;
         gs->pieceCounts[promotePiece->ordinal]++;
 
+        // makeMove() scored the pawn as arriving on the promotion square; swap it for the new piece.
+        removePieceScore(gs->current, pawnOrdinal, move->to);
+        addPieceScore(gs->current, promotePiece->ordinal, move->to);
+
         *runningHash = hash;
 }
 
@@ -126,6 +162,7 @@ static void enPassant(GameState* gs, Move* move, const int attackSq, uint64_t* r
         gs->board[attackSq] = &EMPTY;
         APPLY_MASK(HASH_PIECE_SQ[attackSq][move->captures->ordinal]);
         APPLY_MASK(HASH_PIECE_SQ[attackSq][ORD_EMPTY]);
+        removePieceScore(gs->current, move->captures->ordinal, attackSq);
 
         // Put attacking pawn in new place
         uint64_t* movingBb = &gs->bitboards[move->movingPiece->ordinal];
@@ -151,9 +188,11 @@ void makeNullMove(GameState* gameState) {
         nextData->epFile = NO_EP_FILE;
 
         nextData->hash = hash;
+        draw_pushNullMove(gameState);
 }
 
 void unmakeNullMove(GameState* gameState) {
+        draw_popNullMove(gameState);
         gameState->current--;
 }
 
@@ -225,6 +264,14 @@ void makeMove(GameState* gameState, Move* move) {
         APPLY_MASK(HASH_PIECE_SQ[sqTo][movingPiece->ordinal]);
         board[sqTo] = movingPiece;
 
+        // Update the running material and piece-square scores.
+        // En passant captures remove the captured pawn in enPassant(), since it isn't on the target square.
+        removePieceScore(nextData, movingPiece->ordinal, sqFrom);
+        addPieceScore(nextData, movingPiece->ordinal, sqTo);
+        if (move->moveCode != CAPTURE_EP) {
+                removePieceScore(nextData, capturedPiece->ordinal, sqTo);
+        }
+
         // Update EP file
         int32_t oldEpFile = nextData->epFile;
         int32_t newEpFile = isPawn && abs(sqTo - sqFrom) == (2 * OFFSET_N)
@@ -297,10 +344,30 @@ void makeMove(GameState* gameState, Move* move) {
                 break;
         }
 
+        // Capturing a rook in its corner takes away the castling it could have been part of.
+        if (isCapture && capturedPiece->ordinal == ORD_WROOK) {
+                const int32_t lostFlag = sqTo == SQ_H1 ? CASTLE_WK : (sqTo == SQ_A1 ? CASTLE_WQ : 0);
+                if (nextData->castleFlags & lostFlag) {
+                        APPLY_MASK(HASH_PIECE_CASTLE[nextData->castleFlags]);
+                        nextData->castleFlags &= ~lostFlag;
+                        APPLY_MASK(HASH_PIECE_CASTLE[nextData->castleFlags]);
+                }
+        } else if (isCapture && capturedPiece->ordinal == ORD_BROOK) {
+                const int32_t lostFlag = sqTo == SQ_H8 ? CASTLE_BK : (sqTo == SQ_A8 ? CASTLE_BQ : 0);
+                if (nextData->castleFlags & lostFlag) {
+                        APPLY_MASK(HASH_PIECE_CASTLE[nextData->castleFlags]);
+                        nextData->castleFlags &= ~lostFlag;
+                        APPLY_MASK(HASH_PIECE_CASTLE[nextData->castleFlags]);
+                }
+        }
+
         nextData->hash = hash;
+        draw_pushPosition(gameState);
 }
 
 void unmakeMove(GameState* gameState, Move* move) {
+        draw_popPosition(gameState);
+
         const Piece** board = gameState->board;
         const Piece* moving = move->movingPiece;
         const Piece* captured = move->captures;
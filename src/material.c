@@ -0,0 +1,169 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "tulip.h"
+#include "piece.h"
+#include "evalconsts.h"
+#include "evalparams.h"
+#include "eval.h"
+#include "gamestate.h"
+#include "material.h"
+
+#define KEY_UNIT(ord) ((uint64_t) 1 << (4 * (ord)))
+
+const uint64_t MATERIAL_KEY_UNITS[ORD_MAX + 1] = {
+	KEY_UNIT(ORD_WPAWN), KEY_UNIT(ORD_BPAWN),
+	KEY_UNIT(ORD_WKNIGHT), KEY_UNIT(ORD_BKNIGHT),
+	KEY_UNIT(ORD_WBISHOP), KEY_UNIT(ORD_BBISHOP),
+	KEY_UNIT(ORD_WROOK), KEY_UNIT(ORD_BROOK),
+	KEY_UNIT(ORD_WQUEEN), KEY_UNIT(ORD_BQUEEN),
+	0, 0, // Kings are always present.
+	0, 0, // Empty, off board
+};
+
+#undef KEY_UNIT
+
+// Figure out which endgame (if any) has a specialized evaluation.
+// "Strong" and "weak" are the two sides; the weak side has a bare king.
+static EndgameEval findEndgame(const int32_t* c, const int32_t strongPawn, const int32_t strongKnight,
+                               const int32_t strongBishop, const int32_t strongRook, const int32_t strongQueen) {
+	const int32_t pawns = c[strongPawn];
+	const int32_t knights = c[strongKnight];
+	const int32_t bishops = c[strongBishop];
+	const int32_t heavies = c[strongRook] + c[strongQueen];
+
+	if (pawns == 0 && knights == 0 && bishops == 0 && heavies == 1) {
+		return evaluateKXK;
+	}
+
+	if (pawns == 0 && knights == 1 && bishops == 1 && heavies == 0) {
+		return evaluateKBNK;
+	}
+
+	if (pawns == 1 && knights == 0 && bishops == 0 && heavies == 0) {
+		return evaluateKPK;
+	}
+
+	return NULL;
+}
+
+static void fillEntry(GameState* state, MaterialEntry* e) {
+	const int32_t* c = state->pieceCounts;
+
+	const int32_t wMaterial = c[ORD_WPAWN] + c[ORD_WKNIGHT] + c[ORD_WBISHOP] + c[ORD_WROOK] + c[ORD_WQUEEN];
+	const int32_t bMaterial = c[ORD_BPAWN] + c[ORD_BKNIGHT] + c[ORD_BBISHOP] + c[ORD_BROOK] + c[ORD_BQUEEN];
+	const int32_t pawns = c[ORD_WPAWN] + c[ORD_BPAWN];
+	const int32_t knights = c[ORD_WKNIGHT] + c[ORD_BKNIGHT];
+	const int32_t bishops = c[ORD_WBISHOP] + c[ORD_BBISHOP];
+	const int32_t heavies = c[ORD_WROOK] + c[ORD_BROOK] + c[ORD_WQUEEN] + c[ORD_BQUEEN];
+
+	e->phase = MIN(computePhase(state), PHASE_MAX);
+
+	const int32_t bishopPairs = (c[ORD_WBISHOP] >= 2) - (c[ORD_BBISHOP] >= 2);
+	e->mgImbalance = EVAL_PARAMS->bishopPairMg * bishopPairs;
+	e->egImbalance = EVAL_PARAMS->bishopPairEg * bishopPairs;
+
+	e->drawType = MATERIAL_NOT_DRAWN;
+	if (pawns == 0 && heavies == 0) {
+		if (knights + bishops <= 1) {
+			e->drawType = MATERIAL_DRAW;
+		} else if (knights == 0 && c[ORD_WBISHOP] > 0 && c[ORD_BBISHOP] > 0) {
+			e->drawType = MATERIAL_DRAW_IF_BISHOPS_SAME_COLOR;
+		}
+	}
+
+	// Exactly one non-pawn piece besides the kings, and it's a rook or a queen.
+	e->endgameType = ENDGAME_UNCLASSIFIED;
+	if (knights + bishops + heavies == 1) {
+		if (c[ORD_BROOK] || c[ORD_BQUEEN]) {
+			e->endgameType = ENDGAME_BROOKvKING;
+		} else if (c[ORD_WROOK] || c[ORD_WQUEEN]) {
+			e->endgameType = ENDGAME_WROOKvKING;
+		}
+	}
+
+	e->endgame = NULL;
+	if (e->drawType == MATERIAL_NOT_DRAWN) {
+		if (bMaterial == 0) {
+			e->endgame = findEndgame(c, ORD_WPAWN, ORD_WKNIGHT, ORD_WBISHOP, ORD_WROOK, ORD_WQUEEN);
+		} else if (wMaterial == 0) {
+			e->endgame = findEndgame(c, ORD_BPAWN, ORD_BKNIGHT, ORD_BBISHOP, ORD_BROOK, ORD_BQUEEN);
+		}
+	}
+}
+
+// The table is allocated by the first probe, like the pawn table.
+static void allocateTable(MaterialTable* table) {
+	table->data = calloc(MATERIAL_TABLE_SIZE, sizeof(MaterialEntry));
+	if (!table->data) {
+		perror("Unable to allocate material table.");
+		exit(-1);
+	}
+}
+
+const MaterialEntry* material_probe(GameState* state) {
+	const uint64_t key = state->current->materialKey;
+
+	// Fibonacci hashing spreads the packed counts over the table.
+	const uint64_t idx = (key * (uint64_t) 0x9E3779B97F4A7C15) >> (64 - MATERIAL_TABLE_BITS);
+	if (!state->materialTable.data) {
+		allocateTable(&state->materialTable);
+	}
+
+	MaterialEntry* e = &state->materialTable.data[idx];
+
+	if (!e->filled || e->key != key) {
+		fillEntry(state, e);
+		e->key = key;
+		e->filled = true;
+	}
+
+	return e;
+}
+
+uint64_t computeMaterialKey(GameState* state) {
+	uint64_t key = 0;
+	for (int32_t ord = 0; ord <= ORD_MAX; ord++) {
+		key += (uint64_t) state->pieceCounts[ord] * MATERIAL_KEY_UNITS[ord];
+	}
+	return key;
+}
+
+void material_createTable(MaterialTable* table) {
+	table->data = NULL;
+}
+
+void material_clearTable(MaterialTable* table) {
+	if (table->data) {
+		memset(table->data, 0, MATERIAL_TABLE_SIZE * sizeof(MaterialEntry));
+	}
+}
+
+void material_destroyTable(MaterialTable* table) {
+	free(table->data);
+	table->data = NULL;
+}
@@ -0,0 +1,74 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef MATERIAL_H
+#define MATERIAL_H
+
+#include <stdbool.h>
+#include <inttypes.h>
+
+#include "materialtable.h"
+#include "gamestate.h"
+
+// Draw types for a material signature.
+#define MATERIAL_NOT_DRAWN                  0
+#define MATERIAL_DRAW                       1 // KvK, KNvK, KBvK
+#define MATERIAL_DRAW_IF_BISHOPS_SAME_COLOR 2 // Kings and bishops only, bishops on both sides
+
+// A specialized evaluation for a recognized endgame. Returns a white-relative
+// score that replaces the general evaluation.
+typedef int32_t (*EndgameEval)(GameState* state);
+
+// Everything about a position that depends only on the count of each piece type.
+typedef struct MaterialEntry {
+	uint64_t key;           // The material key this entry was computed for.
+	bool filled;            // False for an unused slot (a zero key is a real signature: KvK).
+	int32_t phase;          // Game phase, from PHASE_MAX down to 0. See evalconsts.h.
+	int32_t mgImbalance;    // Middlegame score adjustment for the piece mix, white positive.
+	int32_t egImbalance;    // Endgame score adjustment for the piece mix, white positive.
+	int32_t drawType;       // One of the MATERIAL_* draw types.
+	int32_t endgameType;    // One of the ENDGAME_* classifications in eval.h.
+	EndgameEval endgame;    // Specialized evaluation, or NULL to use the general one.
+} MaterialEntry;
+
+// Per-ordinal increments of the material key. The key packs the count of each
+// non-king piece type into its own 4-bit field, so it identifies the material
+// signature exactly. makeMove() keeps it current in StateData.
+extern const uint64_t MATERIAL_KEY_UNITS[ORD_MAX + 1];
+
+// Look up the material entry for the current position, computing and storing
+// it first if it isn't in the table.
+const MaterialEntry* material_probe(GameState* state);
+
+// Computes the material key of the given state from its piece counts.
+uint64_t computeMaterialKey(GameState* state);
+
+// Creates an empty material table. Its storage is allocated by the first probe.
+void material_createTable(MaterialTable* table);
+
+// Empties the table, such as after the evaluation weights change.
+void material_clearTable(MaterialTable* table);
+
+// Clean up a material table.
+void material_destroyTable(MaterialTable* table);
+
+#endif
@@ -0,0 +1,304 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "tulip.h"
+#include "microbench.h"
+#include "attack.h"
+#include "bench.h"
+#include "board.h"
+#include "draw.h"
+#include "eval.h"
+#include "evalparams.h"
+#include "fen.h"
+#include "gamestate.h"
+#include "hash.h"
+#include "json.h"
+#include "makemove.h"
+#include "movegen.h"
+#include "notation.h"
+#include "search.h"
+#include "util.h"
+
+// Each primitive runs untimed for this long before sampling starts, which also
+// tells us how many passes over the corpus fill one sample.
+#define WARMUP_NANOS (50 * 1000000LL)
+#define SAMPLE_NANOS (20 * 1000000LL)
+
+// The positions every primitive runs over, set up once before timing starts.
+typedef struct {
+	int32_t count;
+	GameState* states;
+	MoveBuffer* legalMoves; // The legal moves at each position.
+	MoveBuffer scratch;
+	ZTable table;
+} Corpus;
+
+// Runs a primitive once over every position in the corpus and returns the number of operations.
+typedef int64_t (*PassFunction)(Corpus* corpus);
+
+typedef struct {
+	const char* name;
+	PassFunction pass;
+} Primitive;
+
+// Results are accumulated here so the compiler can't discard the calls being timed.
+static volatile int64_t sink;
+
+static int64_t passGeneratePseudoMoves(Corpus* corpus) {
+	for (int32_t i = 0; i < corpus->count; i++) {
+		sink += generatePseudoMoves(&corpus->states[i], &corpus->scratch);
+	}
+
+	return corpus->count;
+}
+
+static int64_t passMakeUnmake(Corpus* corpus) {
+	int64_t ops = 0;
+	for (int32_t i = 0; i < corpus->count; i++) {
+		GameState* state = &corpus->states[i];
+		MoveBuffer* moves = &corpus->legalMoves[i];
+		for (int32_t m = 0; m < moves->length; m++) {
+			makeMove(state, &moves->moves[m]);
+			sink += state->current->halfMoveCount;
+			unmakeMove(state, &moves->moves[m]);
+		}
+
+		ops += moves->length;
+	}
+
+	return ops;
+}
+
+static int64_t passIsLegalPosition(Corpus* corpus) {
+	for (int32_t i = 0; i < corpus->count; i++) {
+		sink += isLegalPosition(&corpus->states[i]);
+	}
+
+	return corpus->count;
+}
+
+static int64_t passCanAttack(Corpus* corpus) {
+	for (int32_t i = 0; i < corpus->count; i++) {
+		GameState* state = &corpus->states[i];
+		const int32_t color = state->current->toMove;
+		for (int32_t sq = 0; sq < 64; sq++) {
+			sink += canAttack(color, BOARD_SQUARES[sq], state);
+		}
+	}
+
+	return (int64_t) corpus->count * 64;
+}
+
+static int64_t passEvaluate(Corpus* corpus) {
+	for (int32_t i = 0; i < corpus->count; i++) {
+		sink += evaluate(&corpus->states[i]);
+	}
+
+	return corpus->count;
+}
+
+static int64_t passHashPut(Corpus* corpus) {
+	for (int32_t i = 0; i < corpus->count; i++) {
+		hash_put(&corpus->states[i], i, 1, HASHF_EXACT);
+	}
+
+	return corpus->count;
+}
+
+static int64_t passHashProbe(Corpus* corpus) {
+	for (int32_t i = 0; i < corpus->count; i++) {
+		sink += hash_probe(&corpus->states[i], 1, -INFINITY, INFINITY);
+	}
+
+	return corpus->count;
+}
+
+static int64_t passIsThreefold(Corpus* corpus) {
+	for (int32_t i = 0; i < corpus->count; i++) {
+		sink += draw_isThreefold(&corpus->states[i]);
+	}
+
+	return corpus->count;
+}
+
+static int64_t passPrintShortAlg(Corpus* corpus) {
+	char buffer[16];
+	int64_t ops = 0;
+	for (int32_t i = 0; i < corpus->count; i++) {
+		GameState* state = &corpus->states[i];
+		MoveBuffer* moves = &corpus->legalMoves[i];
+		for (int32_t m = 0; m < moves->length; m++) {
+			sink += notation_printShortAlg(&moves->moves[m], state, buffer);
+		}
+
+		ops += moves->length;
+	}
+
+	return ops;
+}
+
+static const Primitive PRIMITIVES[] = {
+	{"generatePseudoMoves", passGeneratePseudoMoves},
+	{"makeMove/unmakeMove", passMakeUnmake},
+	{"isLegalPosition", passIsLegalPosition},
+	{"canAttack", passCanAttack},
+	{"evaluate", passEvaluate},
+	{"hash_put", passHashPut},
+	{"hash_probe", passHashProbe},
+	{"draw_isThreefold", passIsThreefold},
+	{"notation_printShortAlg", passPrintShortAlg},
+};
+
+static void createCorpus(Corpus* corpus) {
+	char fen[128];
+
+	corpus->count = bench_positionCount();
+	corpus->states = ALLOC((size_t) corpus->count, GameState, corpus->states, "Unable to allocate microbenchmark states.");
+	corpus->legalMoves = ALLOC((size_t) corpus->count, MoveBuffer, corpus->legalMoves,
+	                           "Unable to allocate microbenchmark moves.");
+	createMoveBuffer(&corpus->scratch);
+	hash_createZTable(&corpus->table);
+
+	for (int32_t i = 0; i < corpus->count; i++) {
+		GameState* state = &corpus->states[i];
+		snprintf(fen, sizeof(fen), "%s", bench_position(i));
+		initializeGamestate(state);
+		if (!parseFen(state, fen)) {
+			fprintf(stderr, "Benchmark position %i is invalid: %s\n", i + 1, bench_position(i));
+			exit(EXIT_FAILURE);
+		}
+
+		state->zTable = &corpus->table;
+		createMoveBuffer(&corpus->legalMoves[i]);
+		generateLegalMoves(state, &corpus->legalMoves[i]);
+	}
+}
+
+static void destroyCorpus(Corpus* corpus) {
+	for (int32_t i = 0; i < corpus->count; i++) {
+		destroyMoveBuffer(&corpus->legalMoves[i]);
+		destroyGamestate(&corpus->states[i]);
+	}
+
+	destroyMoveBuffer(&corpus->scratch);
+	hash_destroyZTable(&corpus->table);
+	free(corpus->legalMoves);
+	free(corpus->states);
+}
+
+static void runPrimitive(Corpus* corpus, const Primitive* primitive, int32_t samples, MicrobenchResult* result) {
+	int64_t opsPerPass = 0;
+	int64_t warmupPasses = 0;
+	const int64_t warmupStart = getMonotonicTimeNanos();
+	int64_t warmupElapsed;
+	do {
+		opsPerPass = primitive->pass(corpus);
+		warmupPasses++;
+		warmupElapsed = getMonotonicTimeNanos() - warmupStart;
+	} while (warmupElapsed < WARMUP_NANOS);
+
+	const int64_t passesPerSample = MAX(1, warmupPasses * SAMPLE_NANOS / MAX(1, warmupElapsed));
+	const double opsPerSample = (double) (passesPerSample * opsPerPass);
+	double sum = 0.0;
+	double sumSquares = 0.0;
+	double min = 0.0;
+
+	for (int32_t s = 0; s < samples; s++) {
+		const int64_t start = getMonotonicTimeNanos();
+		for (int64_t p = 0; p < passesPerSample; p++) {
+			primitive->pass(corpus);
+		}
+		const double nanosPerOp = (double) (getMonotonicTimeNanos() - start) / opsPerSample;
+
+		sum += nanosPerOp;
+		sumSquares += nanosPerOp * nanosPerOp;
+		min = s == 0 ? nanosPerOp : MIN(min, nanosPerOp);
+	}
+
+	const double mean = sum / samples;
+	result->name = primitive->name;
+	result->opsPerSample = passesPerSample * opsPerPass;
+	result->samples = samples;
+	result->meanNanosPerOp = mean;
+	result->minNanosPerOp = min;
+	result->varianceNanosPerOp = samples > 1 ? MAX(0.0, (sumSquares - sum * mean) / (samples - 1)) : 0.0;
+	result->opsPerSecond = mean > 0 ? 1e9 / mean : 0.0;
+}
+
+static void printUsage() {
+	fprintf(stderr, "Usage: tulip-bench [-samples N] [-only name]\n");
+	fprintf(stderr, "Primitives:\n");
+	for (size_t i = 0; i < sizeof(PRIMITIVES) / sizeof(PRIMITIVES[0]); i++) {
+		fprintf(stderr, "  %s\n", PRIMITIVES[i].name);
+	}
+}
+
+int main(int argc, char** argv) {
+	const int32_t primitiveCount = (int32_t) (sizeof(PRIMITIVES) / sizeof(PRIMITIVES[0]));
+	int32_t samples = MICROBENCH_DEFAULT_SAMPLES;
+	const char* only = NULL;
+
+	for (int32_t i = 1; i < argc; i++) {
+		if (0 == strcmp("-samples", argv[i]) && i + 1 < argc) {
+			char* end;
+			samples = (int32_t) strtol(argv[++i], &end, 10);
+			if (*end != '\0' || samples < 1) {
+				fprintf(stderr, "Samples must be a positive integer.\n");
+				exit(EXIT_FAILURE);
+			}
+		} else if (0 == strcmp("-only", argv[i]) && i + 1 < argc) {
+			only = argv[++i];
+		} else {
+			printUsage();
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	evalparams_init();
+
+	Corpus corpus;
+	createCorpus(&corpus);
+
+	MicrobenchResult results[sizeof(PRIMITIVES) / sizeof(PRIMITIVES[0])];
+	int32_t resultCount = 0;
+	for (int32_t i = 0; i < primitiveCount; i++) {
+		if (only == NULL || 0 == strcmp(only, PRIMITIVES[i].name)) {
+			runPrimitive(&corpus, &PRIMITIVES[i], samples, &results[resultCount++]);
+		}
+	}
+
+	if (resultCount == 0) {
+		fprintf(stderr, "Unknown primitive: %s\n", only);
+		printUsage();
+		exit(EXIT_FAILURE);
+	}
+
+	printMicrobenchResults(results, resultCount, corpus.count);
+
+	destroyCorpus(&corpus);
+	return EXIT_SUCCESS;
+}
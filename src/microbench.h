@@ -0,0 +1,42 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef MICROBENCH_H
+#define MICROBENCH_H
+
+#include <inttypes.h>
+
+#define MICROBENCH_DEFAULT_SAMPLES 10
+
+// Timing results for one primitive. Each sample runs the primitive over the whole position
+// corpus enough times to take a measurable amount of time; the statistics are per operation.
+typedef struct {
+	const char* name;           // The name of the primitive, e.g. "evaluate".
+	int64_t opsPerSample;       // The number of operations timed in each sample.
+	int32_t samples;            // The number of samples taken after warm-up.
+	double meanNanosPerOp;      // The mean time per operation across samples.
+	double minNanosPerOp;       // The fastest sample's time per operation.
+	double varianceNanosPerOp;  // The sample variance of the time per operation.
+	double opsPerSecond;        // Operations per second at the mean time.
+} MicrobenchResult;
+
+#endif
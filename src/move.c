@@ -72,3 +72,13 @@ const Piece* getPromotePiece(const int32_t color, const int32_t moveCode) {
         }
     }
 }
+
+// Converts an index into the 12x12 board to a 0-63 square index.
+static uint16_t squareIndex(int32_t sq) {
+    return (uint16_t) ((sq / 12 - 2) * 8 + (sq % 12 - 2));
+}
+
+uint16_t packMove(const Move* move) {
+    const uint16_t promote = (uint16_t) (IS_PROMOTE(move->moveCode) ? move->moveCode : 0);
+    return (uint16_t) (squareIndex(move->from) | (squareIndex(move->to) << 6) | (promote << 12));
+}
@@ -65,4 +65,14 @@ void createMoveBuffer(MoveBuffer*);
 void destroyMoveBuffer(MoveBuffer*);
 
 const Piece* getPromotePiece(const int32_t color, const int32_t moveCode);
+
+// A move packed into 16 bits for storage: the from and to squares as 0-63 indexes
+// (a1 = 0, h8 = 63) in the low 12 bits, and the promotion code, if any, in the top 4.
+// Use unpackMove() (movegen.h) to turn one back into a move in a given position.
+#define PACKED_MOVE_NONE 0
+#define PACKED_FROM(p) ((int32_t) ((p) & 0x3F))
+#define PACKED_TO(p) ((int32_t) (((p) >> 6) & 0x3F))
+#define PACKED_PROMOTE(p) ((int32_t) (((p) >> 12) & 0xF))
+
+uint16_t packMove(const Move* move);
 #endif
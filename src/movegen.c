@@ -251,6 +251,7 @@ static void blackKingCastle(GameState* gs, const Piece** board, Move* moveArr, i
         Move* m = &moveArr[*count];
 
         if ((castleFlags & CASTLE_BK)
+            && board[SQ_H8] == &BROOK
             && board[SQ_F8] == &EMPTY
             && board[SQ_G8] == &EMPTY
             && !canAttack(COLOR_WHITE, SQ_F8, gs)) {
@@ -260,6 +261,7 @@ static void blackKingCastle(GameState* gs, const Piece** board, Move* moveArr, i
         }
 
         if ((castleFlags & CASTLE_BQ)
+            && board[SQ_A8] == &BROOK
             && board[SQ_D8] == &EMPTY
             && board[SQ_C8] == &EMPTY
             && board[SQ_B8] == &EMPTY
@@ -274,6 +276,7 @@ static void whiteKingCastle(GameState* gs, const Piece** board, Move* moveArr, i
         Move* m = &moveArr[*count];
 
         if ((castleFlags & CASTLE_WK)
+            && board[SQ_H1] == &WROOK
             && board[SQ_F1] == &EMPTY
             && board[SQ_G1] == &EMPTY
             && !canAttack(COLOR_BLACK, SQ_F1, gs)) {
@@ -283,6 +286,7 @@ static void whiteKingCastle(GameState* gs, const Piece** board, Move* moveArr, i
         }
 
         if ((castleFlags & CASTLE_WQ)
+            && board[SQ_A1] == &WROOK
             && board[SQ_D1] == &EMPTY
             && board[SQ_C1] == &EMPTY
             && board[SQ_B1] == &EMPTY
@@ -421,6 +425,23 @@ int32_t generateLegalMoves(GameState* gameState, MoveBuffer* destination) {
         return count;
 }
 
+bool unpackMove(GameState* gameState, uint16_t packed, Move* move) {
+        MoveBuffer legalMoves;
+        createMoveBuffer(&legalMoves);
+        generateLegalMoves(gameState, &legalMoves);
+        bool found = false;
+
+        for (int32_t i = 0; i < legalMoves.length && !found; i++) {
+                if (packMove(&legalMoves.moves[i]) == packed) {
+                        *move = legalMoves.moves[i];
+                        found = true;
+                }
+        }
+
+        destroyMoveBuffer(&legalMoves);
+        return found;
+}
+
 int32_t countLegalMoves(GameState* gameState) {
         MoveBuffer pseudoMoves;
         createMoveBuffer(&pseudoMoves);
@@ -441,4 +462,25 @@ int32_t countLegalMoves(GameState* gameState) {
         return count;
 }
 
+int64_t perft(GameState* gameState, MoveBuffer* buffers, int32_t depth) {
+        if (depth == 0) {
+                return 1;
+        }
+
+        MoveBuffer* buffer = &buffers[depth - 1];
+        generatePseudoMoves(gameState, buffer);
+        int64_t nodes = 0;
+
+        for (int32_t i = 0; i < buffer->length; i++) {
+                Move* m = &buffer->moves[i];
+                makeMove(gameState, m);
+                if (isLegalPosition(gameState)) {
+                        nodes += perft(gameState, buffers, depth - 1);
+                }
+                unmakeMove(gameState, m);
+        }
+
+        return nodes;
+}
+
 #undef PUSH_MOVE
@@ -39,7 +39,15 @@ int32_t generatePseudoMoves(GameState* gameState, MoveBuffer* destination);
 // substantial runtime cost.
 int32_t generateLegalMoves(GameState* gameState, MoveBuffer* destination);
 
+// Finds the legal move in the given position matching a packed move (see packMove()).
+// Returns false if there is no such move.
+bool unpackMove(GameState* gameState, uint16_t packed, Move* move);
+
 // Counts the number of legal moves.
 int32_t countLegalMoves(GameState* gameState);
 
+// Counts the leaf nodes of the legal move tree to the given depth. The buffers array
+// must hold at least depth move buffers; each ply uses its own buffer.
+int64_t perft(GameState* gameState, MoveBuffer* buffers, int32_t depth);
+
 #endif
@@ -45,22 +45,44 @@ static bool doMoveCollide(Move* legalMove, Move* candidate) {
                && legalMove->to == candidate->to;
 }
 
+static bool isLegalMove(GameState* g, Move* move) {
+        makeMove(g, move);
+        const bool legal = isLegalPosition(g);
+        unmakeMove(g, move);
+        return legal;
+}
+
+// Stops at the first legal move, rather than counting them all.
+static bool hasLegalMove(GameState* g) {
+        MoveBuffer pseudoMoves;
+        bool result = false;
+
+        createMoveBuffer(&pseudoMoves);
+        generatePseudoMoves(g, &pseudoMoves);
+
+        for (int32_t i = 0; i < pseudoMoves.length && !result; i++) {
+                result = isLegalMove(g, &pseudoMoves.moves[i]);
+        }
+
+        destroyMoveBuffer(&pseudoMoves);
+        return result;
+}
+
 static int32_t notation_printMoveDisambiguation(GameState* g, Move* move, char* buffer) {
         int32_t c = 0;
-        MoveBuffer legalMoves;
-        int32_t* collidingMoves;
+        MoveBuffer pseudoMoves;
+        int32_t collidingMoves[MOVE_BUFFER_LENGTH];
         int32_t collidingMoveCnt = 0;
 
-        createMoveBuffer(&legalMoves);
-        generateLegalMoves(g, &legalMoves);
-
-        collidingMoves = ALLOC((uint64_t) legalMoves.length, int32_t, collidingMoves, "Unable to allocate ambiguous move buffer.");
+        createMoveBuffer(&pseudoMoves);
+        generatePseudoMoves(g, &pseudoMoves);
 
         // Look for moves where both the moving piece and destination square are the same.
         // See http://en.wikipedia.org/wiki/Algebraic_notation_(chess)#Disambiguating_moves for rules.
-        for (int32_t i = 0; i < legalMoves.length; i++) {
-                Move* candidate = &legalMoves.moves[i];
-                if (doMoveCollide(move, candidate)) {
+        // Only the (rare) colliding moves need their legality checked.
+        for (int32_t i = 0; i < pseudoMoves.length; i++) {
+                Move* candidate = &pseudoMoves.moves[i];
+                if (doMoveCollide(move, candidate) && isLegalMove(g, candidate)) {
                         collidingMoves[collidingMoveCnt++] = candidate->from;
                 }
         }
@@ -91,31 +113,34 @@ static int32_t notation_printMoveDisambiguation(GameState* g, Move* move, char*
                 }
         }
 
-        free(collidingMoves);
-        destroyMoveBuffer(&legalMoves);
+        destroyMoveBuffer(&pseudoMoves);
 
         return c;
 }
 
-int32_t notation_printShortAlg(Move* move, GameState* gameState, char* buffer) {
+// Prints a move in short algebraic notation, without the check/mate suffix.
+static int32_t printShortAlgBody(Move* move, GameState* gameState, char* buffer) {
         int32_t count = 0;
         const Piece* movingPiece = move->movingPiece;
         bool isPawn = movingPiece == &WPAWN || movingPiece == &BPAWN;
+        bool isKing = movingPiece == &WKING || movingPiece == &BKING;
 
-        if (movingPiece == &WKING || movingPiece == &BKING) {
+        if (isKing) {
                 int moveOffset = move->from - move->to;
                 if (moveOffset == 2) {
-                        count = sprintf(buffer, "O-O-O");
-                        goto add_check;
+                        return sprintf(buffer, "O-O-O");
                 } else if (moveOffset == -2) {
-                        count = sprintf(buffer, "O-O");
-                        goto add_check;
+                        return sprintf(buffer, "O-O");
                 }
         }
 
         if (!isPawn) {
                 buffer[count++] = (char) toupper(movingPiece->name);
-                count += notation_printMoveDisambiguation(gameState, move, &buffer[count]);
+
+                // There's only ever one king.
+                if (!isKing) {
+                        count += notation_printMoveDisambiguation(gameState, move, &buffer[count]);
+                }
         }
 
         if (move->captures != &EMPTY) {
@@ -133,11 +158,17 @@ int32_t notation_printShortAlg(Move* move, GameState* gameState, char* buffer) {
                 buffer[count++] = (char) toupper(getPromotePiece(movingPiece->color, move->moveCode)->name);
         }
 
-add_check:
+        buffer[count] = '\0';
+        return count;
+}
+
+int32_t notation_printShortAlg(Move* move, GameState* gameState, char* buffer) {
+        int32_t count = printShortAlgBody(move, gameState, buffer);
 
+        // Mate is only looked for once we know the move checks.
         makeMove(gameState, move);
         if (isCheck(gameState)) {
-                buffer[count++] = countLegalMoves(gameState) == 0 ? '#' : '+';
+                buffer[count++] = hasLegalMove(gameState) ? '+' : '#';
         }
 
         unmakeMove(gameState, move);
@@ -193,6 +224,156 @@ static bool checkMoveMatch(char* normalizedGeneratedMove, char* normalizedInputM
         return result;
 }
 
+// Copies the letters and digits of a move string that matter for parsing it, dropping
+// capture marks, check/mate and annotation marks, promotion '=' and "e.p." suffixes.
+// Returns the length of the result, or -1 if it doesn't fit.
+static int32_t stripMove(const char* str, char* stripped, int32_t size) {
+        int32_t length = 0;
+        for (const char* c = str; *c; c++) {
+                if (isalnum((unsigned char) *c) && *c != 'x') {
+                        if (length == size - 1) {
+                                return -1;
+                        }
+
+                        stripped[length++] = *c;
+                }
+        }
+
+        stripped[length] = '\0';
+
+        if (length >= 4 && strcmp(&stripped[length - 2], "ep") == 0 && isdigit((unsigned char) stripped[length - 3])) {
+                length -= 2;
+                stripped[length] = '\0';
+        }
+
+        return length;
+}
+
+static int32_t promoteCode(char c) {
+        switch (tolower(c)) {
+        case 'q': return PROMOTE_Q;
+        case 'r': return PROMOTE_R;
+        case 'b': return PROMOTE_B;
+        case 'n': return PROMOTE_N;
+        default: return NO_MOVE_CODE;
+        }
+}
+
+// Resolves a parsed move against the pseudo-legal moves that fit it.
+// A pieceName of 0 matches any piece; a file or rank of -1 matches any file or rank.
+static bool resolveMove(GameState* gs, char pieceName, int32_t fromFile, int32_t fromRank, int32_t to, int32_t moveCode, Move* m) {
+        MoveBuffer pseudoMoves;
+        int32_t matches = 0;
+
+        createMoveBuffer(&pseudoMoves);
+        generatePseudoMoves(gs, &pseudoMoves);
+
+        for (int32_t i = 0; i < pseudoMoves.length && matches < 2; i++) {
+                Move* candidate = &pseudoMoves.moves[i];
+                const bool promotes = IS_PROMOTE(candidate->moveCode);
+
+                if (candidate->to != to
+                        || (pieceName != 0 && toupper(candidate->movingPiece->name) != pieceName)
+                        || (fromFile >= 0 && FILE_IDX(candidate->from) != fromFile)
+                        || (fromRank >= 0 && RANK_IDX(candidate->from) != fromRank)
+                        || (promotes ? candidate->moveCode != moveCode : moveCode != NO_MOVE_CODE)) {
+                        continue;
+                }
+
+                if (isLegalMove(gs, candidate)) {
+                        *m = *candidate;
+                        matches++;
+                }
+        }
+
+        destroyMoveBuffer(&pseudoMoves);
+        return matches == 1;
+}
+
+static bool parseCastle(GameState* gs, int32_t offset, Move* m) {
+        MoveBuffer pseudoMoves;
+        bool result = false;
+
+        createMoveBuffer(&pseudoMoves);
+        generatePseudoMoves(gs, &pseudoMoves);
+
+        for (int32_t i = 0; i < pseudoMoves.length && !result; i++) {
+                Move* candidate = &pseudoMoves.moves[i];
+                if ((candidate->movingPiece == &WKING || candidate->movingPiece == &BKING)
+                        && candidate->to - candidate->from == offset
+                        && isLegalMove(gs, candidate)) {
+                        *m = *candidate;
+                        result = true;
+                }
+        }
+
+        destroyMoveBuffer(&pseudoMoves);
+        return result;
+}
+
+bool notation_parseMove(const char* str, GameState* gs, Move* m) {
+        char s[16];
+        int32_t length = stripMove(str, s, (int32_t) sizeof(s));
+        if (length < 2) {
+                return false;
+        }
+
+        if (strcmp(s, "OO") == 0 || strcmp(s, "00") == 0) {
+                return parseCastle(gs, 2, m);
+        } else if (strcmp(s, "OOO") == 0 || strcmp(s, "000") == 0) {
+                return parseCastle(gs, -2, m);
+        }
+
+        // Pieces are upper case; a lower case 'b' is a file.
+        char pieceName = 0;
+        const char* p = s;
+        if (strchr("NBRQK", *p) != NULL) {
+                pieceName = *p++;
+                length--;
+        }
+
+        int32_t moveCode = NO_MOVE_CODE;
+        if (length >= 3 && isalpha((unsigned char) p[length - 1]) && isdigit((unsigned char) p[length - 2])) {
+                moveCode = promoteCode(p[length - 1]);
+                if (moveCode == NO_MOVE_CODE) {
+                        return false;
+                }
+
+                length--;
+        }
+
+        // What's left is an optional from file and/or rank, and the target square.
+        if (length < 2 || length > 4) {
+                return false;
+        }
+
+        const int32_t toFile = parseFileChar(p[length - 2]);
+        const int32_t toRank = parseRankChar(p[length - 1]);
+        if (toFile == INVALID_FILE || toRank == INVALID_RANK) {
+                return false;
+        }
+
+        int32_t fromFile = -1;
+        int32_t fromRank = -1;
+        for (int32_t i = 0; i < length - 2; i++) {
+                if (fromFile < 0 && fromRank < 0 && islower((unsigned char) p[i]) && parseFileChar(p[i]) != INVALID_FILE) {
+                        fromFile = parseFileChar(p[i]);
+                } else if (fromRank < 0 && parseRankChar(p[i]) != INVALID_RANK) {
+                        fromRank = parseRankChar(p[i]);
+                } else {
+                        return false;
+                }
+        }
+
+        // Without a piece letter, a full from square is coordinate notation (any piece);
+        // otherwise it's a pawn move.
+        if (pieceName == 0 && !(fromFile >= 0 && fromRank >= 0)) {
+                pieceName = 'P';
+        }
+
+        return resolveMove(gs, pieceName, fromFile, fromRank, B_IDX(toFile, toRank), moveCode, m);
+}
+
 bool notation_matchMove(char* str, GameState* gs, Move* m) {
         MoveBuffer buffer;
         char moveStr[16];
@@ -200,6 +381,10 @@ bool notation_matchMove(char* str, GameState* gs, Move* m) {
         char normalizedInputMove[16];
         bool result = false;
 
+        if (notation_parseMove(str, gs, m)) {
+                return true;
+        }
+
         createMoveBuffer(&buffer);
         generateLegalMoves(gs, &buffer);
 
@@ -208,8 +393,9 @@ bool notation_matchMove(char* str, GameState* gs, Move* m) {
         for (int32_t i = 0; i < buffer.length; i++) {
                 Move currentMove = buffer.moves[i];
 
-                // Fist match with algebraic notation
-                notation_printShortAlg(&currentMove, gs, moveStr);
+                // Fist match with algebraic notation. Normalizing drops any check or mate
+                // suffix, so there's no need to work it out.
+                printShortAlgBody(&currentMove, gs, moveStr);
                 normalizeMove(moveStr, normalizedMove);
                 result = checkMoveMatch(normalizedMove, normalizedInputMove, currentMove, m);
                 if (result) {
@@ -34,8 +34,14 @@
 // Returns the number of characters printed, not including the null char.
 int32_t notation_printShortAlg(Move* move, GameState* gameState, char* buffer);
 
+// Parses a move in short algebraic (e.g. Nbd7, exd6, e8=Q+, O-O) or coordinate
+// (e.g. e7e8q) notation directly, checking only the moves that fit it rather than
+// printing every legal move. Returns false unless exactly one legal move fits.
+bool notation_parseMove(const char* str, GameState* gs, Move* move);
+
 // Matches a human-input string against legal moves.
-// This method isn't terribly fast, but it uses "fuzzy" matching logic.
+// Strings that notation_parseMove() reads are matched quickly; otherwise
+// this method isn't terribly fast, but it uses "fuzzy" matching logic.
 // It will match with both coordinate notation (e.g. e2e4) and short
 // algebraic notation (e.g. Ne6, Qd7#), accounting for differences in
 // "decoration" (e.g. '++' instead of '#' for checkmate).
@@ -0,0 +1,299 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#define _POSIX_C_SOURCE 200112L // For mmap() and friends with -std=c99
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "tulip.h"
+#include "packedpos.h"
+#include "board.h"
+#include "epd.h"
+#include "fen.h"
+#include "piece.h"
+#include "statedata.h"
+#include "util.h"
+
+#define PACKED_LINE_LEN 512
+#define PACKED_FEN_LEN 128
+
+bool packPosition(GameState* state, uint8_t* packed) {
+	uint64_t occupancy = 0;
+	int32_t pieces = 0;
+
+	memset(packed, 0, PACKED_POSITION_SIZE);
+
+	for (int32_t i = 0; i < 64; i++) {
+		const Piece* piece = state->board[BOARD_SQUARES[i]];
+		if (piece == &EMPTY) {
+			continue;
+		}
+
+		if (pieces == PACKED_MAX_PIECES) {
+			return false;
+		}
+
+		occupancy |= 1ULL << i;
+		packed[8 + pieces / 2] |= (uint8_t) (piece->ordinal << (4 * (pieces % 2)));
+		pieces++;
+	}
+
+	const StateData* current = state->current;
+	writeLE64(packed, occupancy);
+	packed[24] = (uint8_t) ((current->toMove == COLOR_BLACK ? 1 : 0) | (current->castleFlags << 1));
+	packed[25] = (uint8_t) current->epFile;
+	packed[26] = (uint8_t) MIN(current->fiftyMoveCount, 255);
+	return true;
+}
+
+bool unpackPosition(GameState* state, const uint8_t* packed) {
+	const uint64_t occupancy = readLE64(packed);
+	int32_t* pCounts = state->pieceCounts;
+	int32_t sqwk = 0;
+	int32_t sqbk = 0;
+	int32_t pieces = 0;
+
+	state->current = &state->dataStack[0];
+	memset(pCounts, 0, sizeof(int32_t) * (ORD_MAX + 1));
+
+	for (int32_t i = 0; i < 64; i++) {
+		const int32_t sq = BOARD_SQUARES[i];
+		if (!(occupancy & (1ULL << i))) {
+			state->board[sq] = &EMPTY;
+			pCounts[ORD_EMPTY]++;
+			continue;
+		}
+
+		if (pieces == PACKED_MAX_PIECES) {
+			return false;
+		}
+
+		const int32_t ordinal = (packed[8 + pieces / 2] >> (4 * (pieces % 2))) & 0xF;
+		pieces++;
+		if (ordinal > ORD_BKING) {
+			return false;
+		}
+
+		if (ordinal == ORD_WKING) {
+			sqwk = sq;
+		} else if (ordinal == ORD_BKING) {
+			sqbk = sq;
+		}
+
+		state->board[sq] = ALL_PIECES[ordinal];
+		pCounts[ordinal]++;
+	}
+
+	const int32_t epFile = packed[25];
+	if (pCounts[ORD_WKING] != 1 || pCounts[ORD_BKING] != 1 || epFile > NO_EP_FILE) {
+		return false;
+	}
+
+	StateData* current = state->current;
+	current->whiteKingSquare = sqwk;
+	current->blackKingSquare = sqbk;
+	current->whitePieceCount = pCounts[ORD_WPAWN] + pCounts[ORD_WKNIGHT] + pCounts[ORD_WBISHOP]
+	                           + pCounts[ORD_WROOK] + pCounts[ORD_WQUEEN] + pCounts[ORD_WKING];
+	current->blackPieceCount = pCounts[ORD_BPAWN] + pCounts[ORD_BKNIGHT] + pCounts[ORD_BBISHOP]
+	                           + pCounts[ORD_BROOK] + pCounts[ORD_BQUEEN] + pCounts[ORD_BKING];
+
+	const int32_t toMove = (packed[24] & 1) ? COLOR_BLACK : COLOR_WHITE;
+	completePosition(state, toMove, (packed[24] >> 1) & 0xF, epFile, packed[26]);
+	return true;
+}
+
+void packedpos_setLabels(uint8_t* packed, int32_t score, int32_t result) {
+	writeLE16(packed + 27, (uint16_t) (int16_t) MIN(MAX(score, INT16_MIN), INT16_MAX));
+	packed[29] = (uint8_t) result;
+}
+
+int32_t packedpos_score(const uint8_t* packed) {
+	return (int16_t) readLE16(packed + 27);
+}
+
+int32_t packedpos_result(const uint8_t* packed) {
+	return packed[29];
+}
+
+bool packedpos_isPackedFile(const char* fileName) {
+	char magic[PACKED_FILE_HEADER_SIZE];
+	FILE* fp = fopen(fileName, "rb");
+	if (!fp) {
+		return false;
+	}
+
+	const bool result = fread(magic, 1, sizeof(magic), fp) == sizeof(magic)
+	                    && memcmp(magic, PACKED_FILE_MAGIC, PACKED_FILE_HEADER_SIZE) == 0;
+	fclose(fp);
+	return result;
+}
+
+bool packedpos_open(const char* fileName, PackedFile* file) {
+	const int fd = open(fileName, O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size < PACKED_FILE_HEADER_SIZE) {
+		close(fd);
+		return false;
+	}
+
+	const size_t size = (size_t) st.st_size;
+	void* mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (mapping == MAP_FAILED) {
+		return false;
+	}
+
+	if (memcmp(mapping, PACKED_FILE_MAGIC, PACKED_FILE_HEADER_SIZE) != 0
+	        || (size - PACKED_FILE_HEADER_SIZE) % PACKED_POSITION_SIZE != 0) {
+		fprintf(stderr, "[%s] isn't a packed position file, or is truncated.\n", fileName);
+		munmap(mapping, size);
+		return false;
+	}
+
+	file->mapping = mapping;
+	file->mappingSize = size;
+	file->positions = (const uint8_t*) mapping + PACKED_FILE_HEADER_SIZE;
+	file->count = (size - PACKED_FILE_HEADER_SIZE) / PACKED_POSITION_SIZE;
+	return true;
+}
+
+void packedpos_close(PackedFile* file) {
+	if (file->mapping != NULL) {
+		munmap(file->mapping, file->mappingSize);
+		file->mapping = NULL;
+		file->positions = NULL;
+		file->count = 0;
+	}
+}
+
+bool packedpos_fromFen(const char* fenFile, const char* packedFile, PackedFileStats* stats) {
+	char line[PACKED_LINE_LEN];
+	char fen[PACKED_LINE_LEN];
+	uint8_t packed[PACKED_POSITION_SIZE];
+
+	FILE* in = fopen(fenFile, "r");
+	if (!in) {
+		perror("Unable to open FEN file");
+		return false;
+	}
+
+	FILE* out = fopen(packedFile, "wb");
+	if (!out) {
+		perror("Unable to open packed position file for writing");
+		fclose(in);
+		return false;
+	}
+
+	const int64_t start = getCurrentTimeMillis();
+	memset(stats, 0, sizeof(PackedFileStats));
+
+	GameState state;
+	initializeGamestate(&state);
+
+	bool ok = fwrite(PACKED_FILE_MAGIC, 1, PACKED_FILE_HEADER_SIZE, out) == PACKED_FILE_HEADER_SIZE;
+	while (ok && fgets(line, sizeof(line), in)) {
+		const char* p = line;
+		while (*p == ' ' || *p == '\t') {
+			p++;
+		}
+
+		if (*p == '\0' || *p == '\n' || *p == '\r' || *p == '#') {
+			continue;
+		}
+
+		if (!epd_toFen(line, fen, sizeof(fen)) || !parseFenWithPrint(&state, fen, false) || !packPosition(&state, packed)) {
+			stats->errors++;
+			continue;
+		}
+
+		ok = fwrite(packed, 1, PACKED_POSITION_SIZE, out) == PACKED_POSITION_SIZE;
+		stats->positions++;
+	}
+
+	ok = !ferror(in) && ok;
+	stats->bytes = ftell(out);
+	ok = fclose(out) == 0 && ok;
+	fclose(in);
+	if (!ok) {
+		fprintf(stderr, "Error converting [%s] to packed positions.\n", fenFile);
+	}
+
+	destroyGamestate(&state);
+	stats->elapsedMillis = getCurrentTimeMillis() - start;
+	return ok;
+}
+
+bool packedpos_toFen(const char* packedFile, const char* fenFile, PackedFileStats* stats) {
+	char fen[PACKED_FEN_LEN];
+	PackedFile file;
+
+	if (!packedpos_open(packedFile, &file)) {
+		fprintf(stderr, "Unable to open packed position file [%s]\n", packedFile);
+		return false;
+	}
+
+	FILE* out = fopen(fenFile, "w");
+	if (!out) {
+		perror("Unable to open FEN file for writing");
+		packedpos_close(&file);
+		return false;
+	}
+
+	const int64_t start = getCurrentTimeMillis();
+	memset(stats, 0, sizeof(PackedFileStats));
+
+	GameState state;
+	initializeGamestate(&state);
+
+	bool ok = true;
+	for (uint64_t i = 0; i < file.count && ok; i++) {
+		if (!unpackPosition(&state, file.positions + i * PACKED_POSITION_SIZE)) {
+			stats->errors++;
+			continue;
+		}
+
+		printFen(&state, fen, (int32_t) sizeof(fen));
+		ok = fprintf(out, "%s\n", fen) > 0;
+		stats->positions++;
+	}
+
+	stats->bytes = ftell(out);
+	ok = fclose(out) == 0 && ok;
+	if (!ok) {
+		fprintf(stderr, "Error writing FEN file [%s]\n", fenFile);
+	}
+
+	destroyGamestate(&state);
+	packedpos_close(&file);
+	stats->elapsedMillis = getCurrentTimeMillis() - start;
+	return ok;
+}
@@ -0,0 +1,102 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef PACKEDPOS_H
+#define PACKEDPOS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <inttypes.h>
+
+#include "gamestate.h"
+
+// A packed position is 32 bytes:
+//   bytes 0-7    a little-endian occupancy bitboard, bit 0 for a1 through bit 63 for h8;
+//   bytes 8-23   a 4-bit piece ordinal (ORD_WPAWN to ORD_BKING) for each occupied square
+//                in bit order, low nibble first; at most 32 pieces fit;
+//   byte 24      bit 0 set if black is to move, bits 1-4 the castle flags (CASTLE_*);
+//   byte 25      the en passant file, or NO_EP_FILE;
+//   byte 26      the fifty move count, saturated at 255;
+//   bytes 27-28  a little-endian signed score label in centipawns, from white's point of view;
+//   byte 29      a game result label (PACKED_RESULT_*);
+//   bytes 30-31  reserved, zero.
+// Positions packed from FEN carry no labels: a zero score and PACKED_RESULT_NONE.
+// The full move number isn't kept. A packed position file is the 8 byte magic
+// "TULPPOSN" followed by packed positions, so it can be mapped and indexed directly.
+#define PACKED_POSITION_SIZE 32
+#define PACKED_FILE_MAGIC "TULPPOSN"
+#define PACKED_FILE_HEADER_SIZE 8
+#define PACKED_MAX_PIECES 32
+
+// Result labels, ordered so that (result - 1) / 2 is white's game score.
+#define PACKED_RESULT_NONE          0
+#define PACKED_RESULT_BLACK_WINS    1
+#define PACKED_RESULT_DRAW          2
+#define PACKED_RESULT_WHITE_WINS    3
+
+// A mapped packed position file.
+typedef struct {
+	const uint8_t* positions;
+	uint64_t count;
+	void* mapping;
+	size_t mappingSize;
+} PackedFile;
+
+// Totals for a conversion between FEN and packed positions.
+typedef struct {
+	int64_t positions;          // Positions written.
+	int64_t errors;             // Positions skipped: unreadable, or with too many pieces to pack.
+	int64_t bytes;              // Size of the output file.
+	int64_t elapsedMillis;
+} PackedFileStats;
+
+// Packs a position. Returns false if it has more than PACKED_MAX_PIECES pieces.
+bool packPosition(GameState* state, uint8_t* packed);
+
+// Sets up a state from a packed position. Returns false if the packed position is invalid.
+bool unpackPosition(GameState* state, const uint8_t* packed);
+
+// Sets the labels of a packed position. The score is clamped to 16 bits.
+void packedpos_setLabels(uint8_t* packed, int32_t score, int32_t result);
+
+// The score label of a packed position.
+int32_t packedpos_score(const uint8_t* packed);
+
+// The result label of a packed position.
+int32_t packedpos_result(const uint8_t* packed);
+
+// Returns true if the file starts with the packed position file magic.
+bool packedpos_isPackedFile(const char* fileName);
+
+// Maps a packed position file. Returns false if it can't be read or isn't one.
+bool packedpos_open(const char* fileName, PackedFile* file);
+
+// Unmaps a packed position file.
+void packedpos_close(PackedFile* file);
+
+// Converts a file of FEN or EPD positions, one per line, to packed positions.
+bool packedpos_fromFen(const char* fenFile, const char* packedFile, PackedFileStats* stats);
+
+// Converts a packed position file to FEN, one position per line.
+bool packedpos_toFen(const char* packedFile, const char* fenFile, PackedFileStats* stats);
+
+#endif
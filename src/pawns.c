@@ -0,0 +1,193 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "tulip.h"
+#include "board.h"
+#include "bitboard.h"
+#include "evalparams.h"
+#include "gamestate.h"
+#include "pawns.h"
+
+// Squares attacked by the given pawns.
+static inline uint64_t wPawnAttacks(const uint64_t wPawns) {
+	return ((wPawns << 9) & ~BIT_FILE_A) | ((wPawns << 7) & ~BIT_FILE_H);
+}
+
+static inline uint64_t bPawnAttacks(const uint64_t bPawns) {
+	return ((bPawns >> 7) & ~BIT_FILE_A) | ((bPawns >> 9) & ~BIT_FILE_H);
+}
+
+// Squares an enemy pawn can be stopped or captured on: everything in front of
+// the given pawns on their own and adjacent files.
+static inline uint64_t wPawnFrontSpans(const uint64_t wPawns) {
+	const uint64_t front = fillNorth(wPawns << 8, ~(uint64_t) 0);
+	return front | ((front << 1) & ~BIT_FILE_A) | ((front >> 1) & ~BIT_FILE_H);
+}
+
+static inline uint64_t bPawnFrontSpans(const uint64_t bPawns) {
+	const uint64_t front = fillSouth(bPawns >> 8, ~(uint64_t) 0);
+	return front | ((front << 1) & ~BIT_FILE_A) | ((front >> 1) & ~BIT_FILE_H);
+}
+
+// The files either side of any file containing one of the given pawns.
+static inline uint64_t adjacentFiles(const uint64_t pawns) {
+	const uint64_t files = fillNorth(fillSouth(pawns, ~(uint64_t) 0), ~(uint64_t) 0);
+	return ((files << 1) & ~BIT_FILE_A) | ((files >> 1) & ~BIT_FILE_H);
+}
+
+// A candidate passer has no enemy pawn in front of it on its own file, and at
+// least as many friendly pawns able to support its advance on the adjacent files
+// as there are enemy pawns in front of it on those files.
+static int32_t wCandidatePassers(uint64_t open, const uint64_t wPawns, const uint64_t bPawns) {
+	int32_t count = 0;
+	while (open) {
+		const int32_t sq = BOARD_SQUARES[lowestBitIndex(open)];
+		const uint64_t sideFiles = ~BITS_FILES[FILE_IDX(sq)];
+		const int32_t sentries = countBits(BITS_PASSED_PAWN_W[sq] & bPawns);
+		const int32_t helpers = countBits(BITS_PASSED_PAWN_B[sq + OFFSET_N] & sideFiles & wPawns);
+		if (helpers >= sentries) {
+			count++;
+		}
+		open &= open - 1;
+	}
+	return count;
+}
+
+static int32_t bCandidatePassers(uint64_t open, const uint64_t wPawns, const uint64_t bPawns) {
+	int32_t count = 0;
+	while (open) {
+		const int32_t sq = BOARD_SQUARES[lowestBitIndex(open)];
+		const uint64_t sideFiles = ~BITS_FILES[FILE_IDX(sq)];
+		const int32_t sentries = countBits(BITS_PASSED_PAWN_B[sq] & wPawns);
+		const int32_t helpers = countBits(BITS_PASSED_PAWN_W[sq + OFFSET_S] & sideFiles & bPawns);
+		if (helpers >= sentries) {
+			count++;
+		}
+		open &= open - 1;
+	}
+	return count;
+}
+
+void pawns_countTerms(uint64_t wPawns, uint64_t bPawns, PawnTerms* t) {
+	const uint64_t wAttacks = wPawnAttacks(wPawns);
+	const uint64_t bAttacks = bPawnAttacks(bPawns);
+	const uint64_t wSpans = wPawnFrontSpans(wPawns);
+	const uint64_t bSpans = bPawnFrontSpans(bPawns);
+
+	// Doubled pawns have a friendly pawn directly in front; chained pawns are defended by one.
+	t->doubled = countBits(wPawns & (wPawns >> 8)) - countBits(bPawns & (bPawns << 8));
+	t->chained = countBits(wPawns & wAttacks) - countBits(bPawns & bAttacks);
+
+	// A pawn is passed if no enemy pawn's front span covers it.
+	const uint64_t wPassed = wPawns & ~bSpans;
+	const uint64_t bPassed = bPawns & ~wSpans;
+	t->passed = countBits(wPassed) - countBits(bPassed);
+
+	const uint64_t wIsolated = wPawns & ~adjacentFiles(wPawns);
+	const uint64_t bIsolated = bPawns & ~adjacentFiles(bPawns);
+	t->isolated = countBits(wIsolated) - countBits(bIsolated);
+
+	// A backward pawn's advance square is covered by an enemy pawn, and no friendly
+	// pawn on an adjacent file can ever come up to defend it.
+	const uint64_t wBackward = wPawns & ~wIsolated & ((bAttacks & ~fillNorth(wAttacks, ~(uint64_t) 0)) >> 8);
+	const uint64_t bBackward = bPawns & ~bIsolated & ((wAttacks & ~fillSouth(bAttacks, ~(uint64_t) 0)) << 8);
+	t->backward = countBits(wBackward) - countBits(bBackward);
+
+	const uint64_t wOpen = wPawns & ~wPassed & ~fillSouth(bPawns >> 8, ~(uint64_t) 0);
+	const uint64_t bOpen = bPawns & ~bPassed & ~fillNorth(wPawns << 8, ~(uint64_t) 0);
+	t->candidates = wCandidatePassers(wOpen, wPawns, bPawns) - bCandidatePassers(bOpen, wPawns, bPawns);
+
+	t->wPassed = wPassed;
+	t->bPassed = bPassed;
+	t->wAttacks = wAttacks;
+	t->bAttacks = bAttacks;
+}
+
+void pawns_evaluate(uint64_t wPawns, uint64_t bPawns, PawnEntry* e) {
+	const EvalParams* params = EVAL_PARAMS;
+	PawnTerms t;
+	pawns_countTerms(wPawns, bPawns, &t);
+
+	e->mgScore = params->doubledPawn * t.doubled
+	             + params->pawnChain * t.chained
+	             + params->isolatedPawnMg * t.isolated
+	             + params->backwardPawnMg * t.backward
+	             + params->candidatePasserMg * t.candidates;
+
+	e->egScore = params->passedPawn * t.passed
+	             + params->isolatedPawnEg * t.isolated
+	             + params->backwardPawnEg * t.backward
+	             + params->candidatePasserEg * t.candidates;
+
+	e->wPassed = t.wPassed;
+	e->bPassed = t.bPassed;
+	e->wAttacks = t.wAttacks;
+	e->bAttacks = t.bAttacks;
+}
+
+// Commands that never evaluate a position shouldn't pay for the table, so it's
+// allocated by the first probe.
+static void allocateTable(PawnTable* table) {
+	table->data = calloc(PAWN_TABLE_SIZE, sizeof(PawnEntry));
+	if (!table->data) {
+		perror("Unable to allocate pawn table.");
+		exit(-1);
+	}
+}
+
+const PawnEntry* pawns_probe(GameState* state) {
+	const uint64_t key = state->current->pawnHash;
+	if (!state->pawnTable.data) {
+		allocateTable(&state->pawnTable);
+	}
+
+	PawnEntry* e = &state->pawnTable.data[key & (PAWN_TABLE_SIZE - 1)];
+
+	// An unused (zeroed) slot has a key of zero, which is also the key of a position
+	// with no pawns. That's fine: the zeroed entry is the correct result for it.
+	if (e->key != key) {
+		pawns_evaluate(state->bitboards[ORD_WPAWN], state->bitboards[ORD_BPAWN], e);
+		e->key = key;
+	}
+
+	return e;
+}
+
+void pawns_createTable(PawnTable* table) {
+	table->data = NULL;
+}
+
+void pawns_clearTable(PawnTable* table) {
+	if (table->data) {
+		memset(table->data, 0, PAWN_TABLE_SIZE * sizeof(PawnEntry));
+	}
+}
+
+void pawns_destroyTable(PawnTable* table) {
+	free(table->data);
+	table->data = NULL;
+}
@@ -0,0 +1,64 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef PAWNS_H
+#define PAWNS_H
+
+#include "pawntable.h"
+#include "gamestate.h"
+
+// The pawn structure features of a position, each counted white minus black,
+// along with the bitboards a PawnEntry keeps.
+typedef struct {
+	int32_t doubled;
+	int32_t chained;
+	int32_t passed;
+	int32_t isolated;
+	int32_t backward;
+	int32_t candidates;         // Candidate passed pawns.
+	uint64_t wPassed;
+	uint64_t bPassed;
+	uint64_t wAttacks;
+	uint64_t bAttacks;
+} PawnTerms;
+
+// Look up the pawn structure evaluation for the current position, computing
+// and storing it first if it isn't in the table.
+const PawnEntry* pawns_probe(GameState* state);
+
+// Evaluate the pawn structure of the given pawn bitboards from scratch,
+// bypassing the table.
+void pawns_evaluate(uint64_t wPawns, uint64_t bPawns, PawnEntry* entry);
+
+// Counts the pawn structure features that pawns_evaluate() scores.
+void pawns_countTerms(uint64_t wPawns, uint64_t bPawns, PawnTerms* terms);
+
+// Creates an empty pawn table. Its storage is allocated by the first probe.
+void pawns_createTable(PawnTable* table);
+
+// Empties the table, such as after the evaluation weights change.
+void pawns_clearTable(PawnTable* table);
+
+// Clean up a pawn table.
+void pawns_destroyTable(PawnTable* table);
+
+#endif
@@ -0,0 +1,46 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef PAWNTABLE_H
+#define PAWNTABLE_H
+
+#include <inttypes.h>
+
+#define PAWN_TABLE_SIZE (16 * 1024)
+
+// Cached pawn structure evaluation for one arrangement of pawns.
+// Scores are white-relative, like the rest of the evaluation.
+typedef struct {
+	uint64_t key;           // The pawn hash this entry was computed for.
+	uint64_t wPassed;       // White passed pawns.
+	uint64_t bPassed;       // Black passed pawns.
+	uint64_t wAttacks;      // Squares attacked by white pawns.
+	uint64_t bAttacks;      // Squares attacked by black pawns.
+	int32_t mgScore;        // Middlegame pawn structure score.
+	int32_t egScore;        // Endgame pawn structure score.
+} PawnEntry;
+
+typedef struct {
+	PawnEntry* data;
+} PawnTable;
+
+#endif
@@ -0,0 +1,301 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#define _POSIX_C_SOURCE 200112L // For mmap() and friends with -std=c99
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "pgn.h"
+
+bool pgn_mapFile(const char* fileName, PgnFile* file) {
+	const int fd = open(fileName, O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		close(fd);
+		return false;
+	}
+
+	file->length = (size_t) st.st_size;
+	file->mapping = NULL;
+	file->data = "";
+	if (file->length > 0) {
+		file->mapping = mmap(NULL, file->length, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (file->mapping == MAP_FAILED) {
+			close(fd);
+			return false;
+		}
+
+		// We read the file front to back, once.
+		posix_madvise(file->mapping, file->length, POSIX_MADV_SEQUENTIAL);
+		file->data = (const char*) file->mapping;
+	}
+
+	close(fd);
+	return true;
+}
+
+void pgn_unmapFile(PgnFile* file) {
+	if (file->mapping != NULL) {
+		munmap(file->mapping, file->length);
+		file->mapping = NULL;
+	}
+}
+
+void pgn_initReader(PgnReader* reader, const char* data, size_t length) {
+	reader->pos = data;
+	reader->end = data + length;
+}
+
+static const char* skipLine(const char* p, const char* end) {
+	while (p < end && *p != '\n') {
+		p++;
+	}
+
+	return p < end ? p + 1 : end;
+}
+
+static const char* skipSpace(const char* p, const char* end) {
+	while (p < end && isspace((unsigned char) *p)) {
+		p++;
+	}
+
+	return p;
+}
+
+// Copies the quoted value of a tag line if it's the named tag and the value fits.
+static void readTagValue(const char* p, const char* lineEnd, const char* name, char* value, size_t size) {
+	const size_t nameLength = strlen(name);
+	if ((size_t) (lineEnd - p) < nameLength + 2 || strncmp(p + 1, name, nameLength) != 0 || p[nameLength + 1] != ' ') {
+		return;
+	}
+
+	const char* valueStart = memchr(p, '"', (size_t) (lineEnd - p));
+	if (valueStart == NULL) {
+		return;
+	}
+
+	valueStart++;
+	const char* valueEnd = memchr(valueStart, '"', (size_t) (lineEnd - valueStart));
+	if (valueEnd == NULL) {
+		return;
+	}
+
+	const size_t length = (size_t) (valueEnd - valueStart);
+	if (length < size) {
+		memcpy(value, valueStart, length);
+		value[length] = '\0';
+	}
+}
+
+// Parses a tag line starting at '[', keeping the tags we use.
+static void readTag(const char* p, const char* end, PgnGame* game) {
+	const char* lineEnd = p;
+	while (lineEnd < end && *lineEnd != '\n') {
+		lineEnd++;
+	}
+
+	readTagValue(p, lineEnd, "FEN", game->fen, PGN_FEN_SIZE);
+	readTagValue(p, lineEnd, "Result", game->result, PGN_RESULT_SIZE);
+}
+
+bool pgn_nextGame(PgnReader* reader, PgnGame* game) {
+	const char* p = skipSpace(reader->pos, reader->end);
+	game->fen[0] = '\0';
+	snprintf(game->result, PGN_RESULT_SIZE, "*");
+
+	while (p < reader->end && *p == '[') {
+		readTag(p, reader->end, game);
+		p = skipSpace(skipLine(p, reader->end), reader->end);
+	}
+
+	if (p >= reader->end) {
+		reader->pos = reader->end;
+		return false;
+	}
+
+	// The move text runs until a tag at the start of a line, outside any comment.
+	game->moveText = p;
+	int32_t commentDepth = 0;
+	bool lineStart = false;
+	while (p < reader->end) {
+		const char c = *p;
+		if (lineStart && c == '[' && commentDepth == 0) {
+			break;
+		}
+
+		if (c == '{') {
+			commentDepth++;
+		} else if (c == '}' && commentDepth > 0) {
+			commentDepth--;
+		}
+
+		lineStart = c == '\n' || (lineStart && (c == ' ' || c == '\t' || c == '\r'));
+		p++;
+	}
+
+	game->moveTextEnd = p;
+	reader->pos = p;
+	return true;
+}
+
+static bool isResult(const char* token) {
+	return strcmp(token, "1-0") == 0 || strcmp(token, "0-1") == 0 || strcmp(token, "1/2-1/2") == 0 || strcmp(token, "*") == 0;
+}
+
+bool pgn_nextMove(const char** cursor, const char* end, char* token, size_t tokenSize) {
+	const char* p = *cursor;
+
+	for (;;) {
+		p = skipSpace(p, end);
+		if (p >= end) {
+			*cursor = end;
+			return false;
+		}
+
+		const char c = *p;
+		if (c == '{') {
+			while (p < end && *p != '}') {
+				p++;
+			}
+			p = p < end ? p + 1 : end;
+		} else if (c == ';' || c == '%') {
+			p = skipLine(p, end);
+		} else if (c == '(') {
+			// Variations can nest, and contain comments that contain parentheses.
+			int32_t depth = 0;
+			while (p < end) {
+				if (*p == '{') {
+					while (p < end && *p != '}') {
+						p++;
+					}
+				} else if (*p == '(') {
+					depth++;
+				} else if (*p == ')' && --depth == 0) {
+					p++;
+					break;
+				}
+
+				if (p < end) {
+					p++;
+				}
+			}
+		} else if (c == ')') {
+			p++;
+		} else if (c == '$') {
+			p++;
+			while (p < end && isdigit((unsigned char) *p)) {
+				p++;
+			}
+		} else {
+			const char* start = p;
+			while (p < end && !isspace((unsigned char) *p) && *p != '{' && *p != '(' && *p != ')' && *p != ';') {
+				p++;
+			}
+
+			size_t length = (size_t) (p - start);
+			if (length >= tokenSize) {
+				length = tokenSize - 1;
+			}
+
+			memcpy(token, start, length);
+			token[length] = '\0';
+
+			if (isResult(token)) {
+				*cursor = end;
+				return false;
+			}
+
+			// Move numbers ("12." or "12...") may have the move attached ("12.e4").
+			char* move = token;
+			if (isdigit((unsigned char) *move) && strchr(move, '.') != NULL) {
+				while (isdigit((unsigned char) *move) || *move == '.') {
+					move++;
+				}
+			}
+
+			// Drop annotation marks.
+			size_t moveLength = strlen(move);
+			while (moveLength > 0 && (move[moveLength - 1] == '!' || move[moveLength - 1] == '?')) {
+				move[--moveLength] = '\0';
+			}
+
+			if (moveLength == 0) {
+				continue;
+			}
+
+			// Some files castle with zeros.
+			if (strcmp(move, "0-0") == 0) {
+				move = "O-O";
+			} else if (strcmp(move, "0-0-0") == 0) {
+				move = "O-O-O";
+			}
+
+			memmove(token, move, strlen(move) + 1);
+			*cursor = p;
+			return true;
+		}
+	}
+}
+
+static size_t lineStart(const char* data, size_t pos) {
+	while (pos > 0 && data[pos - 1] != '\n') {
+		pos--;
+	}
+
+	return pos;
+}
+
+size_t pgn_findGameStart(const char* data, size_t length, size_t offset) {
+	if (offset >= length) {
+		return length;
+	}
+
+	// A game starts at a tag line that follows a line that isn't a tag.
+	size_t pos = lineStart(data, offset);
+	while (pos < length) {
+		if (pos == 0) {
+			return 0;
+		}
+
+		if (data[pos] == '[' && data[lineStart(data, pos - 1)] != '[') {
+			return pos;
+		}
+
+		while (pos < length && data[pos] != '\n') {
+			pos++;
+		}
+		pos++;
+	}
+
+	return length;
+}
@@ -0,0 +1,77 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef PGN_H
+#define PGN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <inttypes.h>
+
+#define PGN_FEN_SIZE 128
+#define PGN_RESULT_SIZE 8
+
+// A PGN file mapped read-only into memory.
+typedef struct {
+	const char* data;
+	size_t length;
+	void* mapping;      // NULL for an empty file.
+} PgnFile;
+
+// Walks the games of a PGN buffer in order, without copying it.
+typedef struct {
+	const char* pos;
+	const char* end;
+} PgnReader;
+
+// One game: its starting position and the span of its move text. The move text is
+// read with pgn_nextMove().
+typedef struct {
+	char fen[PGN_FEN_SIZE];     // The FEN tag, or an empty string for the standard starting position.
+	char result[PGN_RESULT_SIZE];   // The Result tag, or "*" if there isn't one.
+	const char* moveText;
+	const char* moveTextEnd;
+} PgnGame;
+
+// Maps a PGN file into memory. Returns false if it can't be opened.
+bool pgn_mapFile(const char* fileName, PgnFile* file);
+
+// Unmaps a PGN file.
+void pgn_unmapFile(PgnFile* file);
+
+// Starts reading games from the given buffer.
+void pgn_initReader(PgnReader* reader, const char* data, size_t length);
+
+// Reads the tags and locates the move text of the next game. Returns false when there
+// are no more games.
+bool pgn_nextGame(PgnReader* reader, PgnGame* game);
+
+// Copies the next move of a game's move text into token, advancing the cursor. Move
+// numbers, comments, variations, NAGs and annotation marks are skipped; returns false
+// at the end of the game. Tokens longer than tokenSize are truncated.
+bool pgn_nextMove(const char** cursor, const char* end, char* token, size_t tokenSize);
+
+// Finds the offset of the first game starting at or after the given offset, or the
+// length of the buffer if there is none. Used to split a file between threads.
+size_t pgn_findGameStart(const char* data, size_t length, size_t offset);
+
+#endif
@@ -0,0 +1,449 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#define _POSIX_C_SOURCE 200112L // For mmap() and friends with -std=c99
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "tulip.h"
+#include "pgnindex.h"
+#include "book.h"
+#include "fen.h"
+#include "makemove.h"
+#include "move.h"
+#include "notation.h"
+#include "pgn.h"
+#include "util.h"
+
+static const char* INITIAL_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+typedef struct {
+	pthread_t thread;
+	PgnIndexArgs* args;
+	const char* data;           // The games of this worker's slice of the file.
+	size_t length;
+	GameState gameState;
+	IndexPosting* postings;     // Game ids count from 0 within the slice.
+	int64_t postingCount;
+	int64_t postingCapacity;
+	int64_t games;
+	int64_t errors;
+} IndexWorker;
+
+// A sorted run of postings to merge: either a worker's or an existing index file's.
+typedef struct {
+	const IndexPosting* postings;
+	const uint8_t* mapped;
+	uint64_t count;
+	uint64_t next;
+	uint32_t gameIdBase;
+	IndexPosting head;
+} IndexRun;
+
+static void readPosting(const uint8_t* p, IndexPosting* posting) {
+	posting->hash = readLE64(p);
+	posting->gameId = readLE32(p + 8);
+	posting->ply = readLE16(p + 12);
+	posting->move = readLE16(p + 14);
+}
+
+static void addPosting(IndexWorker* worker, uint64_t hash, uint32_t gameId, int32_t ply, uint16_t move) {
+	if (worker->postingCount == worker->postingCapacity) {
+		worker->postingCapacity *= 2;
+		worker->postings = realloc(worker->postings, (size_t) worker->postingCapacity * sizeof(IndexPosting));
+		if (!worker->postings) {
+			perror("Unable to grow index postings.");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	IndexPosting* posting = &worker->postings[worker->postingCount++];
+	posting->hash = hash;
+	posting->gameId = gameId;
+	posting->ply = (uint16_t) ply;
+	posting->move = move;
+}
+
+// Records every position of one game's opening. Returns false if the game was cut
+// short by a move or FEN that couldn't be read.
+static bool indexGame(IndexWorker* worker, PgnGame* game, uint32_t gameId) {
+	GameState* state = &worker->gameState;
+	char fen[PGN_FEN_SIZE];
+	char token[32];
+	Move move;
+
+	snprintf(fen, sizeof(fen), "%s", game->fen[0] != '\0' ? game->fen : INITIAL_FEN);
+	if (!parseFenWithPrint(state, fen, false)) {
+		return false;
+	}
+
+	const char* cursor = game->moveText;
+	const int32_t plies = MIN(worker->args->plies, PGNINDEX_MAX_PLIES);
+	for (int32_t ply = 0; ply < plies; ply++) {
+		const uint64_t hash = book_bookHash(state);
+		if (!pgn_nextMove(&cursor, game->moveTextEnd, token, sizeof(token))) {
+			addPosting(worker, hash, gameId, ply, PACKED_MOVE_NONE);
+			break;
+		}
+
+		if (!notation_matchMove(token, state, &move)) {
+			addPosting(worker, hash, gameId, ply, PACKED_MOVE_NONE);
+			return false;
+		}
+
+		addPosting(worker, hash, gameId, ply, packMove(&move));
+		makeMove(state, &move);
+	}
+
+	return true;
+}
+
+static int comparePostings(const void* a, const void* b) {
+	const IndexPosting* x = (const IndexPosting*) a;
+	const IndexPosting* y = (const IndexPosting*) b;
+	if (x->hash != y->hash) {
+		return x->hash < y->hash ? -1 : 1;
+	}
+
+	if (x->gameId != y->gameId) {
+		return x->gameId < y->gameId ? -1 : 1;
+	}
+
+	return (int) x->ply - (int) y->ply;
+}
+
+static void* runWorker(void* arg) {
+	IndexWorker* worker = (IndexWorker*) arg;
+	PgnReader reader;
+	PgnGame game;
+
+	pgn_initReader(&reader, worker->data, worker->length);
+	while (pgn_nextGame(&reader, &game)) {
+		if (!indexGame(worker, &game, (uint32_t) worker->games)) {
+			worker->errors++;
+		}
+
+		worker->games++;
+	}
+
+	// Sorting here spreads the work over the threads, leaving only a merge.
+	qsort(worker->postings, (size_t) worker->postingCount, sizeof(IndexPosting), comparePostings);
+	return NULL;
+}
+
+static bool advanceRun(IndexRun* run) {
+	if (run->next >= run->count) {
+		return false;
+	}
+
+	if (run->mapped != NULL) {
+		readPosting(run->mapped + run->next * PGNINDEX_POSTING_SIZE, &run->head);
+	} else {
+		run->head = run->postings[run->next];
+	}
+
+	run->head.gameId += run->gameIdBase;
+	run->next++;
+	return true;
+}
+
+// Merges the sorted runs into a new index file. The runs hold consecutive ranges of
+// game ids, in order, so postings of the same position are ordered by run first.
+static bool writeIndex(const char* fileName, IndexRun* runs, int32_t runCount, uint64_t postingCount, uint64_t gameCount) {
+	FILE* fp = fopen(fileName, "wb");
+	if (!fp) {
+		perror("Unable to open index file for writing");
+		return false;
+	}
+
+	uint8_t header[PGNINDEX_HEADER_SIZE];
+	memcpy(header, PGNINDEX_MAGIC, 8);
+	writeLE64(header + 8, postingCount);
+	writeLE64(header + 16, gameCount);
+	bool ok = fwrite(header, 1, sizeof(header), fp) == sizeof(header);
+
+	bool* live = ALLOC((size_t) runCount, bool, live, "Unable to allocate index runs.");
+	for (int32_t i = 0; i < runCount; i++) {
+		live[i] = advanceRun(&runs[i]);
+	}
+
+	while (ok) {
+		int32_t best = -1;
+		for (int32_t i = 0; i < runCount; i++) {
+			if (live[i] && (best < 0 || runs[i].head.hash < runs[best].head.hash)) {
+				best = i;
+			}
+		}
+
+		if (best < 0) {
+			break;
+		}
+
+		const IndexPosting* posting = &runs[best].head;
+		uint8_t record[PGNINDEX_POSTING_SIZE];
+		writeLE64(record, posting->hash);
+		writeLE32(record + 8, posting->gameId);
+		writeLE16(record + 12, posting->ply);
+		writeLE16(record + 14, posting->move);
+		ok = fwrite(record, 1, sizeof(record), fp) == sizeof(record);
+
+		live[best] = advanceRun(&runs[best]);
+	}
+
+	free(live);
+	ok = fclose(fp) == 0 && ok;
+	if (!ok) {
+		fprintf(stderr, "Error writing index file [%s]\n", fileName);
+	}
+
+	return ok;
+}
+
+bool pgnindex_open(const char* fileName, PgnIndex* index) {
+	const int fd = open(fileName, O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size < PGNINDEX_HEADER_SIZE) {
+		close(fd);
+		return false;
+	}
+
+	const size_t size = (size_t) st.st_size;
+	void* mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (mapping == MAP_FAILED) {
+		return false;
+	}
+
+	const uint8_t* bytes = (const uint8_t*) mapping;
+	const uint64_t count = readLE64(bytes + 8);
+	if (memcmp(bytes, PGNINDEX_MAGIC, 8) != 0 || (uint64_t) size != PGNINDEX_HEADER_SIZE + count * PGNINDEX_POSTING_SIZE) {
+		fprintf(stderr, "Index [%s] is truncated or corrupt.\n", fileName);
+		munmap(mapping, size);
+		return false;
+	}
+
+	index->mapping = mapping;
+	index->mappingSize = size;
+	index->postings = bytes + PGNINDEX_HEADER_SIZE;
+	index->postingCount = count;
+	index->gameCount = readLE64(bytes + 16);
+	return true;
+}
+
+void pgnindex_close(PgnIndex* index) {
+	if (index->mapping != NULL) {
+		munmap(index->mapping, index->mappingSize);
+		index->mapping = NULL;
+		index->postings = NULL;
+		index->postingCount = 0;
+	}
+}
+
+bool pgnindex_build(const char* pgnFile, const char* indexFile, PgnIndexArgs* args, PgnIndexResult* result) {
+	PgnIndex existing;
+	existing.mapping = NULL;
+	existing.postings = NULL;
+	existing.postingCount = 0;
+	existing.gameCount = 0;
+	if (args->append && access(indexFile, F_OK) == 0 && !pgnindex_open(indexFile, &existing)) {
+		fprintf(stderr, "Unable to append to index [%s]\n", indexFile);
+		return false;
+	}
+
+	PgnFile pgn;
+	if (!pgn_mapFile(pgnFile, &pgn)) {
+		perror("Unable to open PGN file");
+		pgnindex_close(&existing);
+		return false;
+	}
+
+	const int64_t start = getCurrentTimeMillis();
+
+	// Each worker takes a contiguous slice of the file, split at game boundaries.
+	const int32_t threads = (int32_t) MIN((size_t) args->threads, MAX(pgn.length / 4096, 1));
+	IndexWorker* workers = ALLOC((size_t) threads, IndexWorker, workers, "Unable to allocate index workers.");
+	size_t sliceStart = 0;
+	for (int32_t i = 0; i < threads; i++) {
+		IndexWorker* worker = &workers[i];
+		const size_t sliceEnd = i == threads - 1
+			? pgn.length
+			: pgn_findGameStart(pgn.data, pgn.length, pgn.length / (size_t) threads * (size_t) (i + 1));
+
+		worker->args = args;
+		worker->data = pgn.data + sliceStart;
+		worker->length = MAX(sliceEnd, sliceStart) - sliceStart;
+		worker->games = 0;
+		worker->errors = 0;
+		worker->postingCount = 0;
+		worker->postingCapacity = 4096;
+		worker->postings = ALLOC((size_t) worker->postingCapacity, IndexPosting, worker->postings, "Unable to allocate index postings.");
+		initializeGamestate(&worker->gameState);
+		sliceStart = MAX(sliceEnd, sliceStart);
+	}
+
+	if (threads == 1) {
+		runWorker(&workers[0]);
+	} else {
+		for (int32_t i = 0; i < threads; i++) {
+			if (pthread_create(&workers[i].thread, NULL, runWorker, &workers[i]) != 0) {
+				perror("Unable to start index worker");
+				exit(EXIT_FAILURE);
+			}
+		}
+
+		for (int32_t i = 0; i < threads; i++) {
+			pthread_join(workers[i].thread, NULL);
+		}
+	}
+
+	pgn_unmapFile(&pgn);
+
+	// The existing index, if any, is the first run, then each worker's games in file order.
+	IndexRun* runs = ALLOC((size_t) threads + 1, IndexRun, runs, "Unable to allocate index runs.");
+	memset(runs, 0, ((size_t) threads + 1) * sizeof(IndexRun));
+	runs[0].mapped = existing.postings;
+	runs[0].count = existing.postingCount;
+
+	memset(result, 0, sizeof(PgnIndexResult));
+	uint64_t gameCount = existing.gameCount;
+	uint64_t postingCount = existing.postingCount;
+	for (int32_t i = 0; i < threads; i++) {
+		runs[i + 1].postings = workers[i].postings;
+		runs[i + 1].count = (uint64_t) workers[i].postingCount;
+		runs[i + 1].gameIdBase = (uint32_t) gameCount;
+		gameCount += (uint64_t) workers[i].games;
+		postingCount += (uint64_t) workers[i].postingCount;
+		result->games += workers[i].games;
+		result->errors += workers[i].errors;
+		result->postings += workers[i].postingCount;
+		destroyGamestate(&workers[i].gameState);
+	}
+
+	bool ok = gameCount <= UINT32_MAX;
+	if (!ok) {
+		fprintf(stderr, "Too many games for one index.\n");
+	}
+
+	// Write beside the old index, so that it survives a failed append.
+	char tempFile[1024];
+	snprintf(tempFile, sizeof(tempFile), "%s.tmp", indexFile);
+	ok = ok && writeIndex(tempFile, runs, threads + 1, postingCount, gameCount);
+	pgnindex_close(&existing);
+	if (ok && rename(tempFile, indexFile) != 0) {
+		perror("Unable to replace index file");
+		ok = false;
+	}
+
+	for (int32_t i = 0; i < threads; i++) {
+		free(workers[i].postings);
+	}
+
+	free(runs);
+	free(workers);
+
+	result->totalGames = gameCount;
+	result->totalPostings = postingCount;
+	result->elapsedMillis = getCurrentTimeMillis() - start;
+	return ok;
+}
+
+static int compareMoveCounts(const void* a, const void* b) {
+	const IndexMoveCount* x = (const IndexMoveCount*) a;
+	const IndexMoveCount* y = (const IndexMoveCount*) b;
+	if (x->count != y->count) {
+		return x->count > y->count ? -1 : 1;
+	}
+
+	return (int) x->move - (int) y->move;
+}
+
+void pgnindex_query(PgnIndex* index, GameState* state, int32_t maxGames, IndexQueryResult* result) {
+	const uint64_t hash = book_bookHash(state);
+	maxGames = MIN(maxGames, PGNINDEX_MAX_GAME_IDS);
+
+	result->hash = hash;
+	result->postings = 0;
+	result->games = 0;
+	result->moveCount = 0;
+	result->gameIdCount = 0;
+
+	// Find the first posting for the position.
+	uint64_t low = 0;
+	uint64_t high = index->postingCount;
+	while (low < high) {
+		const uint64_t mid = low + (high - low) / 2;
+		if (readLE64(index->postings + mid * PGNINDEX_POSTING_SIZE) < hash) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	IndexPosting posting;
+	uint32_t lastGameId = 0;
+	for (uint64_t i = low; i < index->postingCount; i++) {
+		readPosting(index->postings + i * PGNINDEX_POSTING_SIZE, &posting);
+		if (posting.hash != hash) {
+			break;
+		}
+
+		result->postings++;
+		if (result->games == 0 || posting.gameId != lastGameId) {
+			result->games++;
+			lastGameId = posting.gameId;
+			if (result->gameIdCount < maxGames) {
+				result->gameIds[result->gameIdCount++] = posting.gameId;
+			}
+		}
+
+		int32_t m = 0;
+		while (m < result->moveCount && result->moves[m].move != posting.move) {
+			m++;
+		}
+
+		if (m == result->moveCount) {
+			if (m == PGNINDEX_MAX_MOVES) {
+				continue;
+			}
+
+			result->moves[m].move = posting.move;
+			result->moves[m].count = 0;
+			result->moveCount++;
+		}
+
+		result->moves[m].count++;
+	}
+
+	qsort(result->moves, (size_t) result->moveCount, sizeof(IndexMoveCount), compareMoveCounts);
+}
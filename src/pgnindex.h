@@ -0,0 +1,113 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef PGNINDEX_H
+#define PGNINDEX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <inttypes.h>
+
+#include "gamestate.h"
+
+// An index is a 24 byte header (the 8 byte magic "TULPINDX", then little-endian 64-bit
+// posting and game counts) followed by 16 byte little-endian postings sorted by hash,
+// game id, then ply: a 64-bit book hash (see book_bookHash()), a 32-bit game id, a
+// 16-bit ply and the 16-bit packed move played next (see packMove()), or
+// PACKED_MOVE_NONE where the game's move text ended. Game ids number the games in the
+// order they were indexed, from 0, across appends.
+#define PGNINDEX_MAGIC "TULPINDX"
+#define PGNINDEX_HEADER_SIZE 24
+#define PGNINDEX_POSTING_SIZE 16
+
+#define PGNINDEX_DEFAULT_PLIES 40
+#define PGNINDEX_MAX_PLIES 500      // A GameState can only replay so many moves.
+#define PGNINDEX_MAX_THREADS 64
+#define PGNINDEX_MAX_MOVES 256
+#define PGNINDEX_MAX_GAME_IDS 1000
+
+// One occurrence of a position in a game.
+typedef struct {
+	uint64_t hash;
+	uint32_t gameId;
+	uint16_t ply;
+	uint16_t move;
+} IndexPosting;
+
+// A mapped index.
+typedef struct {
+	const uint8_t* postings;
+	uint64_t postingCount;
+	uint64_t gameCount;
+	void* mapping;
+	size_t mappingSize;
+} PgnIndex;
+
+// Options for indexing a PGN file.
+typedef struct {
+	int32_t plies;              // Only positions in the first this-many plies of each game are indexed.
+	int32_t threads;            // Workers replaying games in parallel, each with its own GameState.
+	bool append;                // Add to an existing index rather than replacing it.
+} PgnIndexArgs;
+
+// Totals for indexing a PGN file.
+typedef struct {
+	int64_t games;              // Games read from the file.
+	int64_t errors;             // Games cut short at an illegal or unreadable move or FEN.
+	int64_t postings;           // Postings added.
+	uint64_t totalGames;        // Games in the index, after appending.
+	uint64_t totalPostings;     // Postings in the index, after appending.
+	int64_t elapsedMillis;
+} PgnIndexResult;
+
+// How often a move was played from a queried position.
+typedef struct {
+	uint16_t move;              // A packed move, or PACKED_MOVE_NONE for games that ended there.
+	int64_t count;
+} IndexMoveCount;
+
+// What the index knows about a position.
+typedef struct {
+	uint64_t hash;
+	int64_t postings;           // Times the position was reached, counting repeats within a game.
+	int64_t games;              // Distinct games that reached it.
+	IndexMoveCount moves[PGNINDEX_MAX_MOVES];   // Most played first.
+	int32_t moveCount;
+	uint32_t gameIds[PGNINDEX_MAX_GAME_IDS];    // The first games that reached it, by id.
+	int32_t gameIdCount;
+} IndexQueryResult;
+
+// Replays every game in a PGN file, recording a posting for each position reached,
+// and writes (or appends to) an index file. Returns false if either file can't be
+// read or written.
+bool pgnindex_build(const char* pgnFile, const char* indexFile, PgnIndexArgs* args, PgnIndexResult* result);
+
+// Maps an index file. Returns false if it can't be read or isn't an index.
+bool pgnindex_open(const char* fileName, PgnIndex* index);
+
+// Unmaps an index.
+void pgnindex_close(PgnIndex* index);
+
+// Looks up a position, listing at most maxGames game ids (up to PGNINDEX_MAX_GAME_IDS).
+void pgnindex_query(PgnIndex* index, GameState* state, int32_t maxGames, IndexQueryResult* result);
+
+#endif
@@ -0,0 +1,48 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef REPETITION_H
+#define REPETITION_H
+
+#include <inttypes.h>
+
+#include "statedata.h"
+
+// Must be a power of two, and comfortably larger than the state stack so the
+// open-addressed table never fills up.
+#define REPETITION_TABLE_SIZE 1024
+
+typedef struct {
+	uint64_t hash;          // Position hash. Only meaningful while count > 0.
+	int32_t count;          // Occurrences of this position on the current line, game history included.
+	int32_t treeCount;      // Occurrences below the search root.
+} RepetitionEntry;
+
+// Counts of every position on the current line (game history plus the search path),
+// pushed by makeMove() and popped by unmakeMove(). See draw.h.
+typedef struct {
+	RepetitionEntry* entries;
+	StateData* searchRoot;  // Positions above this in the state stack are inside the search tree.
+	int32_t nullMoves;      // Null moves on the current line.
+} RepetitionTable;
+
+#endif
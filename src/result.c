@@ -38,8 +38,6 @@ int32_t getResult(GameState* g) {
                 return STATUS_THREEFOLD_DRAW;
         }
 
-        // TODO: Fifty move count!
-
         const int32_t moves = countLegalMoves(g);
 
         if (moves == 0) {
@@ -53,5 +51,10 @@ int32_t getResult(GameState* g) {
                 }
         }
 
+        // Checked after mate: a mate on the hundredth half move still counts.
+        if (g->current->fiftyMoveCount >= 100) {
+                return STATUS_FIFTY_MOVE_DRAW;
+        }
+
         return STATUS_NONE;
 }
@@ -23,6 +23,7 @@
 #include <limits.h>
 #include <time.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "tulip.h"
 #include "search.h"
@@ -38,9 +39,35 @@
 #include "xboard.h"
 #include "hash.h"
 #include "draw.h"
+#include "instrument.h"
 
 #define USE_Q_SEARCH false
 
+// Scores at least this close to INFINITY are checkmates.
+#define MATE_BOUND (INFINITY - 1000)
+
+// Mate scores count plies from the root, but the same position can be reached again
+// at a different ply. The table keeps them counted from the node they were found at.
+static inline int32_t scoreToHash(const int32_t score, const int32_t ply) {
+	if (score >= MATE_BOUND) {
+		return score + ply;
+	} else if (score <= -MATE_BOUND) {
+		return score - ply;
+	}
+	return score;
+}
+
+static inline int32_t scoreFromHash(const int32_t score, const int32_t ply) {
+	if (score == HASH_NOT_FOUND) {
+		return score;
+	} else if (score >= MATE_BOUND) {
+		return score - ply;
+	} else if (score <= -MATE_BOUND) {
+		return score + ply;
+	}
+	return score;
+}
+
 static int32_t compareMoveScore(const void* a, const void* b) {
 	return ((MoveScore*) b)->score - ((MoveScore*) a)->score; // Underflow issues? Hopefully our scores are on the order of 1e5...
 }
@@ -74,12 +101,93 @@ void initSearchArgs(SearchArgs* args) {
 	args->depth = 5;
 	args->chessInterfaceState = NULL;
 	args->timeToThinkMillis = 5 * 1000;
+	args->nodeLimit = 0;
+	args->onBestMove = NULL;
+	args->callbackState = NULL;
+}
+
+// Wrappers for the calls the search makes at every node. They attribute their cost to a
+// subsystem when built with TULIP_INSTRUMENT, and are plain calls otherwise.
+static inline int32_t timedGenerateMoves(GameState* state, SearchResult* result, MoveBuffer* buffer) {
+	INSTRUMENT_START(timer);
+	const int32_t moveCount = generatePseudoMoves(state, buffer);
+	INSTRUMENT_STOP(&result->instrument, INSTR_MOVEGEN, timer);
+	return moveCount;
+}
+
+static inline void timedMakeMove(GameState* state, SearchResult* result, Move* move) {
+	INSTRUMENT_START(timer);
+	makeMove(state, move);
+	INSTRUMENT_STOP(&result->instrument, INSTR_MAKEMOVE, timer);
+}
+
+static inline void timedUnmakeMove(GameState* state, SearchResult* result, Move* move) {
+	INSTRUMENT_START(timer);
+	unmakeMove(state, move);
+	INSTRUMENT_STOP(&result->instrument, INSTR_MAKEMOVE, timer);
+}
+
+static inline void timedMakeNullMove(GameState* state, SearchResult* result) {
+	INSTRUMENT_START(timer);
+	makeNullMove(state);
+	INSTRUMENT_STOP(&result->instrument, INSTR_MAKEMOVE, timer);
+}
+
+static inline void timedUnmakeNullMove(GameState* state, SearchResult* result) {
+	INSTRUMENT_START(timer);
+	unmakeNullMove(state);
+	INSTRUMENT_STOP(&result->instrument, INSTR_MAKEMOVE, timer);
+}
+
+static inline bool timedIsLegalPosition(GameState* state, SearchResult* result) {
+	INSTRUMENT_START(timer);
+	const bool legal = isLegalPosition(state);
+	INSTRUMENT_STOP(&result->instrument, INSTR_LEGALITY, timer);
+	return legal;
+}
+
+static inline bool timedIsCheck(GameState* state, SearchResult* result) {
+	INSTRUMENT_START(timer);
+	const bool inCheck = isCheck(state);
+	INSTRUMENT_STOP(&result->instrument, INSTR_LEGALITY, timer);
+	return inCheck;
+}
+
+static inline int32_t timedEvaluate(GameState* state, SearchResult* result) {
+	INSTRUMENT_START(timer);
+	const int32_t score = evaluate(state);
+	INSTRUMENT_STOP(&result->instrument, INSTR_EVAL, timer);
+	return score;
+}
+
+static inline int32_t timedHashProbe(GameState* state, SearchResult* result, int32_t ply, int32_t draft, int32_t alpha,
+                                     int32_t beta, bool* hit) {
+	INSTRUMENT_START(timer);
+	const int32_t score = hash_probeWithHit(state, draft, scoreToHash(alpha, ply), scoreToHash(beta, ply), hit);
+	INSTRUMENT_STOP(&result->instrument, INSTR_TT_PROBE, timer);
+	return scoreFromHash(score, ply);
+}
+
+static inline void timedHashPut(GameState* state, SearchResult* result, int32_t ply, int32_t score, int32_t draft,
+                                int32_t flag) {
+	INSTRUMENT_START(timer);
+	hash_put(state, scoreToHash(score, ply), draft, flag);
+	INSTRUMENT_STOP(&result->instrument, INSTR_TT_STORE, timer);
+}
+
+static inline bool timedIsDraw(GameState* state, SearchResult* result) {
+	INSTRUMENT_START(timer);
+	const bool draw = draw_isSearchRepetition(state) || draw_isMaterial(state);
+	INSTRUMENT_STOP(&result->instrument, INSTR_REPETITION, timer);
+	return draw;
 }
 
 // Perform a "quiet" search, which basically means keep playing captures and whatnot until a "quiet" position is reached.
 // This combats the horizon effect where nasty moves (captures, checks) lurk one ply beyond the max search depth.
-static int32_t qsearch(GameState* state, SearchResult* result, const int32_t depth, int32_t alpha, int32_t beta) {
-	const int32_t evalScore = evaluate(state);
+static int32_t qsearch(GameState* state, SearchResult* result, const int32_t ply, int32_t alpha, int32_t beta) {
+	result->stats.qsearchNodes++;
+
+	const int32_t evalScore = timedEvaluate(state, result);
 	if (evalScore >= beta) {
 		return beta;
 	}
@@ -88,16 +196,16 @@ static int32_t qsearch(GameState* state, SearchResult* result, const int32_t dep
 		alpha = evalScore;
 	}
 
-	MoveBuffer* buffer = &state->moveBuffers[depth];
-	const int32_t moveCount = generatePseudoMoves(state, buffer);
+	MoveBuffer* buffer = &state->moveBuffers[ply];
+	const int32_t moveCount = timedGenerateMoves(state, result, buffer);
 
 	for (int32_t i = 0; i < moveCount; i++) {
 		Move m = buffer->moves[i];
 		if (m.captures != &EMPTY) {
-			makeMove(state, &m);
-			if (isLegalPosition(state)) {
-				const int32_t moveScore =  -1 * qsearch(state, result, depth + 1, -1 * beta, -1 * alpha);
-				unmakeMove(state, &m);
+			timedMakeMove(state, result, &m);
+			if (timedIsLegalPosition(state, result)) {
+				const int32_t moveScore =  -1 * qsearch(state, result, ply + 1, -1 * beta, -1 * alpha);
+				timedUnmakeMove(state, result, &m);
 
 				if (moveScore >= beta) {
 					result->betaCutoffs++;
@@ -108,7 +216,7 @@ static int32_t qsearch(GameState* state, SearchResult* result, const int32_t dep
 					alpha = moveScore;
 				}
 			} else {
-				unmakeMove(state, &m);
+				timedUnmakeMove(state, result, &m);
 			}
 		}
 	}
@@ -116,30 +224,48 @@ static int32_t qsearch(GameState* state, SearchResult* result, const int32_t dep
 	return alpha;
 }
 
-static int32_t alphaBeta(GameState* state, SearchResult* result, const int32_t depth, const int32_t maxDepth,
+// The depth counts down the distance to the horizon at maxDepth, and the null move reduction advances it by more
+// than one. The ply is the number of moves actually made since the root, and is what the move buffers, the
+// statistics and the checkmate distance go by.
+static int32_t alphaBeta(GameState* state, SearchResult* result, const int32_t ply, const int32_t depth, const int32_t maxDepth,
                          int32_t alpha, int32_t beta, bool allowNullMove) {
 	result->nodes++;
 
+	PlyStats* stats = &result->stats.plies[MIN(ply, SEARCH_STATS_PLIES - 1)];
+	stats->nodes++;
+
 	int32_t hashf = HASHF_ALPHA;
 
-	if (draw_isThreefold(state) || draw_isMaterial(state)) {
+	if (timedIsDraw(state, result)) {
 		return 0;
 	}
 
 	if (depth >= maxDepth) {
-		const int32_t evalScore = USE_Q_SEARCH ? qsearch(state, result, depth, alpha, beta) :  evaluate(state);
+		int32_t evalScore;
+		if (USE_Q_SEARCH) {
+			INSTRUMENT_START(qsearchTimer);
+			evalScore = qsearch(state, result, ply, alpha, beta);
+			INSTRUMENT_STOP(&result->instrument, INSTR_QSEARCH, qsearchTimer);
+		} else {
+			evalScore = timedEvaluate(state, result);
+		}
+
 		if (allowNullMove) {
-			hash_put(state, evalScore, depth, HASHF_EXACT);
+			timedHashPut(state, result, ply, evalScore, 0, HASHF_EXACT);
 		}
 		return evalScore;
 	}
 
-	const int32_t storedScore = hash_probe(state, depth, alpha, beta);
+	bool hashHit;
+	const int32_t storedScore = timedHashProbe(state, result, ply, maxDepth - depth, alpha, beta, &hashHit);
+	stats->ttProbes++;
+	stats->ttHits += hashHit ? 1 : 0;
 	if (storedScore != HASH_NOT_FOUND) {
+		stats->ttCutoffs++;
 		return storedScore;
 	}
 
-	const bool check = isCheck(state);
+	const bool check = timedIsCheck(state, result);
 
 	// Apply the null-move heuristic if the situation warrants.
 	//
@@ -147,17 +273,19 @@ static int32_t alphaBeta(GameState* state, SearchResult* result, const int32_t d
 	// Null move relies on letting the opponent move twice being the worst possible thing.
 	// Forcing them to move out of a checking position, however, is good.
 	if (allowNullMove && !check) {
-		makeNullMove(state);
-		const int32_t nullScore = -1 * alphaBeta(state, result, depth + 1 + NULL_MOVE_RADIUS, maxDepth, -beta, -beta + 1, false);
-		unmakeNullMove(state);
+		stats->nullMoveTries++;
+		timedMakeNullMove(state, result);
+		const int32_t nullScore = -1 * alphaBeta(state, result, ply + 1, depth + 1 + NULL_MOVE_RADIUS, maxDepth, -beta, -beta + 1, false);
+		timedUnmakeNullMove(state, result);
 
 		if (nullScore > beta) {
+			stats->nullMoveCutoffs++;
 			return beta;
 		}
 	}
 
-	MoveBuffer* buffer = &state->moveBuffers[depth];
-	const int32_t moveCount = generatePseudoMoves(state, buffer);
+	MoveBuffer* buffer = &state->moveBuffers[ply];
+	const int32_t moveCount = timedGenerateMoves(state, result, buffer);
 
 	// If we're early in the search, sort the moves a bit nicer.
 	if (depth < 3) {
@@ -165,21 +293,25 @@ static int32_t alphaBeta(GameState* state, SearchResult* result, const int32_t d
 	}
 
 	bool noLegalMoves = true;
+	int32_t legalMovesSearched = 0;
 
 	for (int32_t i = 0; i < moveCount; i++) {
 		Move m = buffer->moves[i];
 
-		makeMove(state, &m);
+		timedMakeMove(state, result, &m);
 
-		if (isLegalPosition(state)) {
+		if (timedIsLegalPosition(state, result)) {
 			noLegalMoves = false;
-			const int32_t moveScore =  -1 * alphaBeta(state, result, depth + 1, maxDepth, -1 * beta, -1 * alpha, allowNullMove);
-			unmakeMove(state, &m);
+			legalMovesSearched++;
+			const int32_t moveScore =  -1 * alphaBeta(state, result, ply + 1, depth + 1, maxDepth, -1 * beta, -1 * alpha, allowNullMove);
+			timedUnmakeMove(state, result, &m);
 
 			if (moveScore >= beta) {
 				result->betaCutoffs++;
+				stats->cutNodes++;
+				stats->firstMoveCutoffs += legalMovesSearched == 1 ? 1 : 0;
 				if (allowNullMove) {
-					hash_put(state, beta, depth, HASHF_BETA);
+					timedHashPut(state, result, ply, beta, maxDepth - depth, HASHF_BETA);
 				}
 				return beta;
 			}
@@ -189,49 +321,58 @@ static int32_t alphaBeta(GameState* state, SearchResult* result, const int32_t d
 				alpha = moveScore;
 			}
 		} else {
-			unmakeMove(state, &m);
+			timedUnmakeMove(state, result, &m);
 		}
 	}
 
 	if (noLegalMoves) {
 		// No legal moves and check? Checkmate. Else, stalemate.
-		// Add the search depth to encourage "faster" checkmates; so longer checkmates are worth slightly less.
-		const int32_t score = check ? -INFINITY + depth : 0;
-		hash_put(state, score, 0, HASHF_EXACT); // We know exactly what the score is here, searching deeper doesn't change it.
+		// Add the ply to encourage "faster" checkmates; so longer checkmates are worth slightly less.
+		const int32_t score = check ? -INFINITY + ply : 0;
+		timedHashPut(state, result, ply, score, HASH_DRAFT_FINAL, HASHF_EXACT); // We know exactly what the score is here, searching deeper doesn't change it.
 		return score;
 	}
 
-	hash_put(state, alpha, depth, hashf);
+	if (hashf == HASHF_EXACT) {
+		stats->pvNodes++;
+	} else {
+		stats->allNodes++;
+	}
+
+	timedHashPut(state, result, ply, alpha, maxDepth - depth, hashf);
 
 	return alpha;
 }
 
 static void logMoveScoreList(GameLog* log, GameState* state, MoveScore* scores, int32_t size) {
-	const size_t buffSize = 2048;
-	char* buff = calloc(buffSize, sizeof(char));
-	uint32_t pos = 0;
-	char moveStr[8];
-	char scoreStr[16];
+	if (log == NULL || TULIP_LOG_MIN_LEVEL > LOG_LEVEL_DEBUG) {
+		return;
+	}
+
+	char buff[LOG_BUFFER_SIZE];
+	char moveStr[16];
+	size_t pos = 0;
 	buff[pos++] = '[';
-	// TODO: Better checking to ensure we don't exceed buff's size.
-	for (int32_t i = 0; i < size; i++) {
+	for (int32_t i = 0; i < size && pos < sizeof(buff); i++) {
 		notation_printShortAlg(&scores[i].move, state, moveStr);
-		snprintf(scoreStr, 16, "%s: %+.2f", moveStr, (double) scores[i].score / 100.0);
+		const int written = snprintf(buff + pos, sizeof(buff) - pos, "%s%s: %+.2f", i == 0 ? "" : ", ", moveStr,
+		                             (double) scores[i].score / 100.0);
+		pos += written > 0 ? (size_t) written : 0;
+	}
 
-		// TODO: memcopy() is probably better here.
-		for (int32_t j = 0; scoreStr[j] && j < 16; j++) {
-			buff[pos++] = scoreStr[j];
-		}
-		if (i != size - 1) {
-			buff[pos++] = ',';
-			buff[pos++] = ' ';
-		}
+	// Close the list if it fit; a truncated list is left open.
+	if (pos < sizeof(buff) - 1) {
+		buff[pos++] = ']';
+		buff[pos] = '\0';
 	}
-	buff[pos++] = ']';
-	buff[pos++] = '\0';
 
-	log_write(log, buff);
-	free(buff);
+	log_debug(log, "%s", buff);
+}
+
+static void reportBestMove(SearchArgs* args, int32_t depth, int32_t score, int64_t startTime, Move* move) {
+	if (args->onBestMove != NULL) {
+		args->onBestMove(args->callbackState, depth, score, getCurrentTimeMillis() - startTime, move);
+	}
 }
 
 static void postSearchThinking(void* interState, GameState* state, int32_t depth, int32_t score, int64_t nodes, int64_t startTime, Move bestMove) {
@@ -250,7 +391,12 @@ static void postSearchThinking(void* interState, GameState* state, int32_t depth
 	destroyMoveBuffer(&mb);
 }
 
-static bool outOfTime(SearchArgs* args, int64_t start) {
+static bool limitReached(SearchArgs* args, SearchResult* searchResult, int64_t start) {
+	if (args->nodeLimit > 0 && searchResult->nodes >= args->nodeLimit) {
+		log_write(args->log, "Out of nodes (%"PRId64" >= %"PRId64")", searchResult->nodes, args->nodeLimit);
+		return true;
+	}
+
 	const int64_t span = getCurrentTimeMillis() - start;
 	const bool result = span > args->timeToThinkMillis;
 
@@ -273,7 +419,7 @@ static void deepSearch(GameState* state, SearchArgs* searchArgs, SearchResult* r
 		Move m = moveScores[i].move;
 
 		makeMove(state, &m);
-		const int32_t score = -1 * alphaBeta(state, result, 0, maxDepth, -beta, -alpha, true);
+		const int32_t score = -1 * alphaBeta(state, result, 0, 0, maxDepth, -beta, -alpha, true);
 		unmakeMove(state, &m);
 
 		if (score > alpha) {
@@ -281,14 +427,17 @@ static void deepSearch(GameState* state, SearchArgs* searchArgs, SearchResult* r
 		}
 
 		if (score > best.score) {
-			notation_printShortAlg(&m, state, moveStr);
-			log_write(log, "Improved score in deep search: %s, %+0.2f", moveStr, friendlyScore(state, score));
+			if (log != NULL) {
+				notation_printShortAlg(&m, state, moveStr);
+				log_write(log, "Improved score in deep search: %s, %+0.2f", moveStr, friendlyScore(state, score));
+			}
 			postSearchThinking(searchArgs->chessInterfaceState, state, maxDepth, score, result->nodes, startTime, m);
+			reportBestMove(searchArgs, maxDepth, score, startTime, &m);
 			best.score = score;
 			best.move = m;
 		}
 
-		if (outOfTime(searchArgs, startTime)) {
+		if (limitReached(searchArgs, result, startTime)) {
 			break;
 		}
 	}
@@ -312,7 +461,7 @@ static void iterativeDeepen(
 		Move m = legalMoves->moves[i];
 
 		makeMove(state, &m);
-		const int32_t score = -1 * alphaBeta(state, result, 0, maxDepth, -INFINITY, INFINITY, true);
+		const int32_t score = -1 * alphaBeta(state, result, 0, 0, maxDepth, -INFINITY, INFINITY, true);
 		unmakeMove(state, &m);
 
 		// We don't update alpha/beta here because doing so can lead to misleading elements in the move score list.
@@ -325,7 +474,7 @@ static void iterativeDeepen(
 		// We want to make sure at least one full pass of this function is completed.
 		// Otherwise we'll have incompletely initiaized data in moveScores.
 		// Ignore the clock if we're at depth 0.
-		if (maxDepth > 1 && outOfTime(args, startTime)) {
+		if (maxDepth > 1 && limitReached(args, result, startTime)) {
 			break;
 		}
 	}
@@ -335,7 +484,7 @@ static void iterativeDeepen(
 	result->score = moveScores[0].score;
 	result->move = moveScores[0].move;
 
-	log_write(args->log, "Completed iterative deepening to depth=%i", maxDepth);
+	log_debug(args->log, "Completed iterative deepening to depth=%i", maxDepth);
 	logMoveScoreList(args->log, state, moveScores, legalMoves->length);
 }
 
@@ -353,7 +502,7 @@ static void reorderMovesFromMoveScores(MoveScore* scores, int32_t scoreLength, M
 }
 
 static bool isEarlyCheckmate(int32_t score) {
-	return score >= (INFINITY - 1000);
+	return score >= MATE_BOUND;
 }
 
 // This is called once per search. It orders the moves at the root level thusly:
@@ -393,18 +542,59 @@ static void orderRootNode(GameState* state, MoveBuffer* buffer) {
 }
 
 static void logSearchResult(SearchArgs* args, SearchResult* result, GameState* state) {
+	if (args->log == NULL) {
+		return;
+	}
+
 	const int64_t nodes = result->nodes;
 	const int64_t duration = result->durationMs;
 	const double knodes = ((double) nodes) / 1000.0;
 	const double seconds = ((double) duration) / 1000.0;
 	const double score = friendlyScore(state, result->score);
-	const double betaPct = ((double) result->betaCutoffs) / (double) result->nodes;
+	const double betaPct = nodes > 0 ? 100.0 * (double) result->betaCutoffs / (double) nodes : 0.0;
 
 	log_write(args->log, "Search complete. Score %+.2f; %ld nodes in %ldms (%.2f KNps)", score, nodes, duration, knodes / seconds);
-	log_write(args->log, "Beta cutoff in %i/%i of nodes (%.2f%%)", result->betaCutoffs, nodes, betaPct);
+	log_write(args->log, "Beta cutoff in %i/%"PRId64" of nodes (%.2f%%)", result->betaCutoffs, nodes, betaPct);
+
+	for (int32_t d = 1; d < SEARCH_STATS_PLIES; d++) {
+		const int64_t iterationNodes = result->stats.iterationNodes[d];
+		const int64_t previousNodes = result->stats.iterationNodes[d - 1];
+		if (iterationNodes > 0) {
+			log_debug(args->log, "Depth %2i: %10"PRId64" nodes, EBF %.2f", d, iterationNodes,
+			          previousNodes > 0 ? (double) iterationNodes / (double) previousNodes : 0.0);
+		}
+	}
+
+	for (int32_t ply = 0; ply < SEARCH_STATS_PLIES; ply++) {
+		PlyStats* p = &result->stats.plies[ply];
+		if (p->nodes == 0) {
+			continue;
+		}
+
+		log_debug(args->log, "Ply %2i: %10"PRId64" nodes (PV %"PRId64", cut %"PRId64", all %"PRId64"), first-move cutoffs %.1f%%, "
+		          "TT hits %.1f%%, TT cutoffs %.1f%%, null-move cutoffs %.1f%%", ply, p->nodes, p->pvNodes, p->cutNodes, p->allNodes,
+		          p->cutNodes > 0 ? 100.0 * (double) p->firstMoveCutoffs / (double) p->cutNodes : 0.0,
+		          p->ttProbes > 0 ? 100.0 * (double) p->ttHits / (double) p->ttProbes : 0.0,
+		          p->ttProbes > 0 ? 100.0 * (double) p->ttCutoffs / (double) p->ttProbes : 0.0,
+		          p->nullMoveTries > 0 ? 100.0 * (double) p->nullMoveCutoffs / (double) p->nullMoveTries : 0.0);
+	}
+
+#ifdef TULIP_INSTRUMENT
+	for (int32_t i = 0; i < INSTR_COUNT; i++) {
+		const int64_t calls = result->instrument.calls[i];
+		const int64_t nanos = result->instrument.nanos[i];
+		log_write(args->log, "%-10s %12"PRId64" calls (%.2f/node) %10.2fms (%.1f ns/call)", instrument_name(i), calls,
+		          nodes > 0 ? (double) calls / (double) nodes : 0.0, (double) nanos / 1e6,
+		          calls > 0 ? (double) nanos / (double) calls : 0.0);
+	}
+#endif
 }
 
 static void logIterativeResult(GameState* state, SearchArgs* searchArgs, MoveScore* scores, int32_t depth) {
+	if (searchArgs->log == NULL) {
+		return;
+	}
+
 	char moveStr[16];
 	MoveScore top = scores[0];
 	notation_printShortAlg(&top.move, state, moveStr);
@@ -414,11 +604,29 @@ static void logIterativeResult(GameState* state, SearchArgs* searchArgs, MoveSco
 
 bool search(GameState* state, SearchArgs* searchArgs, SearchResult* result) {
 	MoveBuffer buffer;
+
+	// Not even one iteration would run, leaving no move to report.
+	if (searchArgs->depth < 1) {
+		result->searchStatus = SEARCH_STATUS_INVALID_DEPTH;
+		result->moveScoreLength = 0;
+		result->score = INT_MIN;
+		result->nodes = 0;
+		result->betaCutoffs = 0;
+		result->durationMs = 0;
+		memset(&result->stats, 0, sizeof(SearchStats));
+		INSTRUMENT_RESET(&result->instrument);
+		return false;
+	}
+
 	result->searchStatus = SEARCH_STATUS_NONE;
 	createMoveBuffer(&buffer);
 
 	log_write(searchArgs->log, "Search starting with depth=%i", searchArgs->depth);
 
+	prepareForSearch(state);
+
+	draw_setSearchRoot(state);
+
 	const int64_t start = getCurrentTimeMillis();
 	const int32_t moveCount = generateLegalMoves(state, &buffer);
 
@@ -429,6 +637,8 @@ bool search(GameState* state, SearchArgs* searchArgs, SearchResult* result) {
 	result->score = INT_MIN;
 	result->nodes = 0;
 	result->betaCutoffs = 0;
+	memset(&result->stats, 0, sizeof(SearchStats));
+	INSTRUMENT_RESET(&result->instrument);
 	MoveScore* scores = result->moveScores;
 
 	// Do successively deeper searches out to a reasonably shallow depth, sorting the moves by score after each search.
@@ -437,9 +647,12 @@ bool search(GameState* state, SearchArgs* searchArgs, SearchResult* result) {
 	// 2. Ensures that we at least have a "decent" move in a given time frame, since the first few iterations should only take a few millis.
 	const int32_t iterationDeepenDepth = searchArgs->depth > ITERATIVE_DEEPEN_DEPTH ? ITERATIVE_DEEPEN_DEPTH : searchArgs -> depth;
 	if (moveCount) {
-		bool doDeepSearch = true;
+		// The deep search only adds anything when asked for more depth than iterative deepening covers.
+		bool doDeepSearch = searchArgs->depth > iterationDeepenDepth;
 		for (int32_t depth = 1; depth <= iterationDeepenDepth; depth++) {
+			const int64_t nodesBefore = result->nodes;
 			iterativeDeepen(state, result, scores, &buffer, depth, start, searchArgs);
+			result->stats.iterationNodes[MIN(depth, SEARCH_STATS_PLIES - 1)] = result->nodes - nodesBefore;
 
 			// After each iteration, reorder the move search order "best moves first."
 			// This speeds up successive searches by creating beta cutoffs faster.
@@ -448,6 +661,7 @@ bool search(GameState* state, SearchArgs* searchArgs, SearchResult* result) {
 			logIterativeResult(state, searchArgs, scores, depth);
 
 			postSearchThinking(searchArgs->chessInterfaceState, state, depth, scores[0].score, result->nodes, start, scores[0].move);
+			reportBestMove(searchArgs, depth, scores[0].score, start, &scores[0].move);
 
 			// If we found a checkmate, just play that immediately. No need to deepen further!
 			if (isEarlyCheckmate(scores[0].score)) {
@@ -456,8 +670,8 @@ bool search(GameState* state, SearchArgs* searchArgs, SearchResult* result) {
 				break;
 			}
 
-			// If we're out of time, just go with whatever we have now.
-			if (outOfTime(searchArgs, start)) {
+			// If we're out of time or nodes, just go with whatever we have now.
+			if (limitReached(searchArgs, result, start)) {
 				doDeepSearch = false;
 				break;
 			}
@@ -465,7 +679,10 @@ bool search(GameState* state, SearchArgs* searchArgs, SearchResult* result) {
 
 		// With the moves nicely ordered, start the deep search that might take a while.
 		if (doDeepSearch) {
-			deepSearch(state, searchArgs, result, scores, buffer.length, DEEP_SEARCH_DEPTH, searchArgs->log, start);
+			const int32_t deepDepth = MIN(searchArgs->depth, DEEP_SEARCH_DEPTH);
+			const int64_t nodesBefore = result->nodes;
+			deepSearch(state, searchArgs, result, scores, buffer.length, deepDepth, searchArgs->log, start);
+			result->stats.iterationNodes[MIN(deepDepth, SEARCH_STATS_PLIES - 1)] = result->nodes - nodesBefore;
 		}
 	} else {
 		result->searchStatus = SEARCH_STATUS_NO_LEGAL_MOVES;
@@ -479,10 +696,17 @@ bool search(GameState* state, SearchArgs* searchArgs, SearchResult* result) {
 
 	postSearchThinking(searchArgs->chessInterfaceState, state, searchArgs->depth, result->score, result->nodes, start, result->move);
 
+	draw_clearSearchRoot(state);
 	destroyMoveBuffer(&buffer);
 	return true;
 }
 
+int32_t quiescenceScore(GameState* state, SearchResult* result) {
+	prepareForSearch(state);
+	result->stats.qsearchNodes = 0;
+	return qsearch(state, result, 0, -INFINITY, INFINITY);
+}
+
 void createSearchResult(SearchResult* result) {
 	result->searchStatus = SEARCH_STATUS_NONE;
 	result->score = INT_MIN;
@@ -29,6 +29,7 @@
 #include "gamestate.h"
 #include "notation.h"
 #include "log.h"
+#include "instrument.h"
 
 #define INFINITY 10000 // Close enough.
 
@@ -39,6 +40,7 @@
 
 #define SEARCH_STATUS_NONE              0
 #define SEARCH_STATUS_NO_LEGAL_MOVES    1
+#define SEARCH_STATUS_INVALID_DEPTH     2
 
 // Used for sorting moves by their score.
 typedef struct {
@@ -47,23 +49,59 @@ typedef struct {
 	int32_t depth;
 } MoveScore;
 
+// Plies below the root that get their own statistics; deeper plies share the last entry.
+#define SEARCH_STATS_PLIES 16
+
+// Tree-shape statistics for one ply below the root (ply 0 is the position after a root move).
+// Interior nodes that search their moves are classified by how they ended: a cut node failed
+// high, a PV node raised alpha without failing high, and an all node raised nothing.
+typedef struct {
+	int64_t nodes;              // Every node visited at this ply, including leaves.
+	int64_t pvNodes;
+	int64_t cutNodes;
+	int64_t allNodes;
+	int64_t firstMoveCutoffs;   // Cut nodes where the first legal move caused the cutoff.
+	int64_t ttProbes;           // Transposition table lookups.
+	int64_t ttHits;             // Lookups that found an entry for the position.
+	int64_t ttCutoffs;          // Lookups whose entry was deep enough to return a score.
+	int64_t nullMoveTries;
+	int64_t nullMoveCutoffs;    // Null-move searches that failed high and pruned the node.
+} PlyStats;
+
+typedef struct {
+	PlyStats plies[SEARCH_STATS_PLIES];
+	int64_t iterationNodes[SEARCH_STATS_PLIES]; // Nodes searched by the iteration to each depth; 0 if not run.
+	int64_t qsearchNodes;       // Nodes visited by the quiescence search.
+} SearchStats;
+
 // Structure to define the output of the search method.
 typedef struct {
 	int32_t score;              // The current game score, from the perspective of the side to move.
 	Move move;              // The best move.
 	int64_t durationMs;        // The search duration.
 	int64_t nodes;             // The number of positions processed.
-	int32_t searchStatus;       // SEARCH_STATUS_NO_LEGAL_MOVES if no moves could be considered.
+	int32_t searchStatus;       // SEARCH_STATUS_NONE if move holds a result, else why it doesn't.
 	MoveScore* moveScores;  // A list of the moves considered and their scores.
 	int32_t moveScoreLength;    // The length of moveScores.
 	int32_t betaCutoffs;
+	SearchStats stats;          // Tree-shape statistics; see PlyStats.
+#ifdef TULIP_INSTRUMENT
+	InstrumentCounters instrument; // Per-subsystem calls and time; see instrument.h.
+#endif
 } SearchResult;
 
+// Called each time the search settles on a best move: after every iterative deepening pass
+// and whenever the deep search improves on its best root move.
+typedef void (*BestMoveCallback)(void* callbackState, int32_t depth, int32_t score, int64_t elapsedMs, Move* move);
+
 typedef struct {
 	int32_t depth;      // The maximum search depth.
 	GameLog* log;    // The game log.
 	void* chessInterfaceState;    // A flag to indicate if the search should output XBoard thinking lines.
 	int64_t timeToThinkMillis; // An approximate number of milliseconds to use for thinking.
+	int64_t nodeLimit;         // Stop after about this many nodes; 0 for no limit. Like the clock, checked between root moves.
+	BestMoveCallback onBestMove;  // Optional progress callback; NULL if unused.
+	void* callbackState;          // Passed through to onBestMove.
 } SearchArgs;
 
 void initSearchArgs(SearchArgs* args);
@@ -75,8 +113,13 @@ void createSearchResult(SearchResult* result);
 void destroySearchResult(SearchResult* result);
 
 // Think. Figure out the best move. This is a blocking operation at the moment.
+// Returns false, with SEARCH_STATUS_INVALID_DEPTH, if asked for a depth below 1.
 bool search(GameState* state, SearchArgs* searchArgs, SearchResult* result);
 
+// Runs just the quiescence search on a position that isn't in check, and returns its
+// score from the perspective of the side to move.
+int32_t quiescenceScore(GameState* state, SearchResult* result);
+
 // Do a zero-depth move ordering, first by most valuable victim (Mvv) and then by least valuable attacker (lva).
 void orderByMvvLva(MoveBuffer* buffer);
 #endif
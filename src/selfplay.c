@@ -0,0 +1,389 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "tulip.h"
+#include "selfplay.h"
+#include "book.h"
+#include "epd.h"
+#include "gamestate.h"
+#include "fen.h"
+#include "hash.h"
+#include "makemove.h"
+#include "packedpos.h"
+#include "result.h"
+#include "search.h"
+#include "sprt.h"
+#include "time.h"
+#include "util.h"
+#include "ztable.h"
+
+#define SELFPLAY_FEN_LEN 128
+#define SELFPLAY_LINE_LEN 512
+
+static const char* INITIAL_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+typedef struct {
+	char (*fens)[SELFPLAY_FEN_LEN];
+	int32_t count;
+	int32_t capacity;
+} OpeningList;
+
+typedef struct {
+	SelfPlayArgs* args;
+	SelfPlayResult* result;
+	OpeningList openings;
+	int32_t next;           // Index of the next unclaimed game, guarded by lock.
+	pthread_mutex_t lock;
+} SelfPlayQueue;
+
+typedef struct {
+	pthread_t thread;
+	SelfPlayQueue* queue;
+	GameState gameState;
+	ZTable zTables[2];      // One per engine, kept for the whole game.
+	SearchResult searchResult;
+} SelfPlayWorker;
+
+// Game outcomes, from white's point of view.
+#define OUTCOME_WHITE_WINS   1
+#define OUTCOME_DRAW         0
+#define OUTCOME_BLACK_WINS  -1
+
+void selfplay_updateStats(SelfPlayResult* result, SelfPlayArgs* args) {
+	sprt_bounds(args->alpha, args->beta, &result->lowerBound, &result->upperBound);
+	result->elo = sprt_elo(result->wins, result->draws, result->losses, &result->eloError);
+	result->llr = sprt_llr(result->wins, result->draws, result->losses, args->elo0, args->elo1);
+
+	// The first verdict stands; games already under way when it came are still counted.
+	if (result->verdict == SPRT_CONTINUE) {
+		if (result->llr >= result->upperBound) {
+			result->verdict = SPRT_ACCEPT_H1;
+		} else if (result->llr <= result->lowerBound) {
+			result->verdict = SPRT_ACCEPT_H0;
+		}
+	}
+}
+
+const char* selfplay_verdictString(int32_t verdict) {
+	switch (verdict) {
+	case SPRT_ACCEPT_H0:
+		return "H0 accepted";
+	case SPRT_ACCEPT_H1:
+		return "H1 accepted";
+	default:
+		return "continue";
+	}
+}
+
+// Plays one game from the opening. Returns the outcome from white's point of view.
+static int32_t playGame(SelfPlayWorker* worker, const char* opening, int32_t whiteEngine, int32_t* plies, bool* timeLoss) {
+	GameState* state = &worker->gameState;
+	SelfPlayArgs* args = worker->queue->args;
+	char fen[SELFPLAY_FEN_LEN];
+	int64_t clocks[2];
+
+	strcpy(fen, opening);
+	parseFenWithPrint(state, fen, false);
+
+	for (int32_t i = 0; i < 2; i++) {
+		hash_clearZTable(&worker->zTables[i]);
+		clocks[i] = args->engines[i].baseMillis;
+	}
+
+	*plies = 0;
+	*timeLoss = false;
+
+	while (*plies < SELFPLAY_MAX_PLIES) {
+		switch (getResult(state)) {
+		case STATUS_WHITE_CHECKMATED:
+			return OUTCOME_BLACK_WINS;
+		case STATUS_BLACK_CHECKMATED:
+			return OUTCOME_WHITE_WINS;
+		case STATUS_NONE:
+			break;
+		default:
+			return OUTCOME_DRAW;
+		}
+
+		const bool whiteToMove = state->current->toMove == COLOR_WHITE;
+		const int32_t side = whiteToMove ? whiteEngine : 1 - whiteEngine;
+		EngineConfig* engine = &args->engines[side];
+
+		SearchArgs searchArgs;
+		initSearchArgs(&searchArgs);
+		searchArgs.depth = engine->depth;
+		searchArgs.timeToThinkMillis = time_thinkTimeMillis(state, clocks[side], clocks[1 - side]);
+		state->zTable = &worker->zTables[side];
+
+		const int64_t start = getCurrentTimeMillis();
+		search(state, &searchArgs, &worker->searchResult);
+		clocks[side] -= getCurrentTimeMillis() - start;
+
+		if (clocks[side] < 0) {
+			*timeLoss = true;
+			return whiteToMove ? OUTCOME_BLACK_WINS : OUTCOME_WHITE_WINS;
+		}
+
+		clocks[side] += engine->incrementMillis;
+		makeMove(state, &worker->searchResult.move);
+		(*plies)++;
+	}
+
+	return OUTCOME_DRAW;
+}
+
+static void printProgress(SelfPlayResult* result, SelfPlayArgs* args) {
+	fprintf(stderr, "Game %i of %i: +%i =%i -%i, Elo %.1f +/- %.1f, LLR %.2f (%.2f, %.2f) %s\n",
+	        result->games, args->games, result->wins, result->draws, result->losses,
+	        result->elo, result->eloError, result->llr, result->lowerBound, result->upperBound,
+	        selfplay_verdictString(result->verdict));
+}
+
+static void* runWorker(void* arg) {
+	SelfPlayWorker* worker = (SelfPlayWorker*) arg;
+	SelfPlayQueue* queue = worker->queue;
+	SelfPlayResult* result = queue->result;
+
+	while (true) {
+		pthread_mutex_lock(&queue->lock);
+		const bool open = queue->next < queue->args->games && result->verdict == SPRT_CONTINUE;
+		const int32_t game = open ? queue->next++ : -1;
+		pthread_mutex_unlock(&queue->lock);
+
+		if (game < 0) {
+			break;
+		}
+
+		// Both games of a pair share an opening; the engine under test is white in the first.
+		const int32_t whiteEngine = game % 2;
+		const char* opening = queue->openings.fens[(game / 2) % queue->openings.count];
+		int32_t plies;
+		bool timeLoss;
+		const int32_t outcome = playGame(worker, opening, whiteEngine, &plies, &timeLoss);
+		const int32_t score = whiteEngine == 0 ? outcome : -outcome;
+
+		pthread_mutex_lock(&queue->lock);
+		result->games++;
+		result->wins += score > 0 ? 1 : 0;
+		result->draws += score == 0 ? 1 : 0;
+		result->losses += score < 0 ? 1 : 0;
+		result->timeLosses += timeLoss ? 1 : 0;
+		result->plies += plies;
+		selfplay_updateStats(result, queue->args);
+		printProgress(result, queue->args);
+		pthread_mutex_unlock(&queue->lock);
+	}
+
+	return NULL;
+}
+
+static void addOpening(OpeningList* list, const char* fen) {
+	if (list->count == list->capacity) {
+		list->capacity *= 2;
+		list->fens = realloc(list->fens, (size_t) list->capacity * SELFPLAY_FEN_LEN);
+		if (!list->fens) {
+			perror("Unable to grow openings.");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	snprintf(list->fens[list->count++], SELFPLAY_FEN_LEN, "%s", fen);
+}
+
+// Walks a random line of the book for each game pair. Each pair draws from its own
+// stream of the seed.
+static void readBookOpenings(OpenBook* book, int32_t pairs, int32_t plies, uint64_t seed, OpeningList* list) {
+	GameState state;
+	char fen[SELFPLAY_FEN_LEN];
+	Move move;
+	initializeGamestate(&state);
+
+	for (int32_t i = 0; i < pairs; i++) {
+		uint64_t random = seedRandom(seed, i);
+		strcpy(fen, INITIAL_FEN);
+		parseFen(&state, fen);
+
+		for (int32_t ply = 0; ply < plies && book_chooseMoveWith(&state, book, nextRandom(&random), &move); ply++) {
+			makeMove(&state, &move);
+		}
+
+		printFen(&state, fen, SELFPLAY_FEN_LEN);
+		addOpening(list, fen);
+	}
+
+	destroyGamestate(&state);
+}
+
+static void readPackedOpenings(PackedFile* file, OpeningList* list) {
+	GameState state;
+	char fen[SELFPLAY_FEN_LEN];
+	initializeGamestate(&state);
+
+	for (uint64_t i = 0; i < file->count && list->count < INT32_MAX; i++) {
+		if (unpackPosition(&state, file->positions + i * PACKED_POSITION_SIZE)) {
+			printFen(&state, fen, SELFPLAY_FEN_LEN);
+			addOpening(list, fen);
+		}
+	}
+
+	destroyGamestate(&state);
+}
+
+static bool readTextOpenings(const char* fileName, OpeningList* list) {
+	char line[SELFPLAY_LINE_LEN];
+	char fen[SELFPLAY_FEN_LEN];
+	GameState state;
+
+	FILE* file = fopen(fileName, "r");
+	if (!file) {
+		perror("Unable to open opening file");
+		return false;
+	}
+
+	initializeGamestate(&state);
+
+	while (fgets(line, SELFPLAY_LINE_LEN, file)) {
+		const char* p = line;
+		while (*p == ' ' || *p == '\t') {
+			p++;
+		}
+
+		if (*p == '\0' || *p == '\n' || *p == '\r' || *p == '#') {
+			continue;
+		}
+
+		// The FEN is parsed again when each game starts; keep only positions that parse.
+		if (epd_toFen(line, fen, sizeof(fen)) && parseFenWithPrint(&state, fen, false)) {
+			addOpening(list, fen);
+		}
+	}
+
+	destroyGamestate(&state);
+	fclose(file);
+	return true;
+}
+
+// Reads the openings for a match from a binary book, a packed position file or a text file.
+static bool readOpenings(const char* fileName, SelfPlayArgs* args, OpeningList* list) {
+	list->count = 0;
+	list->capacity = 64;
+	list->fens = malloc((size_t) list->capacity * SELFPLAY_FEN_LEN);
+	if (!list->fens) {
+		perror("Unable to allocate openings.");
+		exit(EXIT_FAILURE);
+	}
+
+	bool ok = true;
+	OpenBook book;
+	PackedFile packed;
+
+	if (book_open(fileName, &book) && book.format == BOOK_FORMAT_BINARY) {
+		readBookOpenings(&book, (args->games + 1) / 2, args->bookPlies, args->seed, list);
+		book_close(&book);
+	} else if (packedpos_isPackedFile(fileName)) {
+		ok = packedpos_open(fileName, &packed);
+		if (ok) {
+			readPackedOpenings(&packed, list);
+			packedpos_close(&packed);
+		}
+	} else {
+		ok = readTextOpenings(fileName, list);
+	}
+
+	if (ok && list->count == 0) {
+		fprintf(stderr, "No opening positions found in [%s].\n", fileName);
+		ok = false;
+	}
+
+	if (!ok) {
+		free(list->fens);
+	}
+
+	return ok;
+}
+
+bool selfplay_run(const char* openingFile, SelfPlayArgs* args, SelfPlayResult* result) {
+	memset(result, 0, sizeof(SelfPlayResult));
+	result->verdict = SPRT_CONTINUE;
+	selfplay_updateStats(result, args);
+
+	SelfPlayQueue queue;
+	if (!readOpenings(openingFile, args, &queue.openings)) {
+		return false;
+	}
+
+	result->openings = queue.openings.count;
+	queue.args = args;
+	queue.result = result;
+	queue.next = 0;
+	pthread_mutex_init(&queue.lock, NULL);
+
+	const int32_t threads = MIN(args->threads, MAX(args->games, 1));
+	SelfPlayWorker* workers = ALLOC((size_t) threads, SelfPlayWorker, workers, "Unable to allocate self-play workers.");
+
+	for (int32_t i = 0; i < threads; i++) {
+		SelfPlayWorker* worker = &workers[i];
+		worker->queue = &queue;
+		initializeGamestate(&worker->gameState);
+		hash_createZTable(&worker->zTables[0]);
+		hash_createZTable(&worker->zTables[1]);
+		createSearchResult(&worker->searchResult);
+	}
+
+	const int64_t start = getCurrentTimeMillis();
+
+	if (threads == 1) {
+		runWorker(&workers[0]);
+	} else {
+		for (int32_t i = 0; i < threads; i++) {
+			if (pthread_create(&workers[i].thread, NULL, runWorker, &workers[i]) != 0) {
+				perror("Unable to start self-play worker");
+				exit(EXIT_FAILURE);
+			}
+		}
+
+		for (int32_t i = 0; i < threads; i++) {
+			pthread_join(workers[i].thread, NULL);
+		}
+	}
+
+	result->elapsedMillis = getCurrentTimeMillis() - start;
+
+	for (int32_t i = 0; i < threads; i++) {
+		destroySearchResult(&workers[i].searchResult);
+		destroyGamestate(&workers[i].gameState);
+		hash_destroyZTable(&workers[i].zTables[0]);
+		hash_destroyZTable(&workers[i].zTables[1]);
+	}
+
+	pthread_mutex_destroy(&queue.lock);
+	free(workers);
+	free(queue.openings.fens);
+
+	return true;
+}
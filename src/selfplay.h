@@ -0,0 +1,91 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef SELFPLAY_H
+#define SELFPLAY_H
+
+#include <stdbool.h>
+#include <inttypes.h>
+
+#define SELFPLAY_MAX_THREADS 256
+
+// Games still running after this many plies are adjudicated as draws.
+#define SELFPLAY_MAX_PLIES 400
+
+// Plies played from a binary book to make each opening.
+#define SELFPLAY_DEFAULT_BOOK_PLIES 8
+
+#define SPRT_CONTINUE   0
+#define SPRT_ACCEPT_H0  1   // The engine under test is no more than elo0 stronger; reject the change.
+#define SPRT_ACCEPT_H1  2   // The engine under test is at least elo1 stronger; accept the change.
+
+// One side of a match.
+typedef struct {
+	int32_t depth;              // Maximum search depth.
+	int64_t baseMillis;         // Starting clock.
+	int64_t incrementMillis;    // Added to the clock after each move.
+} EngineConfig;
+
+// Options for a self-play match. Games are played in pairs from the same opening with
+// colors reversed.
+typedef struct {
+	EngineConfig engines[2];    // The engine under test, then the baseline.
+	int32_t games;              // Maximum number of games; the match ends early on an SPRT verdict.
+	int32_t threads;            // Games played at once, each with its own GameState and tables.
+	int32_t bookPlies;          // Plies to play from a binary book for each opening.
+	uint64_t seed;              // Seeds the book openings; the same seed gives the same openings.
+	double elo0;                // The SPRT null hypothesis, in Elo.
+	double elo1;                // The SPRT alternative hypothesis, in Elo.
+	double alpha;               // False positive rate.
+	double beta;                // False negative rate.
+} SelfPlayArgs;
+
+// Match totals, from the first engine's point of view.
+typedef struct {
+	int32_t games;
+	int32_t wins;
+	int32_t draws;
+	int32_t losses;
+	int32_t timeLosses;         // Games lost on time, by either engine.
+	int32_t openings;           // Distinct openings available.
+	int64_t plies;
+	double elo;
+	double eloError;            // Half the width of the 95% confidence interval.
+	double llr;                 // The SPRT log-likelihood ratio and its bounds.
+	double lowerBound;
+	double upperBound;
+	int32_t verdict;            // SPRT_CONTINUE, SPRT_ACCEPT_H0 or SPRT_ACCEPT_H1.
+	int64_t elapsedMillis;
+} SelfPlayResult;
+
+// Plays the two engines against each other, with openings taken from an EPD or FEN file,
+// a packed position file or a binary book. Writes a progress line to stderr after every
+// game. Returns false if no openings could be read.
+bool selfplay_run(const char* openingFile, SelfPlayArgs* args, SelfPlayResult* result);
+
+// A short description of an SPRT verdict.
+const char* selfplay_verdictString(int32_t verdict);
+
+// Updates the Elo estimate and SPRT state of a result from its win, draw and loss counts.
+void selfplay_updateStats(SelfPlayResult* result, SelfPlayArgs* args);
+
+#endif
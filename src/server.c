@@ -0,0 +1,555 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <limits.h>
+
+#include "tulip.h"
+#include "server.h"
+#include "gamestate.h"
+#include "fen.h"
+#include "json.h"
+#include "move.h"
+#include "movegen.h"
+#include "makemove.h"
+#include "notation.h"
+#include "attack.h"
+#include "eval.h"
+#include "hash.h"
+#include "pawns.h"
+#include "material.h"
+#include "book.h"
+#include "result.h"
+#include "search.h"
+#include "util.h"
+
+#define SERVER_LINE_LEN (64 * 1024)
+#define SERVER_FIELD_LEN 256
+// Each played move takes a StateData entry; leave room for the moves that
+// notation_matchMove() and the status checks make and unmake on top of them.
+#define SERVER_MAX_MOVES (_GS_STACK_SIZE - 8)
+#define SERVER_MOVE_LEN 16
+#define SERVER_DEFAULT_SEARCH_DEPTH 7
+
+typedef struct {
+	GameState gameState;
+	MoveBuffer moveBuffer;
+	SearchResult searchResult;
+	char** moves;           // Token buffer for the "moves" array of a request.
+	HashSeqItem* hashSequence;
+	OpenBook book;
+	bool bookOpen;
+	char bookFile[SERVER_FIELD_LEN];
+	char fen[SERVER_FIELD_LEN];
+} ServerState;
+
+// A deliberately small reader for flat request objects: string, integer and
+// string-array values are supported; anything else is skipped.
+static const char* skipSpace(const char* p) {
+	while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') {
+		p++;
+	}
+
+	return p;
+}
+
+// Reads the string starting at the opening quote. Writes up to size - 1 characters to out
+// (which may be NULL to just skip it). Returns the character after the closing quote, or NULL.
+static const char* readString(const char* p, char* out, size_t size) {
+	size_t len = 0;
+
+	if (*p != '"') {
+		return NULL;
+	}
+
+	for (p++; *p != '"'; p++) {
+		char c = *p;
+		if (c == '\0') {
+			return NULL;
+		}
+
+		if (c == '\\') {
+			p++;
+			switch (*p) {
+			case '"':
+			case '\\':
+			case '/':
+				c = *p;
+				break;
+			case 'n':
+				c = '\n';
+				break;
+			case 't':
+				c = '\t';
+				break;
+			default:
+				return NULL;
+			}
+		}
+
+		if (out) {
+			if (len + 1 >= size) {
+				return NULL;
+			}
+
+			out[len++] = c;
+		}
+	}
+
+	if (out) {
+		out[len] = '\0';
+	}
+
+	return p + 1;
+}
+
+static const char* skipValue(const char* p) {
+	p = skipSpace(p);
+
+	if (*p == '"') {
+		return readString(p, NULL, 0);
+	}
+
+	if (*p == '[' || *p == '{') {
+		int32_t nesting = 0;
+		while (*p) {
+			if (*p == '"') {
+				p = readString(p, NULL, 0);
+				if (!p) {
+					return NULL;
+				}
+				continue;
+			}
+
+			if (*p == '[' || *p == '{') {
+				nesting++;
+			} else if (*p == ']' || *p == '}') {
+				if (--nesting == 0) {
+					return p + 1;
+				}
+			}
+
+			p++;
+		}
+
+		return NULL;
+	}
+
+	// Numbers and the literals true, false and null.
+	const char* start = p;
+	while (*p && *p != ',' && *p != '}' && *p != ']' && *p != ' ' && *p != '\t') {
+		p++;
+	}
+
+	return p == start ? NULL : p;
+}
+
+// Finds the value for a top-level key of the request object, or NULL if it's absent.
+static const char* findValue(const char* json, const char* key) {
+	char name[SERVER_FIELD_LEN];
+	const char* p = skipSpace(json);
+
+	if (*p++ != '{') {
+		return NULL;
+	}
+
+	while (true) {
+		p = skipSpace(p);
+		if (*p != '"' || !(p = readString(p, name, sizeof(name)))) {
+			return NULL;
+		}
+
+		p = skipSpace(p);
+		if (*p++ != ':') {
+			return NULL;
+		}
+
+		p = skipSpace(p);
+		if (strcmp(name, key) == 0) {
+			return p;
+		}
+
+		if (!(p = skipValue(p))) {
+			return NULL;
+		}
+
+		p = skipSpace(p);
+		if (*p++ != ',') {
+			return NULL;
+		}
+	}
+}
+
+static bool getString(const char* json, const char* key, char* out, size_t size) {
+	const char* value = findValue(json, key);
+	return value && readString(value, out, size);
+}
+
+static bool getInteger(const char* json, const char* key, int32_t* out) {
+	const char* value = findValue(json, key);
+	if (!value) {
+		return false;
+	}
+
+	char* end;
+	errno = 0;
+	const long parsed = strtol(value, &end, 10);
+	if (end == value || errno != 0 || parsed < INT_MIN || parsed > INT_MAX) {
+		return false;
+	}
+
+	*out = (int32_t) parsed;
+	return true;
+}
+
+// Reads an array of strings into a token buffer. A missing key is an empty list.
+// Returns the number of strings read, -1 if the value is malformed, or -2 if it has
+// more than maxCount strings.
+static int32_t getStringArray(const char* json, const char* key, char** out, int32_t maxCount, size_t size) {
+	const char* p = findValue(json, key);
+	int32_t count = 0;
+
+	if (!p) {
+		return 0;
+	}
+
+	if (*p++ != '[') {
+		return -1;
+	}
+
+	p = skipSpace(p);
+	if (*p == ']') {
+		return 0;
+	}
+
+	while (true) {
+		if (count >= maxCount) {
+			return -2;
+		}
+
+		if (!(p = readString(skipSpace(p), out[count++], size))) {
+			return -1;
+		}
+
+		p = skipSpace(p);
+		if (*p == ']') {
+			return count;
+		}
+
+		if (*p++ != ',') {
+			return -1;
+		}
+	}
+}
+
+// Loads the request's "fen" field into the shared GameState, reporting an error if it can't.
+static bool loadPosition(ServerState* server, const char* request) {
+	if (!getString(request, "fen", server->fen, sizeof(server->fen))) {
+		printServerError("Missing or invalid \"fen\" field.");
+		return false;
+	}
+
+	if (!parseFenWithPrint(&server->gameState, server->fen, false)) {
+		printServerError("Unable to parse FEN.");
+		return false;
+	}
+
+	return true;
+}
+
+// Plays the request's "moves" array from the loaded position. Returns the number of moves played,
+// or -1 (after reporting an error) if the list is malformed or a move can't be played.
+static int32_t playMoves(ServerState* server, const char* request, bool recordHashes) {
+	Move m;
+	const int32_t count = getStringArray(request, "moves", server->moves, SERVER_MAX_MOVES, SERVER_MOVE_LEN);
+	if (count == -2) {
+		printServerError("Too many moves.");
+		return -1;
+	} else if (count < 0) {
+		printServerError("Invalid \"moves\" field.");
+		return -1;
+	}
+
+	for (int32_t i = 0; i < count; i++) {
+		if (!notation_matchMove(server->moves[i], &server->gameState, &m)) {
+			printServerError("Unplayable move.");
+			return -1;
+		}
+
+		makeMove(&server->gameState, &m);
+
+		if (recordHashes) {
+			notation_printMoveCoordinate(&m, server->hashSequence[i].move);
+			server->hashSequence[i].hash = book_bookHash(&server->gameState);
+		}
+	}
+
+	return count;
+}
+
+static void serverListMoves(ServerState* server, const char* request) {
+	char mode[SERVER_FIELD_LEN] = "legal";
+	if (findValue(request, "type") && !getString(request, "type", mode, sizeof(mode))) {
+		printServerError("Invalid \"type\" field.");
+		return;
+	}
+
+	if (!loadPosition(server, request)) {
+		return;
+	}
+
+	if (0 == strcmp("pseudo", mode)) {
+		generatePseudoMoves(&server->gameState, &server->moveBuffer);
+	} else if (0 == strcmp("legal", mode)) {
+		generateLegalMoves(&server->gameState, &server->moveBuffer);
+	} else {
+		printServerError("Move list type must be \"legal\" or \"pseudo\".");
+		return;
+	}
+
+	printMovelistJson(server->fen, mode, &server->gameState, &server->moveBuffer);
+}
+
+static void serverMakeMove(ServerState* server, const char* request) {
+	char moveStr[SERVER_MOVE_LEN];
+	Move m;
+
+	if (!getString(request, "move", moveStr, sizeof(moveStr))) {
+		printServerError("Missing or invalid \"move\" field.");
+		return;
+	}
+
+	if (!loadPosition(server, request)) {
+		return;
+	}
+
+	if (!notation_matchMove(moveStr, &server->gameState, &m)) {
+		printServerError("Unknown move.");
+		return;
+	}
+
+	makeMove(&server->gameState, &m);
+	printMakeMoveResult(server->fen, &m, &server->gameState);
+}
+
+static void serverEvaluate(ServerState* server, const char* request) {
+	if (!loadPosition(server, request)) {
+		return;
+	}
+
+	const int32_t mult = server->gameState.current->toMove == COLOR_WHITE ? 1 : -1;
+	printEvaluation(server->fen, mult * evaluate(&server->gameState));
+}
+
+// Empties the tables a search leaves behind, so that each request's result doesn't
+// depend on the requests that came before it.
+static void clearSearchTables(ServerState* server) {
+	GameState* state = &server->gameState;
+	if (state->zTable) {
+		hash_clearZTable(state->zTable);
+	}
+
+	pawns_clearTable(&state->pawnTable);
+	material_clearTable(&state->materialTable);
+}
+
+static void serverSearch(ServerState* server, const char* request) {
+	int32_t depth = SERVER_DEFAULT_SEARCH_DEPTH;
+	if (findValue(request, "depth") && !getInteger(request, "depth", &depth)) {
+		printServerError("Invalid \"depth\" field.");
+		return;
+	}
+
+	if (depth < 1) {
+		printServerError("Depth must be positive.");
+		return;
+	}
+
+	if (!loadPosition(server, request)) {
+		return;
+	}
+
+	SearchArgs args;
+	initSearchArgs(&args);
+	args.depth = depth;
+
+	clearSearchTables(server);
+	search(&server->gameState, &args, &server->searchResult);
+	printSearchResult(&server->searchResult, &server->gameState);
+	printf("\n");
+}
+
+static void serverPerft(ServerState* server, const char* request) {
+	int32_t depth;
+	// Depth 0 is the position itself: perft() returns 1 without generating or making a move.
+	if (!getInteger(request, "depth", &depth) || depth < 0 || depth > MAX_MOVE_BUFFER) {
+		printServerError("Missing or invalid \"depth\" field.");
+		return;
+	}
+
+	if (!loadPosition(server, request)) {
+		return;
+	}
+
+	prepareForSearch(&server->gameState);
+
+	const int64_t start = getMonotonicTimeNanos();
+	const int64_t nodes = perft(&server->gameState, server->gameState.moveBuffers, depth);
+	printPerftResult(server->fen, depth, nodes, getMonotonicTimeNanos() - start);
+}
+
+static void serverBookMoves(ServerState* server, const char* request) {
+	char bookFile[SERVER_FIELD_LEN];
+	if (!getString(request, "book", bookFile, sizeof(bookFile))) {
+		printServerError("Missing or invalid \"book\" field.");
+		return;
+	}
+
+	if (!loadPosition(server, request)) {
+		return;
+	}
+
+	// Keep the most recently used book open; tooling usually asks the same book many times.
+	if (!server->bookOpen || strcmp(bookFile, server->bookFile) != 0) {
+		if (server->bookOpen) {
+			book_close(&server->book);
+		}
+
+		strcpy(server->bookFile, bookFile);
+		server->bookOpen = book_open(server->bookFile, &server->book);
+	}
+
+	server->moveBuffer.length = 0;
+	if (server->bookOpen) {
+		book_getMoves(&server->gameState, &server->moveBuffer, &server->book);
+	}
+
+	printMovelistJson(server->fen, "legal", &server->gameState, &server->moveBuffer);
+}
+
+static void serverGameStatus(ServerState* server, const char* request) {
+	if (!loadPosition(server, request) || playMoves(server, request, false) < 0) {
+		return;
+	}
+
+	printGameStatus(server->fen, getResult(&server->gameState));
+}
+
+static void serverCheckStatus(ServerState* server, const char* request) {
+	if (!loadPosition(server, request)) {
+		return;
+	}
+
+	printCheckStatus(server->fen, isCheck(&server->gameState));
+}
+
+static void serverBookLine(ServerState* server, const char* request) {
+	if (!loadPosition(server, request)) {
+		return;
+	}
+
+	const uint64_t initialHash = book_bookHash(&server->gameState);
+	const int32_t count = playMoves(server, request, true);
+	if (count < 0) {
+		return;
+	}
+
+	printHashSequence(server->hashSequence, count, initialHash);
+}
+
+// Handles one request line. Returns false once the client asks the server to quit.
+static bool handleRequest(ServerState* server, const char* request) {
+	char cmd[SERVER_FIELD_LEN];
+
+	if (!getString(request, "cmd", cmd, sizeof(cmd))) {
+		printServerError("Request must be a JSON object with a \"cmd\" field.");
+	} else if (0 == strcmp("quit", cmd)) {
+		return false;
+	} else if (0 == strcmp("listmoves", cmd)) {
+		serverListMoves(server, request);
+	} else if (0 == strcmp("makemove", cmd)) {
+		serverMakeMove(server, request);
+	} else if (0 == strcmp("eval", cmd)) {
+		serverEvaluate(server, request);
+	} else if (0 == strcmp("search", cmd)) {
+		serverSearch(server, request);
+	} else if (0 == strcmp("perft", cmd)) {
+		serverPerft(server, request);
+	} else if (0 == strcmp("bookmoves", cmd)) {
+		serverBookMoves(server, request);
+	} else if (0 == strcmp("gamestatus", cmd)) {
+		serverGameStatus(server, request);
+	} else if (0 == strcmp("checkstatus", cmd)) {
+		serverCheckStatus(server, request);
+	} else if (0 == strcmp("bookline", cmd)) {
+		serverBookLine(server, request);
+	} else {
+		printServerError("Unknown command.");
+	}
+
+	return true;
+}
+
+bool startServer(void) {
+	ServerState server;
+	char* line = ALLOC(SERVER_LINE_LEN, char, line, "Unable to allocate server input buffer.");
+
+	initializeGamestate(&server.gameState);
+	createMoveBuffer(&server.moveBuffer);
+	createSearchResult(&server.searchResult);
+	server.moves = createTokenBuffer(SERVER_MAX_MOVES, SERVER_MOVE_LEN);
+	server.hashSequence = ALLOC(SERVER_MAX_MOVES, HashSeqItem, server.hashSequence, "Unable to allocate hash sequence.");
+	server.bookOpen = false;
+
+	bool done = false;
+	while (!done && fgets(line, SERVER_LINE_LEN, stdin)) {
+		const size_t len = strlen(line);
+
+		if (len > 0 && line[len - 1] != '\n' && !feof(stdin)) {
+			// Discard the rest of an overlong line so the next request starts clean.
+			int c;
+			while ((c = getchar()) != '\n' && c != EOF);
+			printServerError("Request line too long.");
+		} else if (*skipSpace(line) != '\0') {
+			done = !handleRequest(&server, line);
+		}
+
+		fflush(stdout);
+	}
+
+	if (server.bookOpen) {
+		book_close(&server.book);
+	}
+
+	free(server.hashSequence);
+	freeTokenBuffer(server.moves, SERVER_MAX_MOVES);
+	destroySearchResult(&server.searchResult);
+	destroyMoveBuffer(&server.moveBuffer);
+	destroyGamestate(&server.gameState);
+	free(line);
+
+	return true;
+}
@@ -0,0 +1,92 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <math.h>
+
+#include "tulip.h"
+#include "sprt.h"
+
+// Scores are clamped this far from 0 and 1 so a one-sided match still has a finite Elo.
+#define SPRT_MIN_SCORE 0.001
+
+// The two-sided 95% quantile of the normal distribution.
+#define SPRT_Z95 1.959964
+
+static double eloFromScore(double score) {
+	score = MIN(MAX(score, SPRT_MIN_SCORE), 1.0 - SPRT_MIN_SCORE);
+	return 400.0 * log10(score / (1.0 - score));
+}
+
+static double scoreFromElo(double elo) {
+	return 1.0 / (1.0 + pow(10.0, -elo / 400.0));
+}
+
+// The mean score per game and its variance.
+static void scoreStats(int32_t wins, int32_t draws, int32_t losses, double* score, double* variance) {
+	const double n = (double) (wins + draws + losses);
+	const double w = (double) wins / n;
+	const double d = (double) draws / n;
+	const double l = (double) losses / n;
+
+	*score = w + d / 2.0;
+	*variance = w * (1.0 - *score) * (1.0 - *score) + d * (0.5 - *score) * (0.5 - *score) + l * *score * *score;
+}
+
+double sprt_elo(int32_t wins, int32_t draws, int32_t losses, double* error) {
+	const int32_t games = wins + draws + losses;
+	*error = 0.0;
+	if (games == 0) {
+		return 0.0;
+	}
+
+	double score;
+	double variance;
+	scoreStats(wins, draws, losses, &score, &variance);
+
+	const double deviation = SPRT_Z95 * sqrt(variance / (double) games);
+	*error = (eloFromScore(score + deviation) - eloFromScore(score - deviation)) / 2.0;
+	return eloFromScore(score);
+}
+
+double sprt_llr(int32_t wins, int32_t draws, int32_t losses, double elo0, double elo1) {
+	const int32_t games = wins + draws + losses;
+	if (games == 0) {
+		return 0.0;
+	}
+
+	double score;
+	double variance;
+	scoreStats(wins, draws, losses, &score, &variance);
+
+	if (variance <= 0.0) {
+		return 0.0;
+	}
+
+	const double s0 = scoreFromElo(elo0);
+	const double s1 = scoreFromElo(elo1);
+	return (double) games * (s1 - s0) * (2.0 * score - s0 - s1) / (2.0 * variance);
+}
+
+void sprt_bounds(double alpha, double beta, double* lower, double* upper) {
+	*lower = log(beta / (1.0 - alpha));
+	*upper = log((1.0 - beta) / alpha);
+}
@@ -0,0 +1,44 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef SPRT_H
+#define SPRT_H
+
+#include <inttypes.h>
+
+// Match statistics from win, draw and loss counts. These use the normal approximation
+// of the trinomial distribution of game results, which is accurate once a match has
+// more than a few dozen games.
+
+// The Elo difference implied by the results; error is set to half the width of its 95%
+// confidence interval. Lopsided results are clamped to a finite Elo.
+double sprt_elo(int32_t wins, int32_t draws, int32_t losses, double* error);
+
+// The log-likelihood ratio of the hypothesis that the Elo difference is elo1 against
+// the hypothesis that it is elo0. It is 0 while the results have no spread.
+double sprt_llr(int32_t wins, int32_t draws, int32_t losses, double elo0, double elo1);
+
+// The LLR bounds for the given false positive (alpha) and false negative (beta) rates:
+// the test accepts elo0 at or below lower and elo1 at or above upper.
+void sprt_bounds(double alpha, double beta, double* lower, double* upper);
+
+#endif
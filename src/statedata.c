@@ -40,6 +40,10 @@ void createStateData(StateData * data) {
         data->halfMoveCount = 0;
         data->whitePieceCount = 0;
         data->blackPieceCount = 0;
+        data->mgScore = 0;
+        data->egScore = 0;
+        data->materialKey = 0;
+        data->pawnHash = 0;
 }
 
 void copyStateData(StateData* from, StateData* to) {
@@ -56,6 +56,10 @@ typedef struct {
         int32_t halfMoveCount;      // The half move count. This increments by one after every move.
         int32_t whitePieceCount;    // The current white piece count.
         int32_t blackPieceCount;    // The current black piece count.
+        int32_t mgScore;            // Running middlegame material + piece-square score, white positive.
+        int32_t egScore;            // Running endgame material + piece-square score, white positive.
+        uint64_t pawnHash;          // Zobrist hash of the pawns alone, used to key the pawn structure table.
+        uint64_t materialKey;       // Packed count of each piece type, used to key the material table.
 } StateData;
 
 // Allocate memory for an new state data object.
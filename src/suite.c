@@ -0,0 +1,272 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "tulip.h"
+#include "suite.h"
+#include "epd.h"
+#include "gamestate.h"
+#include "fen.h"
+#include "hash.h"
+#include "json.h"
+#include "notation.h"
+#include "search.h"
+#include "util.h"
+#include "ztable.h"
+
+#define SUITE_LINE_LEN 1024
+
+typedef struct {
+	SuiteArgs* args;
+	SuiteItem* items;
+	int32_t count;
+	int32_t next;           // Index of the next unclaimed item, guarded by lock.
+	pthread_mutex_t lock;
+} SuiteQueue;
+
+typedef struct {
+	pthread_t thread;
+	SuiteQueue* queue;
+	GameState gameState;
+	ZTable zTable;
+	SearchResult searchResult;
+	Move bestMoves[EPD_MAX_MOVES];
+	int32_t bestMoveCount;
+	Move avoidMoves[EPD_MAX_MOVES];
+	int32_t avoidMoveCount;
+	int64_t solvedSince;    // Elapsed time when the current run of solving best moves began, or -1.
+} SuiteWorker;
+
+static bool sameMove(const Move* a, const Move* b) {
+	return a->from == b->from && a->to == b->to && a->moveCode == b->moveCode;
+}
+
+static bool containsMove(const Move* moves, int32_t count, const Move* m) {
+	for (int32_t i = 0; i < count; i++) {
+		if (sameMove(&moves[i], m)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static bool isSolution(SuiteWorker* worker, const Move* m) {
+	if (worker->bestMoveCount > 0 && !containsMove(worker->bestMoves, worker->bestMoveCount, m)) {
+		return false;
+	}
+
+	return !containsMove(worker->avoidMoves, worker->avoidMoveCount, m);
+}
+
+static void trackSolution(void* callbackState, int32_t depth, int32_t score, int64_t elapsedMs, Move* move) {
+	SuiteWorker* worker = (SuiteWorker*) callbackState;
+
+	if (!isSolution(worker, move)) {
+		worker->solvedSince = -1;
+	} else if (worker->solvedSince < 0) {
+		worker->solvedSince = elapsedMs;
+	}
+}
+
+// Resolves the record's SAN moves against the position. Returns false if any don't match a legal move.
+static bool matchMoves(GameState* state, char moveStrs[][EPD_MOVE_LEN], int32_t count, Move* moves) {
+	for (int32_t i = 0; i < count; i++) {
+		if (!notation_matchMove(moveStrs[i], state, &moves[i])) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void searchItem(SuiteWorker* worker, SuiteItem* item) {
+	GameState* state = &worker->gameState;
+	EpdRecord* record = &item->record;
+	SuiteArgs* suiteArgs = worker->queue->args;
+
+	item->valid = parseFenWithPrint(state, record->fen, false)
+	              && (record->bestMoveCount > 0 || record->avoidMoveCount > 0)
+	              && matchMoves(state, record->bestMoves, record->bestMoveCount, worker->bestMoves)
+	              && matchMoves(state, record->avoidMoves, record->avoidMoveCount, worker->avoidMoves);
+
+	if (!item->valid) {
+		return;
+	}
+
+	worker->bestMoveCount = record->bestMoveCount;
+	worker->avoidMoveCount = record->avoidMoveCount;
+	worker->solvedSince = -1;
+
+	SearchArgs args;
+	initSearchArgs(&args);
+	args.depth = suiteArgs->depth;
+	args.timeToThinkMillis = suiteArgs->moveTimeMillis;
+	args.onBestMove = trackSolution;
+	args.callbackState = worker;
+
+	hash_clearZTable(&worker->zTable);
+	search(state, &args, &worker->searchResult);
+
+	SearchResult* result = &worker->searchResult;
+	item->nodes = result->nodes;
+	item->elapsedMillis = result->durationMs;
+
+	if (result->searchStatus == SEARCH_STATUS_NONE) {
+		notation_printShortAlg(&result->move, state, item->move);
+		item->score = result->score;
+		item->solved = isSolution(worker, &result->move);
+		item->solveTimeMillis = item->solved ? MAX(worker->solvedSince, 0) : -1;
+	} else {
+		item->valid = false;
+	}
+}
+
+static void* runWorker(void* arg) {
+	SuiteWorker* worker = (SuiteWorker*) arg;
+	SuiteQueue* queue = worker->queue;
+
+	while (true) {
+		pthread_mutex_lock(&queue->lock);
+		const int32_t index = queue->next < queue->count ? queue->next++ : -1;
+		pthread_mutex_unlock(&queue->lock);
+
+		if (index < 0) {
+			break;
+		}
+
+		searchItem(worker, &queue->items[index]);
+	}
+
+	return NULL;
+}
+
+// Reads every record of the suite. Returns the item array (and its length in count), or NULL.
+static SuiteItem* readSuite(const char* fileName, int32_t* count) {
+	char line[SUITE_LINE_LEN];
+	FILE* file = fopen(fileName, "r");
+	if (!file) {
+		perror("Unable to open EPD file");
+		return NULL;
+	}
+
+	int32_t capacity = 64;
+	int64_t lineNumber = 0;
+	SuiteItem* items = ALLOC((size_t) capacity, SuiteItem, items, "Unable to allocate suite items.");
+	*count = 0;
+
+	while (fgets(line, SUITE_LINE_LEN, file)) {
+		lineNumber++;
+
+		const char* p = line;
+		while (*p == ' ' || *p == '\t') {
+			p++;
+		}
+
+		if (*p == '\0' || *p == '\n' || *p == '\r' || *p == '#') {
+			continue;
+		}
+
+		if (*count == capacity) {
+			capacity *= 2;
+			items = realloc(items, (size_t) capacity * sizeof(SuiteItem));
+			if (!items) {
+				perror("Unable to grow suite items.");
+				exit(EXIT_FAILURE);
+			}
+		}
+
+		SuiteItem* item = &items[(*count)++];
+		memset(item, 0, sizeof(SuiteItem));
+		item->lineNumber = lineNumber;
+		item->solveTimeMillis = -1;
+
+		if (!epd_parse(line, &item->record)) {
+			item->record.fen[0] = '\0';
+		}
+	}
+
+	fclose(file);
+	return items;
+}
+
+bool suite_run(const char* fileName, SuiteArgs* args) {
+	int32_t count;
+	SuiteItem* items = readSuite(fileName, &count);
+	if (!items) {
+		return false;
+	}
+
+	const int32_t threads = MIN(args->threads, MAX(count, 1));
+	SuiteWorker* workers = ALLOC((size_t) threads, SuiteWorker, workers, "Unable to allocate suite workers.");
+	SuiteQueue queue;
+	queue.args = args;
+	queue.items = items;
+	queue.count = count;
+	queue.next = 0;
+	pthread_mutex_init(&queue.lock, NULL);
+
+	for (int32_t i = 0; i < threads; i++) {
+		SuiteWorker* worker = &workers[i];
+		worker->queue = &queue;
+		initializeGamestate(&worker->gameState);
+		hash_createZTable(&worker->zTable);
+		worker->gameState.zTable = &worker->zTable;
+		createSearchResult(&worker->searchResult);
+	}
+
+	const int64_t start = getCurrentTimeMillis();
+
+	if (threads == 1) {
+		runWorker(&workers[0]);
+	} else {
+		for (int32_t i = 0; i < threads; i++) {
+			if (pthread_create(&workers[i].thread, NULL, runWorker, &workers[i]) != 0) {
+				perror("Unable to start suite worker");
+				exit(EXIT_FAILURE);
+			}
+		}
+
+		for (int32_t i = 0; i < threads; i++) {
+			pthread_join(workers[i].thread, NULL);
+		}
+	}
+
+	printSuiteReport(items, count, args->moveTimeMillis, getCurrentTimeMillis() - start);
+
+	for (int32_t i = 0; i < threads; i++) {
+		destroySearchResult(&workers[i].searchResult);
+		destroyGamestate(&workers[i].gameState);
+		hash_destroyZTable(&workers[i].zTable);
+	}
+
+	pthread_mutex_destroy(&queue.lock);
+	free(workers);
+	free(items);
+
+	return true;
+}
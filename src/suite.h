@@ -0,0 +1,56 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef SUITE_H
+#define SUITE_H
+
+#include <stdbool.h>
+#include <inttypes.h>
+
+#include "epd.h"
+
+// Options for an EPD test-suite run.
+typedef struct {
+	int64_t moveTimeMillis;     // Think time per position.
+	int32_t depth;              // Maximum search depth per position.
+	int32_t threads;            // Positions searched in parallel, each with its own GameState and table.
+} SuiteArgs;
+
+// The outcome of one suite position.
+typedef struct {
+	int64_t lineNumber;
+	EpdRecord record;
+	bool valid;                 // False if the position or its bm/am moves couldn't be read.
+	bool solved;                // The final move is a bm move (if any) and not an am move (if any).
+	int64_t solveTimeMillis;    // When the search settled on a solving move for good; -1 if unsolved.
+	int64_t elapsedMillis;
+	int64_t nodes;
+	int32_t score;
+	char move[16];              // The move played, in SAN.
+} SuiteItem;
+
+// Searches every position in an EPD file and prints a JSON report of which were solved,
+// the time to solution of each and the aggregate node rate. Returns false if the file
+// can't be read.
+bool suite_run(const char* fileName, SuiteArgs* args);
+
+#endif
@@ -51,6 +51,19 @@
 #include "interactive.h"
 #include "env.h"
 #include "hash.h"
+#include "pawns.h"
+#include "server.h"
+#include "batch.h"
+#include "suite.h"
+#include "bench.h"
+#include "bookbuild.h"
+#include "pgnindex.h"
+#include "gamefile.h"
+#include "packedpos.h"
+#include "selfplay.h"
+#include "gendata.h"
+#include "tune.h"
+#include "evalparams.h"
 
 static void printBanner() {
     printf("Tulip Chess Engine 0.001\n");
@@ -88,6 +101,16 @@ static const char* findArg(int argc, char** argv, const char* argName) {
     return result;
 }
 
+static bool hasFlag(int argc, char** argv, const char* flagName) {
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], flagName) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 static GameState parseFenOrQuit(char* str) {
     GameState gs;
     initializeGamestate(&gs);
@@ -126,17 +149,14 @@ static void checkPassedPawn(int argc, char** argv) {
     int blackPassedPawns[8];
     int blackCount = 0;
 
+    const PawnEntry* pawns = pawns_probe(&gs);
+
     for (int32_t sqIdx = 0; sqIdx < 64; sqIdx++) {
         const int32_t sq = BOARD_SQUARES[sqIdx];
-        const Piece* p = gs.board[sq];
-        if (p == &WPAWN) {
-            if ((BITS_PASSED_PAWN_W[sq] & gs.bitboards[ORD_BPAWN]) == 0) {
-                whitePassedPawns[whiteCount++] = sq;
-            }
-        } else if (p == &BPAWN) {
-            if ((BITS_PASSED_PAWN_B[sq] & gs.bitboards[ORD_WPAWN]) == 0) {
-                blackPassedPawns[blackCount++] = sq;
-            }
+        if (pawns->wPassed & BITS_SQ[sq]) {
+            whitePassedPawns[whiteCount++] = sq;
+        } else if (pawns->bPassed & BITS_SQ[sq]) {
+            blackPassedPawns[blackCount++] = sq;
         }
     }
 
@@ -239,6 +259,183 @@ static void checkStatus(int argc, char** argv) {
     destroyGamestate(&gs);
 }
 
+static void convertBook(int argc, char** argv) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: -convertbook [SQLite book file] [binary book file]\n");
+        exit(EXIT_FAILURE);
+    }
+
+    const int64_t records = book_convertSqlite(argv[1], argv[2]);
+    if (records < 0) {
+        exit(EXIT_FAILURE);
+    }
+
+    printBookWriteResult(argv[2], records);
+}
+
+static void buildBook(int argc, char** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: -buildbook [PGN file] [binary book file] [-plies N] [-threads T] [-mincount N]\n");
+        exit(EXIT_FAILURE);
+    }
+
+    BookBuildArgs args;
+    BookBuildResult result;
+    args.plies = BOOKBUILD_DEFAULT_PLIES;
+    args.threads = 1;
+    args.minCount = 1;
+
+    const char* pliesStr = findArg(argc, argv, "-plies");
+    const char* threadStr = findArg(argc, argv, "-threads");
+    const char* minCountStr = findArg(argc, argv, "-mincount");
+    if ((pliesStr != NULL && !parseInteger(pliesStr, &args.plies))
+            || (threadStr != NULL && !parseInteger(threadStr, &args.threads))
+            || (minCountStr != NULL && !parseInteger(minCountStr, &args.minCount))) {
+        exit(EXIT_FAILURE);
+    }
+
+    if (args.plies < 1 || args.minCount < 1) {
+        fprintf(stderr, "Plies and minimum count must be positive.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (args.plies > BOOKBUILD_MAX_PLIES) {
+        fprintf(stderr, "Plies must be at most %i.\n", BOOKBUILD_MAX_PLIES);
+        exit(EXIT_FAILURE);
+    }
+
+    if (args.threads < 1 || args.threads > BOOKBUILD_MAX_THREADS) {
+        fprintf(stderr, "Threads must be between 1 and %i.\n", BOOKBUILD_MAX_THREADS);
+        exit(EXIT_FAILURE);
+    }
+
+    if (!bookbuild_run(argv[1], argv[2], &args, &result)) {
+        exit(EXIT_FAILURE);
+    }
+
+    printBookBuildResult(argv[2], &result);
+}
+
+static void indexPgn(int argc, char** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: -indexpgn [PGN file] [index file] [-plies N] [-threads T] [-append]\n");
+        exit(EXIT_FAILURE);
+    }
+
+    PgnIndexArgs args;
+    PgnIndexResult result;
+    args.plies = PGNINDEX_DEFAULT_PLIES;
+    args.threads = 1;
+    args.append = hasFlag(argc, argv, "-append");
+
+    const char* pliesStr = findArg(argc, argv, "-plies");
+    const char* threadStr = findArg(argc, argv, "-threads");
+    if ((pliesStr != NULL && !parseInteger(pliesStr, &args.plies))
+            || (threadStr != NULL && !parseInteger(threadStr, &args.threads))) {
+        exit(EXIT_FAILURE);
+    }
+
+    if (args.plies < 1 || args.plies > PGNINDEX_MAX_PLIES) {
+        fprintf(stderr, "Plies must be between 1 and %i.\n", PGNINDEX_MAX_PLIES);
+        exit(EXIT_FAILURE);
+    }
+
+    if (args.threads < 1 || args.threads > PGNINDEX_MAX_THREADS) {
+        fprintf(stderr, "Threads must be between 1 and %i.\n", PGNINDEX_MAX_THREADS);
+        exit(EXIT_FAILURE);
+    }
+
+    if (!pgnindex_build(argv[1], argv[2], &args, &result)) {
+        exit(EXIT_FAILURE);
+    }
+
+    printIndexBuildResult(argv[2], &result);
+}
+
+static void queryIndex(int argc, char** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: -queryindex [index file] \"[FEN string]\" [-games N]\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int32_t maxGames = 20;
+    const char* gamesStr = findArg(argc, argv, "-games");
+    if (gamesStr != NULL && !parseInteger(gamesStr, &maxGames)) {
+        exit(EXIT_FAILURE);
+    }
+
+    PgnIndex index;
+    if (!pgnindex_open(argv[1], &index)) {
+        fprintf(stderr, "Unable to open index [%s]\n", argv[1]);
+        exit(EXIT_FAILURE);
+    }
+
+    GameState gs = parseFenOrQuit(argv[2]);
+    IndexQueryResult* result = ALLOC(1, IndexQueryResult, result, "Unable to allocate index query result.");
+    pgnindex_query(&index, &gs, MAX(maxGames, 0), result);
+    printIndexQueryResult(argv[2], &gs, result);
+
+    free(result);
+    destroyGamestate(&gs);
+    pgnindex_close(&index);
+}
+
+static void pgnToBinary(int argc, char** argv) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: -pgn2bin [PGN file] [game file]\n");
+        exit(EXIT_FAILURE);
+    }
+
+    GameFileStats stats;
+    if (!gamefile_fromPgn(argv[1], argv[2], &stats)) {
+        exit(EXIT_FAILURE);
+    }
+
+    printGameFileStats(argv[2], &stats);
+}
+
+static void binaryToPgn(int argc, char** argv) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: -bin2pgn [game file] [PGN file]\n");
+        exit(EXIT_FAILURE);
+    }
+
+    GameFileStats stats;
+    if (!gamefile_toPgn(argv[1], argv[2], &stats)) {
+        exit(EXIT_FAILURE);
+    }
+
+    printGameFileStats(argv[2], &stats);
+}
+
+static void fenToPacked(int argc, char** argv) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: -fen2bin [FEN or EPD file] [packed position file]\n");
+        exit(EXIT_FAILURE);
+    }
+
+    PackedFileStats stats;
+    if (!packedpos_fromFen(argv[1], argv[2], &stats)) {
+        exit(EXIT_FAILURE);
+    }
+
+    printPackedFileStats(argv[2], &stats);
+}
+
+static void packedToFen(int argc, char** argv) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: -bin2fen [packed position file] [FEN file]\n");
+        exit(EXIT_FAILURE);
+    }
+
+    PackedFileStats stats;
+    if (!packedpos_toFen(argv[1], argv[2], &stats)) {
+        exit(EXIT_FAILURE);
+    }
+
+    printPackedFileStats(argv[2], &stats);
+}
+
 static void findBookMoves(int argc, char** argv) {
     if (argc != 3) {
         fprintf(stderr, "Usage: -bookmoves [book file] \"[FEN string]\"\n");
@@ -400,8 +597,8 @@ static void simpleSearch(int argc, char** argv) {
         exit(EXIT_FAILURE);
     }
 
-    if (depth < 0) {
-        fprintf(stderr, "Depth must be non-negative.\n");
+    if (depth < 1) {
+        fprintf(stderr, "Depth must be positive.\n");
         exit(EXIT_FAILURE);
     }
 
@@ -443,6 +640,63 @@ static void printMoveOrder(int argc, char** argv) {
     destroyGamestate(&gs);
 }
 
+// A fixed spread of openings, middlegames and endgames for timing evaluate().
+static const char* EVAL_BENCH_FENS[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3",
+    "r1bqkb1r/pppp1ppp/2n2n2/4p2Q/2B1P3/8/PPPP1PPP/RNB1K1NR w KQkq - 4 4",
+    "rnbqkb1r/pp2pppp/3p1n2/8/3NP3/8/PPP2PPP/RNBQKB1R w KQkq - 1 5",
+    "r2q1rk1/ppp2ppp/2np1n2/2b1p1B1/2B1P1b1/2NP1N2/PPP2PPP/R2Q1RK1 w - - 6 8",
+    "r1bq1rk1/pp2bppp/2n1pn2/2pp4/3P4/2PBPN2/PP1N1PPP/R1BQ1RK1 w - - 0 9",
+    "2rq1rk1/pb1nbppp/1p2pn2/2pp4/3P4/1P1BPN2/PBPN1PPP/2RQ1RK1 w - - 4 12",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3r1k1/pp3pbp/1qp3p1/2B5/2BP2b1/Q1n2N2/P4PPP/3R1K1R b - - 0 17",
+    "4rrk1/pp1n3p/3q2pQ/2p1pb2/2PP4/2P3N1/P2B2PP/4RRK1 b - - 7 19",
+    "6k1/5p2/6p1/8/7p/8/6PP/6K1 b - - 0 1",
+    "8/8/8/4k3/8/8/3R4/3K4 w - - 0 1",
+    "8/5pk1/6p1/1p5p/1P2P2P/5KP1/8/8 w - - 0 40",
+    "2r3k1/5pp1/p3p2p/1p1rP3/3N4/P5P1/1P3P1P/2R1R1K1 w - - 0 28",
+};
+
+static void evalBench(int argc, char** argv) {
+    int32_t iterations = 100000;
+    const char* iterStr = findArg(argc, argv, "-iterations");
+    if (iterStr != NULL && !parseInteger(iterStr, &iterations)) {
+        exit(EXIT_FAILURE);
+    }
+
+    if (iterations <= 0) {
+        fprintf(stderr, "Iterations must be positive.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    const int32_t count = (int32_t) (sizeof(EVAL_BENCH_FENS) / sizeof(EVAL_BENCH_FENS[0]));
+    GameState* states = ALLOC((size_t) count, GameState, states, "Unable to allocate eval bench states.");
+    for (int32_t i = 0; i < count; i++) {
+        states[i] = parseFenOrQuit((char*) EVAL_BENCH_FENS[i]);
+    }
+
+    // Sum the scores so the compiler can't discard the calls, and so that a
+    // change in evaluation results shows up between runs.
+    int64_t checksum = 0;
+    const int64_t start = getMonotonicTimeNanos();
+    for (int32_t n = 0; n < iterations; n++) {
+        for (int32_t i = 0; i < count; i++) {
+            checksum += evaluate(&states[i]);
+        }
+    }
+    const int64_t elapsed = getMonotonicTimeNanos() - start;
+
+    printEvalBench(count, (int64_t) iterations * count, elapsed, checksum / iterations);
+
+    for (int32_t i = 0; i < count; i++) {
+        destroyGamestate(&states[i]);
+    }
+    free(states);
+}
+
 static void kingRect(int argc, char** argv) {
     if (argc != 2) {
         fprintf(stderr, "Usage: -kingrect [square]\n");
@@ -469,6 +723,344 @@ static void kingRect(int argc, char** argv) {
     printKingRectSize(argv[1], rectSize);
 }
 
+#define BATCH_MAX_THREADS 256
+
+static void batchRun(int argc, char** argv, int32_t mode) {
+    const bool isSearch = mode == BATCH_SEARCH;
+    if (argc < 2) {
+        if (isSearch) {
+            fprintf(stderr, "Usage: -batch-search [file] -depth N [-threads T]\n");
+        } else {
+            fprintf(stderr, "Usage: -batch-eval [file] [-threads T]\n");
+        }
+        exit(EXIT_FAILURE);
+    }
+
+    BatchArgs args;
+    args.mode = mode;
+    args.depth = 0;
+    args.threads = 1;
+
+    const char* threadStr = findArg(argc, argv, "-threads");
+    if (threadStr != NULL && !parseInteger(threadStr, &args.threads)) {
+        exit(EXIT_FAILURE);
+    }
+
+    if (args.threads < 1 || args.threads > BATCH_MAX_THREADS) {
+        fprintf(stderr, "Threads must be between 1 and %i.\n", BATCH_MAX_THREADS);
+        exit(EXIT_FAILURE);
+    }
+
+    if (isSearch) {
+        const char* depthStr = findArg(argc, argv, "-depth");
+        if (depthStr == NULL) {
+            fprintf(stderr, "Usage: -batch-search [file] -depth N [-threads T]\n");
+            exit(EXIT_FAILURE);
+        }
+
+        if (!parseInteger(depthStr, &args.depth)) {
+            exit(EXIT_FAILURE);
+        }
+
+        if (args.depth < 1) {
+            fprintf(stderr, "Depth must be positive.\n");
+            fprintf(stderr, "Usage: -batch-search [file] -depth N [-threads T]\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (!batch_run(argv[1], &args)) {
+        exit(EXIT_FAILURE);
+    }
+}
+
+static bool parseDouble(const char* str, double* result) {
+    char* endToken = NULL;
+    errno = 0;
+    const double value = strtod(str, &endToken);
+
+    if (errno != 0 || endToken == str || *endToken != '\0') {
+        fprintf(stderr, "Invalid number: %s\n", str);
+        return false;
+    }
+
+    *result = value;
+    return true;
+}
+
+// Parses a time control of the form "base+increment" in seconds, e.g. "10+0.1".
+static bool parseTimeControl(const char* str, EngineConfig* engine) {
+    char* endToken = NULL;
+    errno = 0;
+    const double base = strtod(str, &endToken);
+    double increment = 0.0;
+
+    if (errno == 0 && endToken != str && *endToken == '+') {
+        const char* incStr = endToken + 1;
+        increment = strtod(incStr, &endToken);
+        if (endToken == incStr) {
+            endToken = (char*) str;
+        }
+    }
+
+    if (errno != 0 || endToken == str || *endToken != '\0' || base <= 0.0 || increment < 0.0) {
+        fprintf(stderr, "Invalid time control: %s (expected seconds+increment, e.g. 10+0.1)\n", str);
+        return false;
+    }
+
+    engine->baseMillis = (int64_t) (base * 1000.0);
+    engine->incrementMillis = (int64_t) (increment * 1000.0);
+    return true;
+}
+
+static void selfPlay(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: -selfplay [openings file] [-games N] [-threads T] [-depth D] [-tc S+I] [-depth2 D] [-tc2 S+I]"
+                " [-bookplies N] [-elo0 E] [-elo1 E] [-alpha A] [-beta B] [-seed S]\n");
+        exit(EXIT_FAILURE);
+    }
+
+    SelfPlayArgs args;
+    SelfPlayResult result;
+    int32_t seed = (int32_t) time(NULL);
+    args.games = 100;
+    args.threads = 1;
+    args.bookPlies = SELFPLAY_DEFAULT_BOOK_PLIES;
+    args.elo0 = 0.0;
+    args.elo1 = 5.0;
+    args.alpha = 0.05;
+    args.beta = 0.05;
+    args.engines[0].depth = 10;
+    args.engines[0].baseMillis = 10 * 1000;
+    args.engines[0].incrementMillis = 100;
+
+    const char* gamesStr = findArg(argc, argv, "-games");
+    const char* threadStr = findArg(argc, argv, "-threads");
+    const char* depthStr = findArg(argc, argv, "-depth");
+    const char* tcStr = findArg(argc, argv, "-tc");
+    const char* bookPliesStr = findArg(argc, argv, "-bookplies");
+    const char* seedStr = findArg(argc, argv, "-seed");
+    if ((gamesStr != NULL && !parseInteger(gamesStr, &args.games))
+            || (threadStr != NULL && !parseInteger(threadStr, &args.threads))
+            || (depthStr != NULL && !parseInteger(depthStr, &args.engines[0].depth))
+            || (tcStr != NULL && !parseTimeControl(tcStr, &args.engines[0]))
+            || (bookPliesStr != NULL && !parseInteger(bookPliesStr, &args.bookPlies))
+            || (seedStr != NULL && !parseInteger(seedStr, &seed))) {
+        exit(EXIT_FAILURE);
+    }
+
+    // The second engine plays like the first unless told otherwise.
+    args.engines[1] = args.engines[0];
+    const char* depth2Str = findArg(argc, argv, "-depth2");
+    const char* tc2Str = findArg(argc, argv, "-tc2");
+    if ((depth2Str != NULL && !parseInteger(depth2Str, &args.engines[1].depth))
+            || (tc2Str != NULL && !parseTimeControl(tc2Str, &args.engines[1]))) {
+        exit(EXIT_FAILURE);
+    }
+
+    const char* elo0Str = findArg(argc, argv, "-elo0");
+    const char* elo1Str = findArg(argc, argv, "-elo1");
+    const char* alphaStr = findArg(argc, argv, "-alpha");
+    const char* betaStr = findArg(argc, argv, "-beta");
+    if ((elo0Str != NULL && !parseDouble(elo0Str, &args.elo0))
+            || (elo1Str != NULL && !parseDouble(elo1Str, &args.elo1))
+            || (alphaStr != NULL && !parseDouble(alphaStr, &args.alpha))
+            || (betaStr != NULL && !parseDouble(betaStr, &args.beta))) {
+        exit(EXIT_FAILURE);
+    }
+
+    if (args.games < 1 || args.engines[0].depth < 1 || args.engines[1].depth < 1 || args.bookPlies < 0) {
+        fprintf(stderr, "Games and depths must be positive.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (args.threads < 1 || args.threads > SELFPLAY_MAX_THREADS) {
+        fprintf(stderr, "Threads must be between 1 and %i.\n", SELFPLAY_MAX_THREADS);
+        exit(EXIT_FAILURE);
+    }
+
+    if (args.elo1 <= args.elo0 || args.alpha <= 0.0 || args.alpha >= 1.0 || args.beta <= 0.0 || args.beta >= 1.0) {
+        fprintf(stderr, "Elo1 must be above elo0, and alpha and beta between 0 and 1.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    args.seed = (uint64_t) (uint32_t) seed;
+
+    if (!selfplay_run(argv[1], &args, &result)) {
+        exit(EXIT_FAILURE);
+    }
+
+    printSelfPlayResult(&args, &result);
+}
+
+static void generateData(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: -gendata [output file] [-positions N] [-threads T] [-nodes N] [-depth D]"
+                " [-randomplies N] [-maxnoise CP] [-seed S]\n");
+        exit(EXIT_FAILURE);
+    }
+
+    GenDataArgs args;
+    GenDataResult result;
+    int32_t positions = 100000;
+    int32_t nodes = 5000;
+    int32_t seed = (int32_t) time(NULL);
+    args.threads = 1;
+    args.depth = 10;
+    args.randomPlies = 8;
+    args.maxNoise = 60;
+
+    const char* positionsStr = findArg(argc, argv, "-positions");
+    const char* threadStr = findArg(argc, argv, "-threads");
+    const char* nodesStr = findArg(argc, argv, "-nodes");
+    const char* depthStr = findArg(argc, argv, "-depth");
+    const char* randomPliesStr = findArg(argc, argv, "-randomplies");
+    const char* maxNoiseStr = findArg(argc, argv, "-maxnoise");
+    const char* seedStr = findArg(argc, argv, "-seed");
+    if ((positionsStr != NULL && !parseInteger(positionsStr, &positions))
+            || (threadStr != NULL && !parseInteger(threadStr, &args.threads))
+            || (nodesStr != NULL && !parseInteger(nodesStr, &nodes))
+            || (depthStr != NULL && !parseInteger(depthStr, &args.depth))
+            || (randomPliesStr != NULL && !parseInteger(randomPliesStr, &args.randomPlies))
+            || (maxNoiseStr != NULL && !parseInteger(maxNoiseStr, &args.maxNoise))
+            || (seedStr != NULL && !parseInteger(seedStr, &seed))) {
+        exit(EXIT_FAILURE);
+    }
+
+    if (positions < 1 || nodes < 1 || args.depth < 1 || args.maxNoise < 0) {
+        fprintf(stderr, "Positions, nodes and depth must be positive.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (args.randomPlies < 0 || args.randomPlies > 40) {
+        fprintf(stderr, "Random plies must be between 0 and 40.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (args.threads < 1 || args.threads > GENDATA_MAX_THREADS) {
+        fprintf(stderr, "Threads must be between 1 and %i.\n", GENDATA_MAX_THREADS);
+        exit(EXIT_FAILURE);
+    }
+
+    args.positions = positions;
+    args.nodes = nodes;
+    args.seed = (uint64_t) (uint32_t) seed;
+
+    if (!gendata_run(argv[1], &args, &result)) {
+        exit(EXIT_FAILURE);
+    }
+
+    printGenDataResult(argv[1], &result);
+}
+
+static void tune(int argc, char** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: -tune [data file] [output file] [-threads T] [-epochs N] [-lr R] [-lambda L] [-k K]\n");
+        exit(EXIT_FAILURE);
+    }
+
+    TuneArgs args;
+    TuneResult result;
+    args.threads = 1;
+    args.epochs = 100;
+    args.learningRate = 1.0;
+    args.lambda = 1.0;
+    args.k = 0.0;
+
+    const char* threadStr = findArg(argc, argv, "-threads");
+    const char* epochsStr = findArg(argc, argv, "-epochs");
+    const char* lrStr = findArg(argc, argv, "-lr");
+    const char* lambdaStr = findArg(argc, argv, "-lambda");
+    const char* kStr = findArg(argc, argv, "-k");
+    if ((threadStr != NULL && !parseInteger(threadStr, &args.threads))
+            || (epochsStr != NULL && !parseInteger(epochsStr, &args.epochs))
+            || (lrStr != NULL && !parseDouble(lrStr, &args.learningRate))
+            || (lambdaStr != NULL && !parseDouble(lambdaStr, &args.lambda))
+            || (kStr != NULL && !parseDouble(kStr, &args.k))) {
+        exit(EXIT_FAILURE);
+    }
+
+    if (args.threads < 1 || args.threads > TUNE_MAX_THREADS) {
+        fprintf(stderr, "Threads must be between 1 and %i.\n", TUNE_MAX_THREADS);
+        exit(EXIT_FAILURE);
+    }
+
+    if (args.epochs < 0 || args.learningRate <= 0.0 || args.k < 0.0) {
+        fprintf(stderr, "Epochs, learning rate and K must not be negative.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (args.lambda < 0.0 || args.lambda > 1.0) {
+        fprintf(stderr, "Lambda must be between 0 and 1.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (!tune_run(argv[1], argv[2], &args, &result)) {
+        exit(EXIT_FAILURE);
+    }
+
+    printTuneResult(argv[2], &result);
+}
+
+static void dumpParams(int argc, char** argv) {
+    // Writes to stdout unless a file is given.
+    if (!evalparams_save(argc >= 2 ? argv[1] : NULL, EVAL_PARAMS)) {
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void bench(int argc, char** argv) {
+    int32_t depth = BENCH_DEFAULT_DEPTH;
+    const char* depthStr = findArg(argc, argv, "-depth");
+    if (depthStr != NULL && !parseInteger(depthStr, &depth)) {
+        exit(EXIT_FAILURE);
+    }
+
+    if (depth < 1) {
+        fprintf(stderr, "Depth must be positive.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    bench_run(depth);
+}
+
+static void epdSuite(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: -epdsuite [file] [-movetime ms] [-depth N] [-threads T]\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int32_t moveTime = 1000;
+    SuiteArgs args;
+    args.depth = 10;
+    args.threads = 1;
+
+    const char* moveTimeStr = findArg(argc, argv, "-movetime");
+    const char* depthStr = findArg(argc, argv, "-depth");
+    const char* threadStr = findArg(argc, argv, "-threads");
+    if ((moveTimeStr != NULL && !parseInteger(moveTimeStr, &moveTime))
+            || (depthStr != NULL && !parseInteger(depthStr, &args.depth))
+            || (threadStr != NULL && !parseInteger(threadStr, &args.threads))) {
+        exit(EXIT_FAILURE);
+    }
+
+    if (moveTime <= 0 || args.depth < 1) {
+        fprintf(stderr, "Move time and depth must be positive.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (args.threads < 1 || args.threads > BATCH_MAX_THREADS) {
+        fprintf(stderr, "Threads must be between 1 and %i.\n", BATCH_MAX_THREADS);
+        exit(EXIT_FAILURE);
+    }
+
+    args.moveTimeMillis = moveTime;
+
+    if (!suite_run(argv[1], &args)) {
+        exit(EXIT_FAILURE);
+    }
+}
+
 int main(int argc, char** argv) {
     argc--;
     argv++;
@@ -476,6 +1068,18 @@ int main(int argc, char** argv) {
     // Randomness needn't be cryptographic strength for our purposes.
     srand((unsigned int) time(NULL));
 
+    evalparams_init();
+
+    // A parameter file given ahead of the mode replaces the compiled-in evaluation weights.
+    if (argc >= 2 && 0 == strcmp("-params", argv[0])) {
+        if (!evalparams_load(argv[1])) {
+            exit(EXIT_FAILURE);
+        }
+
+        argc -= 2;
+        argv += 2;
+    }
+
     if (argc >= 1) {
         if (0 == strcmp("-listmoves", argv[0])) {
             listMoves(argc, argv);
@@ -499,6 +1103,22 @@ int main(int argc, char** argv) {
             bookLine(argc, argv);
         } else if (0 == strcmp("-bookmoves", argv[0])) {
             findBookMoves(argc, argv);
+        } else if (0 == strcmp("-convertbook", argv[0])) {
+            convertBook(argc, argv);
+        } else if (0 == strcmp("-buildbook", argv[0])) {
+            buildBook(argc, argv);
+        } else if (0 == strcmp("-indexpgn", argv[0])) {
+            indexPgn(argc, argv);
+        } else if (0 == strcmp("-queryindex", argv[0])) {
+            queryIndex(argc, argv);
+        } else if (0 == strcmp("-pgn2bin", argv[0])) {
+            pgnToBinary(argc, argv);
+        } else if (0 == strcmp("-bin2pgn", argv[0])) {
+            binaryToPgn(argc, argv);
+        } else if (0 == strcmp("-fen2bin", argv[0])) {
+            fenToPacked(argc, argv);
+        } else if (0 == strcmp("-bin2fen", argv[0])) {
+            packedToFen(argc, argv);
         } else if (0 == strcmp("-evalposition", argv[0])) {
             evalPosition(argc, argv);
         } else if (0 == strcmp("-simplesearch", argv[0])) {
@@ -513,6 +1133,26 @@ int main(int argc, char** argv) {
           startInteractive();
         } else if (0 == strcmp("-kingrect", argv[0])) {
             kingRect(argc, argv);
+        } else if (0 == strcmp("-evalbench", argv[0])) {
+            evalBench(argc, argv);
+        } else if (0 == strcmp("-server", argv[0])) {
+            startServer();
+        } else if (0 == strcmp("-batch-eval", argv[0])) {
+            batchRun(argc, argv, BATCH_EVALUATE);
+        } else if (0 == strcmp("-batch-search", argv[0])) {
+            batchRun(argc, argv, BATCH_SEARCH);
+        } else if (0 == strcmp("-bench", argv[0])) {
+            bench(argc, argv);
+        } else if (0 == strcmp("-epdsuite", argv[0])) {
+            epdSuite(argc, argv);
+        } else if (0 == strcmp("-selfplay", argv[0])) {
+            selfPlay(argc, argv);
+        } else if (0 == strcmp("-gendata", argv[0])) {
+            generateData(argc, argv);
+        } else if (0 == strcmp("-tune", argv[0])) {
+            tune(argc, argv);
+        } else if (0 == strcmp("-dumpparams", argv[0])) {
+            dumpParams(argc, argv);
         } else {
             printBanner();
             printf("Unknown command \"%s\"\n", argv[0]);
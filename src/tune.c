@@ -0,0 +1,558 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include <pthread.h>
+
+#include "tulip.h"
+#include "tune.h"
+#include "board.h"
+#include "eval.h"
+#include "evalconsts.h"
+#include "evalparams.h"
+#include "gamestate.h"
+#include "packedpos.h"
+#include "pawns.h"
+#include "piece.h"
+#include "util.h"
+
+// The tuned weights: scalars, then the white piece-square tables indexed by
+// square from a1 to h8. Black tables are mirrors.
+enum {
+	P_PAWN,
+	P_KNIGHT,
+	P_BISHOP,
+	P_ROOK,
+	P_QUEEN,
+	P_DOUBLED_PAWN,
+	P_PAWN_CHAIN,
+	P_PASSED_PAWN,
+	P_ISOLATED_PAWN_MG,
+	P_ISOLATED_PAWN_EG,
+	P_BACKWARD_PAWN_MG,
+	P_BACKWARD_PAWN_EG,
+	P_CANDIDATE_PASSER_MG,
+	P_CANDIDATE_PASSER_EG,
+	P_MINOR_MOBILITY,
+	P_RQ_SHARE_RANK,
+	P_KING_EXPOSURE,
+	P_BISHOP_PAIR_MG,
+	P_BISHOP_PAIR_EG,
+	P_SCALARS,
+	P_PAWN_SQ = P_SCALARS,
+	P_KNIGHT_SQ = P_PAWN_SQ + 64,
+	P_QUEEN_SQ = P_KNIGHT_SQ + 64,
+	P_KING_SQ = P_QUEEN_SQ + 64,
+	P_COUNT = P_KING_SQ + 64
+};
+
+static const char* SCALAR_NAMES[P_SCALARS] = {
+	"SCORE_PAWN",
+	"SCORE_KNIGHT",
+	"SCORE_BISHOP",
+	"SCORE_ROOK",
+	"SCORE_QUEEN",
+	"PENALTY_DOUBLED_PAWN",
+	"PAWN_CHAIN_BONUS",
+	"SCORE_PASSED_PAWN",
+	"PENALTY_ISOLATED_PAWN_MG",
+	"PENALTY_ISOLATED_PAWN_EG",
+	"PENALTY_BACKWARD_PAWN_MG",
+	"PENALTY_BACKWARD_PAWN_EG",
+	"SCORE_CANDIDATE_PASSER_MG",
+	"SCORE_CANDIDATE_PASSER_EG",
+	"MINOR_PIECE_MOBILITY_BONUS",
+	"BONUS_RQ_SHARE_RANK",
+	"KING_EXPOSURE",
+	"BONUS_BISHOP_PAIR_MG",
+	"BONUS_BISHOP_PAIR_EG",
+};
+
+// The parameter file names of the tables, in the order of the P_*_SQ blocks.
+static const char* TABLE_NAMES[] = {
+	"SQ_SCORE_PAWN_OPENING",
+	"SQ_SCORE_KNIGHT_OPENING",
+	"SQ_SCORE_QUEEN_OPENING",
+	"SQ_SCORE_ENDGAME_KING",
+};
+
+#define ADAM_BETA1 0.9
+#define ADAM_BETA2 0.999
+#define ADAM_EPSILON 1e-8
+
+// Bounds and iterations of the golden-section search for the sigmoid scale.
+#define K_MIN 0.05
+#define K_MAX 4.0
+#define K_ITERATIONS 32
+
+// One weighted term of a position: the term's count, scaled by the share of the game
+// phase it applies in, out of PHASE_MAX.
+typedef struct {
+	uint16_t index;
+	int16_t weight;
+} TuneTerm;
+
+typedef struct TuneWorker TuneWorker;
+
+typedef struct {
+	TuneArgs* args;
+	PackedFile data;
+	double params[P_COUNT];
+	double k;
+} TuneContext;
+
+struct TuneWorker {
+	pthread_t thread;
+	TuneContext* context;
+	uint64_t first;             // The worker's share of the data file.
+	uint64_t last;
+	int64_t positions;
+	int64_t skipped;
+	TuneTerm* terms;
+	int64_t termCount;
+	int64_t termCapacity;
+	uint8_t* termCounts;        // The number of terms of each position.
+	float* bases;               // The part of each evaluation that isn't tuned, from white's point of view.
+	float* results;             // White's game score.
+	float* scores;              // The score label, from white's point of view.
+	float* targets;
+	bool computeGradient;
+	double loss;
+	double gradient[P_COUNT];
+};
+
+static double sigmoid(double score, double k) {
+	return 1.0 / (1.0 + pow(10.0, -k * score / 400.0));
+}
+
+static void addTerm(int32_t* counts, uint16_t* touched, int32_t* touchedCount, int32_t index, int32_t weight) {
+	if (weight == 0) {
+		return;
+	}
+
+	if (counts[index] == 0) {
+		touched[(*touchedCount)++] = (uint16_t) index;
+	}
+
+	counts[index] += weight;
+}
+
+static void pushTerm(TuneWorker* worker, int32_t index, int32_t weight) {
+	if (worker->termCount == worker->termCapacity) {
+		worker->termCapacity *= 2;
+		worker->terms = realloc(worker->terms, (size_t) worker->termCapacity * sizeof(TuneTerm));
+		if (!worker->terms) {
+			perror("Unable to grow tuning terms.");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	TuneTerm* term = &worker->terms[worker->termCount++];
+	term->index = (uint16_t) index;
+	term->weight = (int16_t) weight;
+}
+
+// Reduces the position to its weighted terms. Returns false if it can't be tuned on.
+static bool tracePosition(TuneWorker* worker, GameState* state, int32_t* counts, uint16_t* touched) {
+	EvalTrace trace;
+	PawnTerms pawns;
+	int32_t touchedCount = 0;
+
+	if (!evaluateTrace(state, &trace)) {
+		return false;
+	}
+
+	pawns_countTerms(state->bitboards[ORD_WPAWN], state->bitboards[ORD_BPAWN], &pawns);
+
+	const int32_t mg = trace.phase;
+	const int32_t eg = PHASE_MAX - trace.phase;
+	const int32_t* c = state->pieceCounts;
+
+	addTerm(counts, touched, &touchedCount, P_PAWN, PHASE_MAX * (c[ORD_WPAWN] - c[ORD_BPAWN]));
+	addTerm(counts, touched, &touchedCount, P_KNIGHT, PHASE_MAX * (c[ORD_WKNIGHT] - c[ORD_BKNIGHT]));
+	addTerm(counts, touched, &touchedCount, P_BISHOP, PHASE_MAX * (c[ORD_WBISHOP] - c[ORD_BBISHOP]));
+	addTerm(counts, touched, &touchedCount, P_ROOK, PHASE_MAX * (c[ORD_WROOK] - c[ORD_BROOK]));
+	addTerm(counts, touched, &touchedCount, P_QUEEN, PHASE_MAX * (c[ORD_WQUEEN] - c[ORD_BQUEEN]));
+	addTerm(counts, touched, &touchedCount, P_DOUBLED_PAWN, mg * pawns.doubled);
+	addTerm(counts, touched, &touchedCount, P_PAWN_CHAIN, mg * pawns.chained);
+	addTerm(counts, touched, &touchedCount, P_PASSED_PAWN, eg * pawns.passed);
+	addTerm(counts, touched, &touchedCount, P_ISOLATED_PAWN_MG, mg * pawns.isolated);
+	addTerm(counts, touched, &touchedCount, P_ISOLATED_PAWN_EG, eg * pawns.isolated);
+	addTerm(counts, touched, &touchedCount, P_BACKWARD_PAWN_MG, mg * pawns.backward);
+	addTerm(counts, touched, &touchedCount, P_BACKWARD_PAWN_EG, eg * pawns.backward);
+	addTerm(counts, touched, &touchedCount, P_CANDIDATE_PASSER_MG, mg * pawns.candidates);
+	addTerm(counts, touched, &touchedCount, P_CANDIDATE_PASSER_EG, eg * pawns.candidates);
+	addTerm(counts, touched, &touchedCount, P_MINOR_MOBILITY, PHASE_MAX * trace.knightMobility + mg * trace.bishopMobility);
+	addTerm(counts, touched, &touchedCount, P_RQ_SHARE_RANK, eg * trace.rookFiles);
+	addTerm(counts, touched, &touchedCount, P_KING_EXPOSURE, mg * trace.kingExposure);
+
+	const int32_t bishopPairs = (c[ORD_WBISHOP] >= 2) - (c[ORD_BBISHOP] >= 2);
+	addTerm(counts, touched, &touchedCount, P_BISHOP_PAIR_MG, mg * bishopPairs);
+	addTerm(counts, touched, &touchedCount, P_BISHOP_PAIR_EG, eg * bishopPairs);
+
+	// Black's pawn, knight and queen tables mirror white's; both kings share one table.
+	for (int32_t i = 0; i < 64; i++) {
+		const int32_t ordinal = state->board[BOARD_SQUARES[i]]->ordinal;
+		const int32_t mirror = i ^ 56;
+
+		switch (ordinal) {
+		case ORD_WPAWN:
+			addTerm(counts, touched, &touchedCount, P_PAWN_SQ + i, mg);
+			break;
+		case ORD_BPAWN:
+			addTerm(counts, touched, &touchedCount, P_PAWN_SQ + mirror, -mg);
+			break;
+		case ORD_WKNIGHT:
+			addTerm(counts, touched, &touchedCount, P_KNIGHT_SQ + i, mg);
+			break;
+		case ORD_BKNIGHT:
+			addTerm(counts, touched, &touchedCount, P_KNIGHT_SQ + mirror, -mg);
+			break;
+		case ORD_WQUEEN:
+			addTerm(counts, touched, &touchedCount, P_QUEEN_SQ + i, mg);
+			break;
+		case ORD_BQUEEN:
+			addTerm(counts, touched, &touchedCount, P_QUEEN_SQ + mirror, -mg);
+			break;
+		case ORD_WKING:
+			addTerm(counts, touched, &touchedCount, P_KING_SQ + i, eg);
+			break;
+		case ORD_BKING:
+			addTerm(counts, touched, &touchedCount, P_KING_SQ + i, -eg);
+			break;
+		}
+	}
+
+	// The rest of the evaluation is constant while tuning.
+	const int32_t whiteEval = state->current->toMove == COLOR_WHITE ? evaluate(state) : -evaluate(state);
+	double linear = 0.0;
+	int32_t kept = 0;
+
+	for (int32_t i = 0; i < touchedCount; i++) {
+		const int32_t index = touched[i];
+		if (counts[index] != 0 && kept < UINT8_MAX) {
+			linear += (double) counts[index] * worker->context->params[index];
+			pushTerm(worker, index, counts[index]);
+			kept++;
+		}
+		counts[index] = 0;
+	}
+
+	const int64_t n = worker->positions;
+	worker->termCounts[n] = (uint8_t) kept;
+	worker->bases[n] = (float) (whiteEval - linear / PHASE_MAX);
+	return true;
+}
+
+static void* loadWorker(void* arg) {
+	TuneWorker* worker = (TuneWorker*) arg;
+	const PackedFile* data = &worker->context->data;
+	const size_t capacity = (size_t) (worker->last - worker->first) + 1;
+	int32_t counts[P_COUNT];
+	uint16_t touched[P_COUNT];
+	GameState state;
+
+	memset(counts, 0, sizeof(counts));
+	initializeGamestate(&state);
+
+	worker->termCapacity = 1024;
+	worker->terms = ALLOC((size_t) worker->termCapacity, TuneTerm, worker->terms, "Unable to allocate tuning terms.");
+	worker->termCounts = ALLOC(capacity, uint8_t, worker->termCounts, "Unable to allocate tuning positions.");
+	worker->bases = ALLOC(capacity, float, worker->bases, "Unable to allocate tuning positions.");
+	worker->results = ALLOC(capacity, float, worker->results, "Unable to allocate tuning positions.");
+	worker->scores = ALLOC(capacity, float, worker->scores, "Unable to allocate tuning positions.");
+	worker->targets = ALLOC(capacity, float, worker->targets, "Unable to allocate tuning positions.");
+
+	for (uint64_t i = worker->first; i < worker->last; i++) {
+		const uint8_t* packed = data->positions + i * PACKED_POSITION_SIZE;
+		const int32_t result = packedpos_result(packed);
+
+		if (result == PACKED_RESULT_NONE || !unpackPosition(&state, packed) || !tracePosition(worker, &state, counts, touched)) {
+			worker->skipped++;
+			continue;
+		}
+
+		worker->results[worker->positions] = (float) (result - 1) / 2.0f;
+		worker->scores[worker->positions] = (float) packedpos_score(packed);
+		worker->positions++;
+	}
+
+	destroyGamestate(&state);
+	return NULL;
+}
+
+static void* lossWorker(void* arg) {
+	TuneWorker* worker = (TuneWorker*) arg;
+	const double* params = worker->context->params;
+	const double k = worker->context->k;
+	const double slope = k * log(10.0) / 400.0;
+	const TuneTerm* term = worker->terms;
+	double loss = 0.0;
+
+	if (worker->computeGradient) {
+		memset(worker->gradient, 0, sizeof(worker->gradient));
+	}
+
+	for (int64_t i = 0; i < worker->positions; i++) {
+		const TuneTerm* end = term + worker->termCounts[i];
+		const TuneTerm* start = term;
+		double dot = 0.0;
+		for (; term < end; term++) {
+			dot += term->weight * params[term->index];
+		}
+
+		const double eval = worker->bases[i] + dot / PHASE_MAX;
+		const double p = MIN(MAX(1.0 / (1.0 + exp(-slope * eval)), 1e-12), 1.0 - 1e-12);
+		const double target = worker->targets[i];
+		loss -= target * log(p) + (1.0 - target) * log(1.0 - p);
+
+		if (worker->computeGradient) {
+			const double delta = (p - target) * slope / PHASE_MAX;
+			for (const TuneTerm* t = start; t < end; t++) {
+				worker->gradient[t->index] += delta * t->weight;
+			}
+		}
+	}
+
+	worker->loss = loss;
+	return NULL;
+}
+
+static void runWorkers(TuneWorker* workers, int32_t threads, void* (*work)(void*)) {
+	if (threads == 1) {
+		work(&workers[0]);
+		return;
+	}
+
+	for (int32_t i = 0; i < threads; i++) {
+		if (pthread_create(&workers[i].thread, NULL, work, &workers[i]) != 0) {
+			perror("Unable to start tuning worker");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	for (int32_t i = 0; i < threads; i++) {
+		pthread_join(workers[i].thread, NULL);
+	}
+}
+
+static void setTargets(TuneWorker* workers, int32_t threads, double k, double lambda) {
+	for (int32_t w = 0; w < threads; w++) {
+		TuneWorker* worker = &workers[w];
+		for (int64_t i = 0; i < worker->positions; i++) {
+			worker->targets[i] = (float) (lambda * worker->results[i] + (1.0 - lambda) * sigmoid(worker->scores[i], k));
+		}
+	}
+}
+
+// The mean loss over all positions, and the mean gradient if asked for.
+static double computeLoss(TuneContext* context, TuneWorker* workers, int32_t threads, int64_t positions, double* gradient) {
+	for (int32_t i = 0; i < threads; i++) {
+		workers[i].computeGradient = gradient != NULL;
+	}
+
+	runWorkers(workers, threads, lossWorker);
+
+	double loss = 0.0;
+	for (int32_t i = 0; i < threads; i++) {
+		loss += workers[i].loss;
+	}
+
+	if (gradient != NULL) {
+		for (int32_t p = 0; p < P_COUNT; p++) {
+			gradient[p] = 0.0;
+			for (int32_t i = 0; i < threads; i++) {
+				gradient[p] += workers[i].gradient[p];
+			}
+			gradient[p] /= (double) positions;
+		}
+	}
+
+	return loss / (double) positions;
+}
+
+// Finds the sigmoid scale that best fits the untuned evaluation to the targets.
+static double fitK(TuneContext* context, TuneWorker* workers, int32_t threads, int64_t positions) {
+	const double ratio = (sqrt(5.0) - 1.0) / 2.0;
+	double low = K_MIN;
+	double high = K_MAX;
+
+	for (int32_t i = 0; i < K_ITERATIONS; i++) {
+		const double k1 = high - ratio * (high - low);
+		const double k2 = low + ratio * (high - low);
+
+		context->k = k1;
+		setTargets(workers, threads, k1, context->args->lambda);
+		const double loss1 = computeLoss(context, workers, threads, positions, NULL);
+
+		context->k = k2;
+		setTargets(workers, threads, k2, context->args->lambda);
+		const double loss2 = computeLoss(context, workers, threads, positions, NULL);
+
+		if (loss1 < loss2) {
+			high = k2;
+		} else {
+			low = k1;
+		}
+	}
+
+	return (low + high) / 2.0;
+}
+
+static int32_t roundParam(double value) {
+	return (int32_t) floor(value + 0.5);
+}
+
+// Finds the weights that a tuned parameter or table maps to.
+static int32_t* findParam(EvalParams* params, int32_t index) {
+	int32_t count;
+	if (index < P_SCALARS) {
+		return evalparams_find(params, SCALAR_NAMES[index], &count);
+	}
+
+	const int32_t table = (index - P_SCALARS) / 64;
+	return evalparams_find(params, TABLE_NAMES[table], &count) + (index - P_SCALARS) % 64;
+}
+
+// Tuning starts from the active weights, so a loaded parameter file can be refined.
+static void initParams(double* params) {
+	EvalParams* active = (EvalParams*) EVAL_PARAMS;
+	for (int32_t i = 0; i < P_COUNT; i++) {
+		params[i] = *findParam(active, i);
+	}
+}
+
+// Writes the active weights with the tuned ones in place, as a parameter file.
+static bool writeParams(const char* fileName, const double* params) {
+	EvalParams* tuned = ALLOC(1, EvalParams, tuned, "Unable to allocate tuned parameters.");
+	memcpy(tuned, EVAL_PARAMS, sizeof(EvalParams));
+
+	for (int32_t i = 0; i < P_COUNT; i++) {
+		*findParam(tuned, i) = roundParam(params[i]);
+	}
+
+	evalparams_update(tuned);
+	const bool ok = evalparams_save(fileName, tuned);
+	free(tuned);
+	return ok;
+}
+
+static void destroyWorker(TuneWorker* worker) {
+	free(worker->terms);
+	free(worker->termCounts);
+	free(worker->bases);
+	free(worker->results);
+	free(worker->scores);
+	free(worker->targets);
+}
+
+bool tune_run(const char* dataFile, const char* outputFile, TuneArgs* args, TuneResult* result) {
+	memset(result, 0, sizeof(TuneResult));
+	result->parameters = P_COUNT;
+
+	TuneContext context;
+	context.args = args;
+	context.k = args->k;
+	initParams(context.params);
+
+	if (!packedpos_open(dataFile, &context.data)) {
+		fprintf(stderr, "Unable to read [%s].\n", dataFile);
+		return false;
+	}
+
+	const int64_t start = getCurrentTimeMillis();
+	const int32_t threads = args->threads;
+	const uint64_t count = context.data.count;
+	TuneWorker* workers = ALLOC((size_t) threads, TuneWorker, workers, "Unable to allocate tuning workers.");
+	memset(workers, 0, (size_t) threads * sizeof(TuneWorker));
+
+	for (int32_t i = 0; i < threads; i++) {
+		workers[i].context = &context;
+		workers[i].first = count * (uint64_t) i / (uint64_t) threads;
+		workers[i].last = count * (uint64_t) (i + 1) / (uint64_t) threads;
+	}
+
+	runWorkers(workers, threads, loadWorker);
+	packedpos_close(&context.data);
+
+	for (int32_t i = 0; i < threads; i++) {
+		result->positions += workers[i].positions;
+		result->skipped += workers[i].skipped;
+	}
+
+	result->loadMillis = getCurrentTimeMillis() - start;
+	bool ok = result->positions > 0;
+
+	if (!ok) {
+		fprintf(stderr, "No labeled positions to tune on in [%s].\n", dataFile);
+	} else {
+		const int64_t positions = result->positions;
+		if (context.k <= 0.0) {
+			context.k = fitK(&context, workers, threads, positions);
+		}
+
+		setTargets(workers, threads, context.k, args->lambda);
+		result->k = context.k;
+
+		double gradient[P_COUNT];
+		double m[P_COUNT] = {0};
+		double v[P_COUNT] = {0};
+		double loss = 0.0;
+
+		for (int32_t epoch = 1; epoch <= args->epochs; epoch++) {
+			loss = computeLoss(&context, workers, threads, positions, gradient);
+			if (epoch == 1) {
+				result->initialLoss = loss;
+			}
+
+			const double correction1 = 1.0 - pow(ADAM_BETA1, epoch);
+			const double correction2 = 1.0 - pow(ADAM_BETA2, epoch);
+			for (int32_t p = 0; p < P_COUNT; p++) {
+				m[p] = ADAM_BETA1 * m[p] + (1.0 - ADAM_BETA1) * gradient[p];
+				v[p] = ADAM_BETA2 * v[p] + (1.0 - ADAM_BETA2) * gradient[p] * gradient[p];
+				context.params[p] -= args->learningRate * (m[p] / correction1) / (sqrt(v[p] / correction2) + ADAM_EPSILON);
+			}
+
+			fprintf(stderr, "Epoch %i: loss %.6f\n", epoch, loss);
+		}
+
+		result->finalLoss = computeLoss(&context, workers, threads, positions, NULL);
+		if (args->epochs == 0) {
+			result->initialLoss = result->finalLoss;
+		}
+
+		ok = writeParams(outputFile, context.params);
+	}
+
+	result->elapsedMillis = getCurrentTimeMillis() - start;
+
+	for (int32_t i = 0; i < threads; i++) {
+		destroyWorker(&workers[i]);
+	}
+	free(workers);
+
+	return ok;
+}
@@ -0,0 +1,60 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef TUNE_H
+#define TUNE_H
+
+#include <stdbool.h>
+#include <inttypes.h>
+
+#define TUNE_MAX_THREADS 256
+
+// Options for tuning the evaluation against a labeled position file.
+typedef struct {
+	int32_t threads;            // Positions are split evenly over the threads, which load and score their own share.
+	int32_t epochs;             // Passes over the data; each makes one Adam step.
+	double learningRate;        // The Adam step size, in centipawns.
+	double lambda;              // Weight of the game result in the target; the rest is the sigmoid of the score label.
+	double k;                   // The sigmoid scale; fitted to the data if 0.
+} TuneArgs;
+
+// Totals of a tuning run.
+typedef struct {
+	int64_t positions;          // Positions used.
+	int64_t skipped;            // Positions without a result label, or with a specialized endgame evaluation.
+	int32_t parameters;
+	double k;
+	double initialLoss;
+	double finalLoss;
+	int64_t loadMillis;
+	int64_t elapsedMillis;
+} TuneResult;
+
+// Tunes the evaluation weights against a packed position file labeled by -gendata,
+// minimizing the logistic loss of the static evaluation with Adam, and writes the
+// tuned values to outputFile as a parameter file (see evalparams.h). Tuning starts
+// from the active weights. The evaluation is linear in the weights, so each position
+// is reduced once to its term counts and every epoch is a sparse dot product per
+// position. Returns false if the data can't be read or has no usable positions.
+bool tune_run(const char* dataFile, const char* outputFile, TuneArgs* args, TuneResult* result);
+
+#endif
@@ -112,6 +112,12 @@ int64_t getCurrentTimeMillis() {
         return (int64_t)((seconds * 1000.0) + round((double) nanos));
 }
 
+int64_t getMonotonicTimeNanos() {
+        struct timespec spec;
+        clock_gettime(CLOCK_MONOTONIC, &spec);
+        return ((int64_t) spec.tv_sec) * 1000000000l + (int64_t) spec.tv_nsec;
+}
+
 bool parseInteger(char* str, int32_t* result) {
         char* endToken = NULL;
         int64_t longResult = strtol(str, &endToken, 10);
@@ -131,3 +137,51 @@ bool parseInteger(char* str, int32_t* result) {
         *result = (int32_t) longResult;
         return true;
 }
+
+uint64_t readLE64(const uint8_t* p) {
+        uint64_t value = 0;
+        for (int32_t i = 7; i >= 0; i--) {
+                value = (value << 8) | p[i];
+        }
+        return value;
+}
+
+uint32_t readLE32(const uint8_t* p) {
+        return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+uint16_t readLE16(const uint8_t* p) {
+        return (uint16_t) (p[0] | (p[1] << 8));
+}
+
+void writeLE64(uint8_t* p, uint64_t value) {
+        for (int32_t i = 0; i < 8; i++) {
+                p[i] = (uint8_t) (value >> (8 * i));
+        }
+}
+
+void writeLE32(uint8_t* p, uint32_t value) {
+        for (int32_t i = 0; i < 4; i++) {
+                p[i] = (uint8_t) (value >> (8 * i));
+        }
+}
+
+void writeLE16(uint8_t* p, uint16_t value) {
+        p[0] = (uint8_t) value;
+        p[1] = (uint8_t) (value >> 8);
+}
+
+uint64_t nextRandom(uint64_t* state) {
+        *state ^= *state >> 12;
+        *state ^= *state << 25;
+        *state ^= *state >> 27;
+        return *state * 0x2545F4914F6CDD1DULL;
+}
+
+uint64_t seedRandom(uint64_t seed, int64_t stream) {
+        uint64_t z = seed + (uint64_t) (stream + 1) * 0x9E3779B97F4A7C15ULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        z ^= z >> 31;
+        return z != 0 ? z : 1;
+}
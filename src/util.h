@@ -40,7 +40,26 @@ void freeTokenBuffer(char** tokenBuffer, const int32_t numberOfTokens);
 // Retrieve the current UNIX epoch time in milliseconds.
 int64_t getCurrentTimeMillis();
 
+// Retrieve a monotonic timestamp in nanoseconds. Only useful for measuring
+// elapsed time, the epoch is arbitrary.
+int64_t getMonotonicTimeNanos();
+
 // Parse a given string as an integer, return success or failure.
 // On failure, this will print an error message to stderr.
 bool parseInteger(const char* str, int32_t* result);
+
+// Read and write little-endian integers, for the binary file formats.
+uint64_t readLE64(const uint8_t* p);
+uint32_t readLE32(const uint8_t* p);
+uint16_t readLE16(const uint8_t* p);
+void writeLE64(uint8_t* p, uint64_t value);
+void writeLE32(uint8_t* p, uint32_t value);
+void writeLE16(uint8_t* p, uint16_t value);
+
+// Advance an xorshift64* generator and return its next value. The state must not be zero.
+uint64_t nextRandom(uint64_t* state);
+
+// Spread a seed and a stream number, such as a game number, into a non-zero
+// xorshift state, so each stream gets its own reproducible sequence.
+uint64_t seedRandom(uint64_t seed, int64_t stream);
 #endif
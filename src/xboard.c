@@ -25,6 +25,7 @@
 #include <string.h>
 #include <stdbool.h>
 #include <stdarg.h>
+#include <ctype.h>
 
 #include "util.h"
 #include "xboard.h"
@@ -39,6 +40,11 @@
 #include "result.h"
 #include "time.h"
 #include "env.h"
+#include "hash.h"
+#include "eval.h"
+#include "evalparams.h"
+#include "pawns.h"
+#include "material.h"
 
 static void xBoardWrite(XBoardState* xbs, const char* format, ...) {
 	va_list argptr;
@@ -69,7 +75,15 @@ static void logGameState(XBoardState* xbs) {
 	free(outputMessage);
 }
 
+static void clearSearchTable(XBoardState* xbs) {
+	if (xbs->gameState.zTable) {
+		hash_clearZTable(xbs->gameState.zTable);
+	}
+}
+
 static void xBoardNew(XBoardState* xbs) {
+	clearSearchTable(xbs);
+
 	if (!parseFenWithPrint(&xbs->gameState, "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", true)) {
 		xBoardWrite(xbs, "Error: Unable to set initial board position; invalid FEN. (?!?!)");
 	}
@@ -86,21 +100,16 @@ static void xBoardApplyMove(XBoardState* xbs, Move* move) {
 }
 
 static bool xBoardThinkAndMove(XBoardState* xbs) {
-	MoveBuffer mb;
 	char moveStr[16];
 	bool foundMove = false;
 	Move move;
 
 	// First check the book for this position.
 	if (xbs->bookOpen) {
-		createMoveBuffer(&mb);
-		const int bookMoveCount = book_getMoves(&xbs->gameState, &mb, &xbs->currentBook);
-		if (bookMoveCount > 0) {
+		if (book_chooseMove(&xbs->gameState, &xbs->currentBook, &move)) {
 			foundMove = true;
-			move = mb.moves[rand() % bookMoveCount];
 			log_write(&xbs->log, "Found move from book.");
 		}
-		destroyMoveBuffer(&mb);
 	} else {
 		log_write(&xbs->log, "Book not open, proceeding to search.");
 	}
@@ -120,7 +129,7 @@ static bool xBoardThinkAndMove(XBoardState* xbs) {
 
 		search(&xbs->gameState, &args, &searchResult);
 
-		if (searchResult.searchStatus != SEARCH_STATUS_NO_LEGAL_MOVES) {
+		if (searchResult.searchStatus == SEARCH_STATUS_NONE) {
 			move = searchResult.move;
 			foundMove = true;
 		}
@@ -149,6 +158,9 @@ static void printResult(XBoardState* xbs, int32_t result) {
 	case STATUS_THREEFOLD_DRAW:
 		xBoardWrite(xbs, "1/2-1/2 {Draw by threefold repitition.");
 		break;
+	case STATUS_FIFTY_MOVE_DRAW:
+		xBoardWrite(xbs, "1/2-1/2 {Draw by fifty move rule.}");
+		break;
 	case STATUS_WHITE_CHECKMATED:
 		xBoardWrite(xbs, "0-1 {White checkmated.}");
 		break;
@@ -188,7 +200,7 @@ static void xBoardMove(XBoardState* xbs, char* move) {
 }
 
 static void xBoardProtover(XBoardState* xbs) {
-	xBoardWrite(xbs, "feature ping=1 san=1 time=1 sigint=0 sigterm=0 setboard=1 done=1");
+	xBoardWrite(xbs, "feature ping=1 san=1 time=1 sigint=0 sigterm=0 setboard=1 option=\"EvalParams -file \" done=1");
 }
 
 static void xBoardIcs(XBoardState* xbs, char** tokens, int tokenCount) {
@@ -262,6 +274,8 @@ static void xBoardSetboard(XBoardState* xbs, char** tokens, int tokenCount) {
 
 	fenStr[idx] = '\0';
 
+	clearSearchTable(xbs);
+
 	if (!parseFenWithPrint(&xbs->gameState, fenStr, false)) {
 		xBoardWrite(xbs, "Error: Illegal position: %s", fenStr);
 	}
@@ -269,6 +283,41 @@ static void xBoardSetboard(XBoardState* xbs, char** tokens, int tokenCount) {
 	free(fenStr);
 }
 
+// Loads an evaluation parameter file. Anything cached under the old weights is
+// dropped, and the current position is rescored.
+static void xBoardLoadParams(XBoardState* xbs, const char* fileName) {
+	if (!evalparams_load(fileName)) {
+		xBoardWrite(xbs, "Error: Unable to load evaluation parameters: %s", fileName);
+		return;
+	}
+
+	GameState* state = &xbs->gameState;
+	clearSearchTable(xbs);
+	pawns_clearTable(&state->pawnTable);
+	material_clearTable(&state->materialTable);
+	computeStaticScores(state, &state->current->mgScore, &state->current->egScore);
+	log_write(&xbs->log, "Loaded evaluation parameters from %s", fileName);
+}
+
+// Handles "option NAME=VALUE". The value is taken from the raw line, as it may
+// contain spaces.
+static void xBoardOption(XBoardState* xbs, const char* line) {
+	const char* option = line;
+	while (isspace((unsigned char) *option)) {
+		option++;
+	}
+
+	option += strlen("option");
+	while (isspace((unsigned char) *option)) {
+		option++;
+	}
+
+	const char* prefix = "EvalParams=";
+	if (strncmp(option, prefix, strlen(prefix)) == 0) {
+		xBoardLoadParams(xbs, option + strlen(prefix));
+	}
+}
+
 static bool isCommand(const char* command, char* str) {
 	return strcmp(command, str) == 0;
 }
@@ -343,7 +392,7 @@ void postXBOutput(void* chessInterfaceState, int ply, int score, long timeCentis
 
 #define INPUT_BUFFER_SIZE 2048
 #define MAX_INPUT_TOKENS 32
-#define MAX_TOKEN_LEN 64
+#define MAX_TOKEN_LEN INPUT_BUFFER_SIZE // A whole line may be one token, such as a file name.
 bool startXBoard() {
 	char* inputBuffer;
 	bool result = true;
@@ -378,8 +427,9 @@ bool startXBoard() {
 	initializeGamestate(&xbState.gameState);
 
 	// TODO: Define elsewhere
-	const char* openingBook = "tulip_openings.sqlite";
-	xbState.bookOpen = book_open(openingBook, &xbState.currentBook);
+	// Prefer the binary book; the SQLite book is only a fallback.
+	xbState.bookOpen = book_open("tulip_openings.bin", &xbState.currentBook)
+	                   || book_open("tulip_openings.sqlite", &xbState.currentBook);
 	xbState.postThinking = false;
 
 	if (!log_open(&xbState.log)) {
@@ -392,7 +442,7 @@ bool startXBoard() {
 		if (!fgets(inputBuffer, INPUT_BUFFER_SIZE, stdin)) {
 			perror("Error: Unable to read from stdin.");
 			result = false;
-			goto cleanup_gamestate;
+			goto cleanup_log;
 		}
 
 		chopNewline(inputBuffer, INPUT_BUFFER_SIZE);
@@ -460,6 +510,7 @@ bool startXBoard() {
 			} else if (isCommand("cores", cmd)) {
 			} else if (isCommand("egtpath", cmd)) {
 			} else if (isCommand("option", cmd)) {
+				xBoardOption(&xbState, inputBuffer);
 			} else if (isCommand("exclude", cmd)) {
 			} else if (isCommand("include", cmd)) {
 			} else if (isCommand("setscore", cmd)) {
@@ -472,12 +523,12 @@ bool startXBoard() {
 		}
 	}
 
+cleanup_log:
 	log_close(&xbState.log);
 cleanup_book:
 	if (xbState.bookOpen) {
 		book_close(&xbState.currentBook);
 	}
-cleanup_gamestate:
 	destroyGamestate(&xbState.gameState);
 	freeTokenBuffer(tb, MAX_INPUT_TOKENS);
 cleanup_outputBuff:
@@ -30,10 +30,12 @@ typedef struct {
 	int32_t depth;
 	uint64_t hash;
 	int32_t flag;
+	uint32_t generation;    // The table's generation when stored; entries from older ones are ignored.
 } ZTableEntry;
 
 typedef struct {
 	ZTableEntry* data;
+	uint32_t generation;
 } ZTable;
 
 #endif
@@ -0,0 +1,105 @@
+# The MIT License (MIT)
+#
+# Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+import subprocess
+import json
+import unittest
+import os
+import tempfile
+
+POSITIONS = [
+    'rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1',
+    'r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1',
+    '6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1',
+    '8/8/4k3/8/2p5/8/B2K4/8 b - - 3 40',
+]
+
+def call_tulip(args):
+    cmd = ['../../src/tulip']
+    cmd.extend(args)
+    out = subprocess.check_output(cmd)
+    return out.decode('utf-8')
+
+class TestBatch(unittest.TestCase):
+    def setUp(self):
+        self.temp = tempfile.NamedTemporaryFile(mode='w', suffix='.epd', delete=False)
+
+    def tearDown(self):
+        os.remove(self.temp.name)
+
+    def write_lines(self, lines):
+        self.temp.write('\n'.join(lines) + '\n')
+        self.temp.close()
+
+    def run_batch(self, args):
+        return [json.loads(line) for line in call_tulip(args).splitlines()]
+
+    def test_eval_matches_single_position(self):
+        self.write_lines(POSITIONS)
+        results = self.run_batch(['-batch-eval', self.temp.name])
+        self.assertEqual(len(POSITIONS), len(results))
+        for (fen, result) in zip(POSITIONS, results):
+            single = json.loads(call_tulip(['-evalposition', fen]))
+            self.assertEqual(fen, result['fenString'])
+            self.assertEqual(single['score'], result['score'])
+
+    def test_threads_keep_input_order(self):
+        lines = POSITIONS * 50
+        self.write_lines(lines)
+        results = self.run_batch(['-batch-eval', self.temp.name, '-threads', '4'])
+        self.assertEqual(list(range(1, len(lines) + 1)), [r['line'] for r in results])
+        self.assertEqual(lines, [r['fenString'] for r in results])
+
+    def test_epd_and_bad_lines(self):
+        self.write_lines(['# comment', '6k1/5ppp/8/8/8/8/8/R5K1 w - - bm Ra8#; id "mate";', '', 'not a position'])
+        results = self.run_batch(['-batch-eval', self.temp.name])
+        self.assertEqual(2, len(results))
+        self.assertEqual(2, results[0]['line'])
+        self.assertEqual('6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1', results[0]['fenString'])
+        self.assertEqual(4, results[1]['line'])
+        self.assertIn('error', results[1])
+
+    def test_fen_is_escaped(self):
+        # The castling field is loosely parsed, so odd characters reach the output.
+        fen = 'k7/8/8/8/8/8/8/7K w K"\\ - 0 1'
+        self.write_lines([fen])
+        results = self.run_batch(['-batch-eval', self.temp.name])
+        self.assertEqual(fen, results[0]['fenString'])
+
+    def test_search(self):
+        self.write_lines(POSITIONS)
+        results = self.run_batch(['-batch-search', self.temp.name, '-depth', '2', '-threads', '2'])
+        self.assertEqual(len(POSITIONS), len(results))
+        self.assertEqual('Ra8#', results[2]['move'])
+        single = self.run_batch(['-batch-search', self.temp.name, '-depth', '2', '-threads', '1'])
+        key = lambda r: (r['line'], r['move'], r.get('score'), r.get('nodes'))
+        self.assertEqual([key(r) for r in single], [key(r) for r in results])
+
+    def test_search_depth_must_be_positive(self):
+        self.write_lines(POSITIONS)
+        for depth in ['0', '-1']:
+            with self.assertRaises(subprocess.CalledProcessError):
+                subprocess.check_output(['../../src/tulip', '-batch-search', self.temp.name, '-depth', depth],
+                                        stderr=subprocess.DEVNULL)
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,49 @@
+# The MIT License (MIT)
+#
+# Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+import subprocess
+import json
+import unittest
+
+def call_tulip(args):
+    cmd = ['../../src/tulip']
+    cmd.extend(args)
+    out = subprocess.check_output(cmd, stderr=subprocess.DEVNULL)
+    return out.decode('utf-8')
+
+class TestBench(unittest.TestCase):
+    def run_bench(self, depth):
+        return json.loads(call_tulip(['-bench', '-depth', str(depth)]))
+
+    def test_bench_is_deterministic(self):
+        first = self.run_bench(2)
+        second = self.run_bench(2)
+        self.assertEqual(40, first['positions'])
+        self.assertEqual(2, first['depth'])
+        self.assertTrue(first['nodes'] > 0)
+        self.assertEqual(first['nodes'], second['nodes'])
+
+    def test_bench_depth_increases_nodes(self):
+        self.assertTrue(self.run_bench(3)['nodes'] > self.run_bench(2)['nodes'])
+
+if __name__ == '__main__':
+    unittest.main()
@@ -23,6 +23,25 @@
 import subprocess
 import json
 import unittest
+import os
+import stat
+import struct
+import tempfile
+
+INITIAL_FEN = 'rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1'
+
+def square_index(sq):
+    return (ord(sq[0]) - ord('a')) + 8 * (int(sq[1]) - 1)
+
+def pack_move(move):
+    return square_index(move[0:2]) | (square_index(move[2:4]) << 6)
+
+def write_binary_book(file_name, records):
+    records = sorted(records)
+    with open(file_name, 'wb') as f:
+        f.write(b'TULPBOOK' + struct.pack('<Q', len(records)))
+        for (position_hash, move, weight) in records:
+            f.write(struct.pack('<QHHI', position_hash, move, weight, 0))
 
 def call_tulip(args):
     cmd = ['../../src/tulip']
@@ -39,6 +58,103 @@ class TestBook(unittest.TestCase):
         parsed_output = json.loads(result)
         return parsed_output['moveList']
 
+    def book_line(self, moves):
+        result = json.loads(call_tulip(['-bookline', INITIAL_FEN] + moves))
+        return [result['initialHash']] + [x['resultingHash'] for x in result['hashSequence']]
+
+    def test_binary_book(self):
+        initial = int(self.book_line([])[0], 16)
+        with tempfile.TemporaryDirectory() as tmp:
+            book = os.path.join(tmp, 'book.bin')
+            write_binary_book(book, [(initial, pack_move('e2e4'), 3), (initial, pack_move('d2d4'), 1), (initial + 1, pack_move('g1f3'), 1)])
+            self.assertEqual(['d2d4', 'e2e4'], sorted(self.get_book_moves(book, INITIAL_FEN)))
+            self.assertEqual(0, len(self.get_book_moves(book, 'rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1')))
+
+    def test_truncated_binary_book(self):
+        initial = int(self.book_line([])[0], 16)
+        with tempfile.TemporaryDirectory() as tmp:
+            book = os.path.join(tmp, 'book.bin')
+            write_binary_book(book, [(initial, pack_move('e2e4'), 1)])
+            with open(book, 'r+b') as f:
+                f.truncate(20)
+            result = subprocess.check_output(['../../src/tulip', '-bookmoves', book, INITIAL_FEN], stderr=subprocess.DEVNULL)
+            self.assertEqual(0, len(json.loads(result.decode('utf-8'))['moveList']))
+
+    def test_convert_sqlite_book(self):
+        hashes = self.book_line(['e4', 'e5'])
+        rows = ['%s|e2e4' % hashes[0], '%s|d2d4' % hashes[0], '%s|e7e5' % hashes[1], '%s|g1f3' % hashes[2],
+                'DEADBEEF00000000|e2e4']
+        with tempfile.TemporaryDirectory() as tmp:
+            # Stand in for the sqlite3 command with a script that prints the book's rows.
+            fake_sqlite = os.path.join(tmp, 'sqlite3')
+            with open(fake_sqlite, 'w') as f:
+                f.write('#!/bin/sh\n')
+                for row in rows:
+                    f.write('echo "%s"\n' % row)
+            os.chmod(fake_sqlite, os.stat(fake_sqlite).st_mode | stat.S_IEXEC)
+            env = dict(os.environ, PATH=tmp + os.pathsep + os.environ['PATH'])
+
+            book = os.path.join(tmp, 'book.bin')
+            out = subprocess.check_output(['../../src/tulip', '-convertbook', os.path.join(tmp, 'book.sqlite'), book],
+                                          env=env, stderr=subprocess.DEVNULL)
+            self.assertEqual(4, json.loads(out.decode('utf-8'))['records'])
+            self.assertEqual(['d2d4', 'e2e4'], sorted(self.get_book_moves(book, INITIAL_FEN)))
+            self.assertEqual(['e7e5'], self.get_book_moves(book, 'rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1'))
+
+    def test_build_book_from_pgn(self):
+        pgn = """[Event "One"]
+[Result "1-0"]
+
+1.e4 {King's pawn} e5 2.Nf3 (2.f4 exf4) Nc6 $1 3.Bb5!? a6 1-0
+
+[Event "Two"]
+[Result "0-1"]
+
+1. e4 c5 2. Nf3 d6 0-1
+
+[Event "Three"]
+[Result "*"]
+
+1. d4 d5 2. Qxd5 *
+
+[Event "Four"]
+[FEN "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1"]
+[SetUp "1"]
+
+1... e6 *
+"""
+        with tempfile.TemporaryDirectory() as tmp:
+            pgn_file = os.path.join(tmp, 'games.pgn')
+            with open(pgn_file, 'w') as f:
+                f.write(pgn)
+            book = os.path.join(tmp, 'book.bin')
+            result = json.loads(call_tulip(['-buildbook', pgn_file, book, '-plies', '3']))
+            self.assertEqual(4, result['games'])
+            self.assertEqual(1, result['errors'])
+            self.assertEqual(['d2d4', 'e2e4'], sorted(self.get_book_moves(book, INITIAL_FEN)))
+            self.assertEqual(['c7c5', 'e7e5', 'e7e6'], sorted(self.get_book_moves(book, 'rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1')))
+            self.assertEqual(['g1f3'], self.get_book_moves(book, 'rnbqkbnr/pppp1ppp/8/4p3/4P3/8/PPPP1PPP/RNBQKBNR w KQkq - 0 2'))
+            self.assertEqual(0, len(self.get_book_moves(book, 'r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3')))
+
+            result = json.loads(call_tulip(['-buildbook', pgn_file, book, '-plies', '3', '-mincount', '2']))
+            self.assertEqual(['e2e4'], self.get_book_moves(book, INITIAL_FEN))
+
+    def test_build_book_plies_limit(self):
+        moves = ' '.join('%i. %s' % (i + 1, m) for (i, m) in enumerate(['Nf3 Nf6', 'Ng1 Ng8'] * 150))
+        with tempfile.TemporaryDirectory() as tmp:
+            pgn_file = os.path.join(tmp, 'long.pgn')
+            with open(pgn_file, 'w') as f:
+                f.write('[Event "Long"]\n[Result "*"]\n\n%s *\n' % moves)
+            book = os.path.join(tmp, 'book.bin')
+            result = json.loads(call_tulip(['-buildbook', pgn_file, book, '-plies', '500']))
+            self.assertEqual(0, result['errors'])
+            self.assertEqual(500, result['positions'])
+            self.assertEqual(['g1f3'], self.get_book_moves(book, INITIAL_FEN))
+
+            with self.assertRaises(subprocess.CalledProcessError):
+                subprocess.check_output(['../../src/tulip', '-buildbook', pgn_file, book, '-plies', '501'],
+                                        stderr=subprocess.DEVNULL)
+
     def test_no_bookfile(self):
         result = self.get_book_moves('this_doesnt_exist.asdf.sqlite', 'rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1')
         self.assertEqual(0, len(result))
@@ -0,0 +1,75 @@
+# The MIT License (MIT)
+#
+# Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+import subprocess
+import json
+import unittest
+import os
+import tempfile
+
+SUITE = '''6k1/5ppp/8/8/8/8/8/R5K1 w - - bm Ra8#; id "mate.1";
+r1bqkb1r/pppp1ppp/2n2n2/4p2Q/2B1P3/8/PPPP1PPP/RNB1K1NR w KQkq - bm Qxf7#; id "scholar";
+rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - am f3 g4; id "opening.am";
+# Qh5 isn't legal here, so this record can't be used.
+4k3/8/8/8/8/8/8/4K3 w - - bm Qh5; id "bad";
+'''
+
+def call_tulip(args):
+    cmd = ['../../src/tulip']
+    cmd.extend(args)
+    out = subprocess.check_output(cmd)
+    return out.decode('utf-8')
+
+class TestEpdSuite(unittest.TestCase):
+    def setUp(self):
+        with tempfile.NamedTemporaryFile(mode='w', suffix='.epd', delete=False) as f:
+            f.write(SUITE)
+            self.suite_file = f.name
+
+    def tearDown(self):
+        os.remove(self.suite_file)
+
+    def run_suite(self, threads):
+        return json.loads(call_tulip(['-epdsuite', self.suite_file, '-movetime', '200', '-threads', str(threads)]))
+
+    def check_report(self, report):
+        self.assertEqual(4, report['positions'])
+        self.assertEqual(3, report['solved'])
+        self.assertEqual(1, report['invalid'])
+        results = dict((r['id'], r) for r in report['results'])
+        self.assertEqual(['Ra8#'], results['mate.1']['bestMoves'])
+        self.assertEqual('Ra8#', results['mate.1']['move'])
+        self.assertTrue(results['scholar']['solved'])
+        self.assertIsNotNone(results['scholar']['timeToSolutionMillis'])
+        self.assertEqual(['f3', 'g4'], results['opening.am']['avoidMoves'])
+        self.assertNotIn(results['opening.am']['move'], ['f3', 'g4'])
+        self.assertIn('error', results['bad'])
+        self.assertEqual(5, results['bad']['line'])
+
+    def test_suite(self):
+        self.check_report(self.run_suite(1))
+
+    def test_suite_threaded(self):
+        self.check_report(self.run_suite(3))
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,130 @@
+# The MIT License (MIT)
+#
+# Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+
+
+import subprocess
+import json
+import unittest
+import os
+import tempfile
+
+def call_tulip(args):
+    cmd = ['../../src/tulip']
+    cmd.extend(args)
+    out = subprocess.check_output(cmd, stderr=subprocess.DEVNULL)
+    return out.decode('utf-8')
+
+def parse_params(text):
+    tokens = []
+    for line in text.splitlines():
+        tokens.extend(line.split('#')[0].split())
+    params = dict()
+    i = 0
+    while i < len(tokens):
+        name = tokens[i]
+        count = 64 if name.startswith('SQ_SCORE_') else 1
+        params[name] = [int(v) for v in tokens[i + 1:i + 1 + count]]
+        i += 1 + count
+    return params
+
+def write_params(file_name, params):
+    with open(file_name, 'w') as f:
+        for (name, values) in params.items():
+            f.write('%s %s\n' % (name, ' '.join(str(v) for v in values)))
+
+class TestEvalParams(unittest.TestCase):
+    def setUp(self):
+        None
+
+    def evaluate(self, fen, params_file=None):
+        args = ['-params', params_file] if params_file else []
+        return json.loads(call_tulip(args + ['-evalposition', fen]))['score']
+
+    def test_dump_defaults(self):
+        params = parse_params(call_tulip(['-dumpparams']))
+        self.assertEqual([100], params['SCORE_PAWN'])
+        self.assertEqual([900], params['SCORE_QUEEN'])
+        self.assertEqual([-3], params['KING_EXPOSURE'])
+        for table in ['SQ_SCORE_PAWN_OPENING', 'SQ_SCORE_KNIGHT_OPENING', 'SQ_SCORE_QUEEN_OPENING', 'SQ_SCORE_ENDGAME_KING']:
+            self.assertEqual(64, len(params[table]))
+
+    def test_round_trip(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            first = os.path.join(tmp, 'first.params')
+            second = os.path.join(tmp, 'second.params')
+            call_tulip(['-dumpparams', first])
+            call_tulip(['-params', first, '-dumpparams', second])
+            with open(first) as a, open(second) as b:
+                self.assertEqual(a.read(), b.read())
+
+    def test_partial_file_keeps_defaults(self):
+        fen = 'r1bqkb1r/pppp1ppp/2n2n2/4p3/4P3/8/PPPP1PPP/RNBQKB1R w KQkq - 2 3'
+        with tempfile.TemporaryDirectory() as tmp:
+            params_file = os.path.join(tmp, 'knight.params')
+            with open(params_file, 'w') as f:
+                f.write('# Knights are worth more.\nSCORE_KNIGHT 400\n')
+            self.assertEqual(self.evaluate(fen) - 100, self.evaluate(fen, params_file))
+
+            params = parse_params(call_tulip(['-params', params_file, '-dumpparams']))
+            self.assertEqual([400], params['SCORE_KNIGHT'])
+            self.assertEqual([325], params['SCORE_BISHOP'])
+
+    def test_tables_mirror_for_black(self):
+        after_e4 = 'rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1'
+        after_e5 = 'rnbqkbnr/pppp1ppp/8/4p3/4P3/8/PPPP1PPP/RNBQKBNR w KQkq e6 0 2'
+        with tempfile.TemporaryDirectory() as tmp:
+            params = parse_params(call_tulip(['-dumpparams']))
+            params['SQ_SCORE_PAWN_OPENING'][28] += 100 # e4
+            params_file = os.path.join(tmp, 'e4.params')
+            write_params(params_file, params)
+            self.assertEqual(self.evaluate(after_e4) + 100, self.evaluate(after_e4, params_file))
+            self.assertEqual(self.evaluate(after_e5), self.evaluate(after_e5, params_file))
+
+    def test_bad_files(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            unknown = os.path.join(tmp, 'unknown.params')
+            with open(unknown, 'w') as f:
+                f.write('SCORE_PAWN 100\nSCORE_ELEPHANT 200\n')
+            short = os.path.join(tmp, 'short.params')
+            with open(short, 'w') as f:
+                f.write('SQ_SCORE_PAWN_OPENING 1 2 3\n')
+            for params_file in [unknown, short, os.path.join(tmp, 'missing.params')]:
+                with self.assertRaises(subprocess.CalledProcessError):
+                    call_tulip(['-params', params_file, '-dumpparams'])
+
+    def test_xboard_option(self):
+        fen = 'r1bqkb1r/pppp1ppp/2n2n2/4p3/4P3/8/PPPP1PPP/RNBQKB1R w KQkq - 2 3'
+        with tempfile.TemporaryDirectory() as tmp:
+            params_file = os.path.join(tmp, 'knight.params')
+            with open(params_file, 'w') as f:
+                f.write('SCORE_KNIGHT 400\n')
+            commands = 'xboard\nprotover 2\noption EvalParams=%s\noption EvalParams=%s\nquit\n' % (
+                params_file, os.path.join(tmp, 'missing.params'))
+            proc = subprocess.run([os.path.abspath('../../src/tulip')], input=commands.encode('utf-8'),
+                                  stdout=subprocess.PIPE, stderr=subprocess.DEVNULL, cwd=tmp)
+            out = proc.stdout.decode('utf-8')
+            self.assertIn('option="EvalParams -file "', out)
+            self.assertEqual(1, out.count('Error: Unable to load evaluation parameters'))
+
+if __name__ == '__main__':
+    unittest.main()
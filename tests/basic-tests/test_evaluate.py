@@ -178,5 +178,26 @@ class TestBasicMoveApplication(unittest.TestCase):
         self.assertEqual(1, len(blackPawns))
         self.assertTrue('h6' in blackPawns)
 
+    def test_isolated_wpawn(self):
+        better = self.zero_depth_eval('r3k3/pppppppp/8/8/8/8/1PPPPPPP/R3K3 w - - 0 1')
+        worse = self.zero_depth_eval('r3k3/pppppppp/8/8/8/8/P1PPPPPP/R3K3 w - - 0 1')
+        self.assert_score_better_than_w(better, worse, by_at_least=5, by_no_more_than=50)
+
+    def test_kpk_unstoppable_pawn(self):
+        unstoppable = self.zero_depth_eval('8/8/8/8/8/k7/7P/7K w - - 0 1')
+        blocked = self.zero_depth_eval('8/8/8/8/8/7k/7P/7K w - - 0 1')
+        self.assert_score_better_than_w(unstoppable, blocked, by_at_least=300, by_no_more_than=1000)
+
+    def test_kbnk_drive_to_bishop_corner(self):
+        right_corner = self.zero_depth_eval('7k/8/8/8/8/8/8/BN2K3 w - - 0 1')
+        wrong_corner = self.zero_depth_eval('k7/8/8/8/8/8/8/BN2K3 w - - 0 1')
+        self.assert_score_better_than_w(right_corner, wrong_corner, by_at_least=50, by_no_more_than=300)
+
+    def test_evalbench(self):
+        result = json.loads(call_tulip(['-evalbench', '-iterations', '10']))
+        self.assertTrue(result['positions'] > 0)
+        self.assertEqual(10 * result['positions'], result['evaluations'])
+        self.assertTrue(result['elapsedMillis'] >= 0)
+
 if __name__ == '__main__':
     unittest.main()
@@ -0,0 +1,106 @@
+# The MIT License (MIT)
+#
+# Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+import subprocess
+import json
+import unittest
+import os
+import struct
+import tempfile
+
+GAMES = """[Event "One"]
+[Result "1-0"]
+
+1.e4 e5 2.Qh5 Nc6 3.Bc4 Nf6 4.Qxf7# 1-0
+
+[Event "Two"]
+[Result "1/2-1/2"]
+[FEN "4k3/8/8/8/8/8/4P3/4K3 b - - 0 40"]
+[SetUp "1"]
+
+40... Kd7 41.e4 Ke6 1/2-1/2
+
+[Event "Three"]
+
+1.d4 d5 2.Qxd5 *
+
+[Event "Four"]
+
+1.e4 *
+"""
+
+def call_tulip(args):
+    cmd = ['../../src/tulip']
+    cmd.extend(args)
+    out = subprocess.check_output(cmd)
+    return out.decode('utf-8')
+
+class TestGameFile(unittest.TestCase):
+    def setUp(self):
+        None
+
+    def test_round_trip(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            pgn = os.path.join(tmp, 'games.pgn')
+            with open(pgn, 'w') as f:
+                f.write(GAMES)
+
+            binary = os.path.join(tmp, 'games.bin')
+            result = json.loads(call_tulip(['-pgn2bin', pgn, binary]))
+            self.assertEqual(3, result['games'])
+            self.assertEqual(1, result['errors'])
+            self.assertEqual(11, result['plies'])
+
+            # A magic, then a 4 byte header and a byte per move for each game, plus the FEN.
+            fen = '4k3/8/8/8/8/8/4P3/4K3 b - - 0 40'
+            self.assertEqual(8 + 3 * 4 + 11 + 1 + len(fen), os.path.getsize(binary))
+
+            exported = os.path.join(tmp, 'exported.pgn')
+            result = json.loads(call_tulip(['-bin2pgn', binary, exported]))
+            self.assertEqual(3, result['games'])
+            self.assertEqual(0, result['errors'])
+            with open(exported) as f:
+                text = f.read()
+            self.assertTrue('1. e4 e5 2. Qh5 Nc6 3. Bc4 Nf6 4. Qxf7# 1-0' in text)
+            self.assertTrue('[FEN "%s"]' % fen in text)
+            self.assertTrue('40... Kd7 41. e4 Ke6 1/2-1/2' in text)
+            self.assertTrue('1. e4 *' in text)
+
+            again = os.path.join(tmp, 'again.bin')
+            call_tulip(['-pgn2bin', exported, again])
+            with open(binary, 'rb') as a, open(again, 'rb') as b:
+                self.assertEqual(a.read(), b.read())
+
+    def test_too_many_plies_is_corrupt(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            binary = os.path.join(tmp, 'long.bin')
+            with open(binary, 'wb') as f:
+                f.write(b'TULPGAME' + bytes([0, 0]) + struct.pack('<H', 600) + bytes(600))
+
+            proc = subprocess.run(['../../src/tulip', '-bin2pgn', binary, os.path.join(tmp, 'long.pgn')],
+                                  stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+            self.assertEqual(0, proc.returncode)
+            self.assertEqual(0, json.loads(proc.stdout.decode('utf-8'))['games'])
+            self.assertIn('corrupt', proc.stderr.decode('utf-8'))
+
+if __name__ == '__main__':
+    unittest.main()
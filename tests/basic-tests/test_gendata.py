@@ -0,0 +1,91 @@
+# The MIT License (MIT)
+#
+# Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+
+import subprocess
+import json
+import unittest
+import os
+import struct
+import tempfile
+
+def call_tulip(args):
+    cmd = ['../../src/tulip']
+    cmd.extend(args)
+    out = subprocess.check_output(cmd, stderr=subprocess.DEVNULL)
+    return out.decode('utf-8')
+
+def read_records(file_name):
+    with open(file_name, 'rb') as f:
+        data = f.read()
+    records = []
+    for offset in range(8, len(data), 32):
+        record = data[offset:offset + 32]
+        (score,) = struct.unpack('<h', record[27:29])
+        records.append((record[0:27], score, record[29]))
+    return (data[0:8], records)
+
+class TestGenData(unittest.TestCase):
+    def setUp(self):
+        None
+
+    def generate(self, file_name, extra_args=[]):
+        args = ['-gendata', file_name, '-positions', '40', '-nodes', '300', '-depth', '4', '-seed', '7']
+        return json.loads(call_tulip(args + extra_args))
+
+    def test_labeled_positions(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            data = os.path.join(tmp, 'data.bin')
+            result = self.generate(data)
+            self.assertEqual(40, result['positions'])
+            self.assertGreater(result['games'], 0)
+            self.assertEqual(8 + 40 * 32, os.path.getsize(data))
+
+            (magic, records) = read_records(data)
+            self.assertEqual(b'TULPPOSN', magic)
+            self.assertEqual(40, len(set(r[0] for r in records)))
+            for (position, score, game_result) in records:
+                self.assertIn(game_result, [1, 2, 3])
+                self.assertLess(abs(score), 2000)
+
+            # Every position reads back.
+            fens = os.path.join(tmp, 'data.fen')
+            self.assertEqual(0, json.loads(call_tulip(['-bin2fen', data, fens]))['errors'])
+
+    def test_same_seed_same_data(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            first = os.path.join(tmp, 'first.bin')
+            second = os.path.join(tmp, 'second.bin')
+            self.generate(first)
+            self.generate(second)
+            with open(first, 'rb') as a, open(second, 'rb') as b:
+                self.assertEqual(a.read(), b.read())
+
+    def test_threads(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            data = os.path.join(tmp, 'data.bin')
+            result = self.generate(data, ['-threads', '3'])
+            self.assertEqual(40, result['positions'])
+            self.assertEqual(40, len(set(r[0] for r in read_records(data)[1])))
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,56 @@
+# The MIT License (MIT)
+#
+# Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+import subprocess
+import json
+import unittest
+
+TULIP = '../../src/tulip'
+FEN = '8/8/4k3/8/2p5/8/B2K4/8 b - - 3 40'
+SUBSYSTEMS = ['movegen', 'makeUnmake', 'legality', 'eval', 'ttProbe', 'ttStore', 'qsearch', 'repetition']
+
+def search(fen):
+    out = subprocess.check_output([TULIP, '-simplesearch', fen])
+    return json.loads(out.decode('utf-8'))['searchResult']
+
+def is_instrumented():
+    return 'instrumentation' in search('6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1')
+
+@unittest.skipUnless(is_instrumented(), 'tulip is not an instrumented build (make instrumented)')
+class TestInstrument(unittest.TestCase):
+    def test_timing_fields(self):
+        result = search(FEN)
+        instrumentation = result['instrumentation']
+        for name in SUBSYSTEMS:
+            entry = instrumentation[name]
+            self.assertEqual({'calls', 'callsPerNode', 'elapsedMs', 'nanosPerCall'}, set(entry.keys()))
+            self.assertTrue(entry['calls'] >= 0)
+            self.assertAlmostEqual(entry['calls'] / result['nodes'], entry['callsPerNode'], places=2)
+            self.assertTrue(entry['elapsedMs'] >= 0)
+            self.assertTrue(entry['nanosPerCall'] >= 0)
+
+        for name in ['movegen', 'makeUnmake', 'eval', 'ttProbe']:
+            self.assertTrue(instrumentation[name]['calls'] > 0)
+            self.assertTrue(instrumentation[name]['nanosPerCall'] > 0)
+
+if __name__ == '__main__':
+    unittest.main()
@@ -44,6 +44,10 @@ class TestBasicMoveApplication(unittest.TestCase):
         adjusted_hash = state['hash']
         calculated_hash = state['recalculatedHash']
         self.assertEqual(adjusted_hash, calculated_hash, 'Hash value computed from the move and the value computed "from scratch" differ.')
+        self.assertEqual(state['mgScore'], state['recalculatedMgScore'], 'Incremental middlegame score differs from the value computed "from scratch".')
+        self.assertEqual(state['egScore'], state['recalculatedEgScore'], 'Incremental endgame score differs from the value computed "from scratch".')
+        self.assertEqual(state['pawnHash'], state['recalculatedPawnHash'], 'Incremental pawn hash differs from the value computed "from scratch".')
+        self.assertEqual(state['materialKey'], state['recalculatedMaterialKey'], 'Incremental material key differs from the value computed "from scratch".')
         return state
 
     def make_move(self, fen, move):
@@ -106,6 +110,18 @@ class TestBasicMoveApplication(unittest.TestCase):
         result = self.make_move('8/4k3/2r5/8/1P2K3/8/8/8 w - - 26 1', 'b4b5')
         self.assertEqual(0, result['fiftyMoveCount'])
 
+    def test_capture_rook_in_corner_loses_castling(self):
+        result = self.make_move('r3k2r/8/8/8/8/8/6b1/R3K2R b KQkq - 0 1', 'g2h1')
+        self.assertFalse(result['castleWhiteKingside'])
+        self.assertTrue(result['castleWhiteQueenside'])
+        self.assertTrue(result['castleBlackKingside'])
+        self.assertTrue(result['castleBlackQueenside'])
+
+        result = self.make_move('r3k2r/8/8/8/8/8/8/Q3K2R w Kkq - 0 1', 'a1a8')
+        self.assertTrue(result['castleWhiteKingside'])
+        self.assertTrue(result['castleBlackKingside'])
+        self.assertFalse(result['castleBlackQueenside'])
+
     def test_white_castle_kingside(self):
         result = self.make_move('r3k2r/pppppppp/8/8/8/8/PPPPPPPP/R3K2R w KQkq - 0 1', 'e1g1')
         board = result['board']
@@ -0,0 +1,55 @@
+# The MIT License (MIT)
+#
+# Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+import subprocess
+import json
+import unittest
+import os
+
+BENCH = '../../src/tulip-bench'
+
+def call_bench(args):
+    cmd = [BENCH]
+    cmd.extend(args)
+    out = subprocess.check_output(cmd)
+    return out.decode('utf-8')
+
+@unittest.skipUnless(os.path.exists(BENCH), 'tulip-bench is not built (make tulip-bench)')
+class TestMicrobench(unittest.TestCase):
+    def test_single_primitive(self):
+        report = json.loads(call_bench(['-samples', '3', '-only', 'evaluate']))
+        self.assertEqual(40, report['positions'])
+        self.assertEqual(1, len(report['results']))
+        result = report['results'][0]
+        self.assertEqual('evaluate', result['name'])
+        self.assertEqual(3, result['samples'])
+        self.assertTrue(result['opsPerSample'] > 0)
+        self.assertTrue(result['nanosPerOp'] >= result['minNanosPerOp'] > 0)
+        self.assertTrue(result['varianceNanosPerOp'] >= 0)
+        self.assertTrue(result['opsPerSecond'] > 0)
+
+    def test_unknown_primitive(self):
+        with self.assertRaises(subprocess.CalledProcessError):
+            subprocess.check_output([BENCH, '-only', 'nosuchthing'], stderr=subprocess.DEVNULL)
+
+if __name__ == '__main__':
+    unittest.main()
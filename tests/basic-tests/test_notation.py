@@ -224,6 +224,30 @@ class TestNotation(unittest.TestCase):
         self.assertEqual('B', move['capturedPiece'])
         self.assertEqual('promoteQueen', move['moveCode'])
 
+    def test_match_disambiguated_by_file(self):
+        move = self.match_move('Nbd2', '4k3/8/8/8/8/8/8/1N2KN2 w - - 0 1')
+        self.assertEqual('b1d2', move['move'])
+
+    def test_match_disambiguated_by_rank(self):
+        move = self.match_move('R1a3', '4k3/8/8/R7/8/8/8/R3K3 w - - 0 1')
+        self.assertEqual('a1a3', move['move'])
+
+    def test_match_ignores_pinned_piece(self):
+        move = self.match_move('Nd3', '7k/8/8/8/8/b7/1N3N2/2K5 w - - 0 1')
+        self.assertEqual('f2d3', move['move'])
+        self.assertTrue('Nd3' in self.get_moves('7k/8/8/8/8/b7/1N3N2/2K5 w - - 0 1'))
+
+    def test_match_en_passant_suffix(self):
+        move = self.match_move('exd6 e.p.', '4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1')
+        self.assertEqual('e5d6', move['move'])
+        self.assertEqual('p', move['capturedPiece'])
+
+    def test_match_underpromotion(self):
+        move = self.match_move('e8=N+', '8/2k1P3/8/8/8/8/8/4K3 w - - 0 1')
+        self.assertEqual('e7e8=n', move['move'])
+        move = self.match_move('e7e8n', '8/2k1P3/8/8/8/8/8/4K3 w - - 0 1')
+        self.assertEqual('e7e8=n', move['move'])
+
     def test_match_simple_capture(self):
         move = self.match_move('Nxd3+', '4k3/8/8/2n5/8/3B4/8/4K3 b - - 0 1')
         self.assertIsNotNone(move)
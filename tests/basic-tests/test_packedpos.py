@@ -0,0 +1,93 @@
+# The MIT License (MIT)
+#
+# Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+
+import subprocess
+import json
+import unittest
+import os
+import tempfile
+
+POSITIONS = [
+    'rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1',
+    'r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1',
+    'rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 1',
+    '8/8/4k3/8/2p5/8/B2K4/8 b - - 3 1',
+    '4k3/8/8/8/8/8/8/R3K2R b K - 12 1',
+]
+
+def call_tulip(args):
+    cmd = ['../../src/tulip']
+    cmd.extend(args)
+    out = subprocess.check_output(cmd)
+    return out.decode('utf-8')
+
+class TestPackedPositions(unittest.TestCase):
+    def setUp(self):
+        None
+
+    def write_positions(self, tmp, lines):
+        fen = os.path.join(tmp, 'positions.fen')
+        with open(fen, 'w') as f:
+            f.write('\n'.join(lines) + '\n')
+        return fen
+
+    def test_round_trip(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            fen = self.write_positions(tmp, POSITIONS)
+            packed = os.path.join(tmp, 'positions.bin')
+            result = json.loads(call_tulip(['-fen2bin', fen, packed]))
+            self.assertEqual(len(POSITIONS), result['positions'])
+            self.assertEqual(0, result['errors'])
+
+            # A magic, then 32 bytes per position.
+            self.assertEqual(8 + 32 * len(POSITIONS), os.path.getsize(packed))
+
+            exported = os.path.join(tmp, 'exported.fen')
+            result = json.loads(call_tulip(['-bin2fen', packed, exported]))
+            self.assertEqual(len(POSITIONS), result['positions'])
+            with open(exported) as f:
+                self.assertEqual(POSITIONS, f.read().splitlines())
+
+    def test_invalid_positions_are_counted(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            fen = self.write_positions(tmp, [POSITIONS[0], 'not a position', POSITIONS[1]])
+            packed = os.path.join(tmp, 'positions.bin')
+            result = json.loads(call_tulip(['-fen2bin', fen, packed]))
+            self.assertEqual(2, result['positions'])
+            self.assertEqual(1, result['errors'])
+
+    def test_batch_reads_packed_file(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            fen = self.write_positions(tmp, POSITIONS)
+            packed = os.path.join(tmp, 'positions.bin')
+            call_tulip(['-fen2bin', fen, packed])
+
+            expected = [json.loads(line) for line in call_tulip(['-batch-eval', fen]).splitlines()]
+            actual = [json.loads(line) for line in call_tulip(['-batch-eval', packed, '-threads', '2']).splitlines()]
+            self.assertEqual(len(POSITIONS), len(actual))
+            for (e, a) in zip(expected, actual):
+                self.assertEqual(e['fenString'], a['fenString'])
+                self.assertEqual(e['score'], a['score'])
+
+if __name__ == '__main__':
+    unittest.main()
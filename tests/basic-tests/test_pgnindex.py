@@ -0,0 +1,129 @@
+# The MIT License (MIT)
+#
+# Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+import subprocess
+import json
+import unittest
+import os
+import tempfile
+
+INITIAL_FEN = 'rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1'
+AFTER_E4 = 'rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1'
+
+GAMES_A = """[Event "One"]
+
+1.e4 e5 2.Nf3 Nc6 1-0
+
+[Event "Two"]
+
+1.d4 d5 0-1
+"""
+
+GAMES_B = """[Event "Three"]
+
+1.e4 {Again} c5 2.Nf3 *
+
+[Event "Four"]
+
+1.e4 1/2-1/2
+"""
+
+def call_tulip(args):
+    cmd = ['../../src/tulip']
+    cmd.extend(args)
+    out = subprocess.check_output(cmd)
+    return out.decode('utf-8')
+
+class TestPgnIndex(unittest.TestCase):
+    def setUp(self):
+        None
+
+    def write_pgn(self, directory, name, text):
+        file_name = os.path.join(directory, name)
+        with open(file_name, 'w') as f:
+            f.write(text)
+        return file_name
+
+    def query(self, index, fen):
+        return json.loads(call_tulip(['-queryindex', index, fen]))
+
+    def test_index_and_query(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            pgn = self.write_pgn(tmp, 'games.pgn', GAMES_A + '\n' + GAMES_B)
+            index = os.path.join(tmp, 'games.idx')
+            result = json.loads(call_tulip(['-indexpgn', pgn, index]))
+            self.assertEqual(4, result['games'])
+            self.assertEqual(0, result['errors'])
+
+            initial = self.query(index, INITIAL_FEN)
+            self.assertEqual(4, initial['games'])
+            self.assertEqual([0, 1, 2, 3], initial['gameIds'])
+            self.assertEqual([('e2e4', 'e4', 3), ('d2d4', 'd4', 1)], [(m['move'], m['san'], m['count']) for m in initial['moves']])
+
+            after_e4 = self.query(index, AFTER_E4)
+            self.assertEqual([0, 2, 3], after_e4['gameIds'])
+            moves = dict((m['move'], m['count']) for m in after_e4['moves'])
+            self.assertEqual({'e7e5': 1, 'c7c5': 1, '': 1}, moves)
+
+            self.assertEqual(0, self.query(index, '4k3/8/8/8/8/8/8/4K3 w - - 0 1')['games'])
+
+    def test_append(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            pgn_a = self.write_pgn(tmp, 'a.pgn', GAMES_A)
+            pgn_b = self.write_pgn(tmp, 'b.pgn', GAMES_B)
+            index = os.path.join(tmp, 'games.idx')
+            call_tulip(['-indexpgn', pgn_a, index])
+            result = json.loads(call_tulip(['-indexpgn', pgn_b, index, '-append']))
+            self.assertEqual(2, result['games'])
+            self.assertEqual(4, result['totalGames'])
+
+            after_e4 = self.query(index, AFTER_E4)
+            self.assertEqual([0, 2, 3], after_e4['gameIds'])
+
+            # Without -append the index is replaced.
+            result = json.loads(call_tulip(['-indexpgn', pgn_b, index]))
+            self.assertEqual(2, result['totalGames'])
+            self.assertEqual([0, 1], self.query(index, AFTER_E4)['gameIds'])
+
+    def test_lenient_san(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            pgn = self.write_pgn(tmp, 'sloppy.pgn', '[Event "Sloppy"]\n\n1.e4 e5 2.nf3 *\n')
+            index = os.path.join(tmp, 'sloppy.idx')
+            self.assertEqual(0, json.loads(call_tulip(['-indexpgn', pgn, index]))['errors'])
+            after_e5 = self.query(index, 'rnbqkbnr/pppp1ppp/8/4p3/4P3/8/PPPP1PPP/RNBQKBNR w KQkq - 0 2')
+            self.assertEqual(['g1f3'], [m['move'] for m in after_e5['moves']])
+
+    def test_plies_limit(self):
+        moves = ' '.join('%i. %s' % (i + 1, m) for (i, m) in enumerate(['Nf3 Nf6', 'Ng1 Ng8'] * 150))
+        with tempfile.TemporaryDirectory() as tmp:
+            pgn = self.write_pgn(tmp, 'long.pgn', '[Event "Long"]\n\n%s *\n' % moves)
+            index = os.path.join(tmp, 'long.idx')
+            result = json.loads(call_tulip(['-indexpgn', pgn, index, '-plies', '500']))
+            self.assertEqual(0, result['errors'])
+            self.assertEqual(500, result['postings'])
+
+            with self.assertRaises(subprocess.CalledProcessError):
+                subprocess.check_output(['../../src/tulip', '-indexpgn', pgn, index, '-plies', '501'],
+                                        stderr=subprocess.DEVNULL)
+
+if __name__ == '__main__':
+    unittest.main()
@@ -55,6 +55,14 @@ class TestGameResultDetection(unittest.TestCase):
         result = self.get_status('4k3/4P3/4K3/8/8/8/8/8 b - - 0 1')
         self.assertEqual('stalemate', result)
 
+    def test_fifty_move_draw(self):
+        result = self.get_status_after_moves('4k3/8/8/8/8/8/8/R3K3 w - - 99 80', ['Ra2'])
+        self.assertEqual('fiftyMoveDraw', result)
+
+    def test_checkmate_beats_fifty_move_draw(self):
+        result = self.get_status_after_moves('4k3/R7/4K3/8/8/8/8/8 w - - 99 80', ['Ra8'])
+        self.assertEqual('blackCheckmated', result)
+
     def test_material_draw_KvK(self):
         result = self.get_status('3k4/8/8/8/8/8/8/3K4 w - - 0 1')
         self.assertEqual('materialDraw', result)
@@ -67,6 +75,10 @@ class TestGameResultDetection(unittest.TestCase):
         result = self.get_status('3k4/8/8/8/8/N7/8/3K4 w - - 0 1')
         self.assertEqual('materialDraw', result)
 
+    def test_material_draw_KvKN_black(self):
+        result = self.get_status('3k4/8/8/8/8/n7/8/3K4 w - - 0 1')
+        self.assertEqual('materialDraw', result)
+
     def test_material_draw_KvKB(self):
         result = self.get_status('3k4/8/5b2/8/8/8/8/3K4 w - - 0 1')
         self.assertEqual('materialDraw', result)
@@ -115,6 +115,36 @@ class TestSearch(unittest.TestCase):
         self.assertEqual('Nxc6', result[5])
         self.assertEqual('Qxc6', result[6])
 
+    def test_depth_must_be_positive(self):
+        with self.assertRaises(subprocess.CalledProcessError):
+            subprocess.check_output(['../../src/tulip', '-simplesearch', '-depth', '0', '6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1'],
+                                    stderr=subprocess.DEVNULL)
+
+    def test_search_stats(self):
+        fen = 'r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1'
+        result = json.loads(call_tulip(['-simplesearch', '-depth', '4', fen]))['searchResult']
+        stats = result['stats']
+        self.assertAlmostEqual(stats['betaCutoffs'] / result['nodes'], stats['betaCutoffRate'], places=3)
+        self.assertEqual([1, 2, 3, 4], [x['depth'] for x in stats['iterations']])
+        self.assertIsNone(stats['iterations'][0]['ebf'])
+        self.assertEqual(result['nodes'], sum(x['nodes'] for x in stats['iterations']))
+        self.assertEqual(result['nodes'], sum(x['nodes'] for x in stats['plies']))
+        for ply in stats['plies']:
+            self.assertTrue(ply['pvNodes'] + ply['cutNodes'] + ply['allNodes'] <= ply['nodes'])
+            for rate in ['firstMoveCutoffRate', 'ttHitRate', 'ttCutoffRate', 'nullMoveSuccessRate']:
+                self.assertTrue(0.0 <= ply[rate] <= 1.0)
+
+    def test_search_stats_follow_plies_played(self):
+        # The null move reduction skips depth but plays only one ply, so no node is deeper than the search depth.
+        fen = '8/8/4k3/8/2p5/8/B2K4/8 b - - 3 40'
+        stats = json.loads(call_tulip(['-simplesearch', '-depth', '8', fen]))['searchResult']['stats']
+        self.assertEqual(list(range(0, 9)), [x['ply'] for x in stats['plies']])
+
+        # The deep search skips from depth 6 to 8; there's no branching factor across the gap.
+        self.assertEqual([1, 2, 3, 4, 5, 6, 8], [x['depth'] for x in stats['iterations']])
+        self.assertIsNotNone(stats['iterations'][5]['ebf'])
+        self.assertIsNone(stats['iterations'][6]['ebf'])
+
 
 if __name__ == '__main__':
     unittest.main()
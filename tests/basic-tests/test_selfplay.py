@@ -0,0 +1,138 @@
+# The MIT License (MIT)
+#
+# Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+
+import subprocess
+import json
+import unittest
+import os
+import tempfile
+
+OPENINGS = [
+    'rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1',
+    'rnbqkbnr/pppppppp/8/8/3P4/8/PPP1PPPP/RNBQKBNR b KQkq - 0 1',
+    '# A comment.',
+    'not a position',
+    'rnbqkbnr/pppppppp/8/8/2P5/8/PP1PPPPP/RNBQKBNR b KQkq - 0 1',
+]
+
+GAME = """[Event "One"]
+[Result "1-0"]
+
+1.e4 e5 2.Nf3 Nc6 3.Bb5 a6 1-0
+"""
+
+BRANCHING_GAMES = """[Event "A"]
+
+1.e4 e5 2.Nf3 Nc6 *
+
+[Event "B"]
+
+1.d4 d5 2.c4 e6 *
+
+[Event "C"]
+
+1.c4 e5 2.Nc3 Nf6 *
+
+[Event "D"]
+
+1.Nf3 d5 2.g3 c5 *
+
+[Event "E"]
+
+1.e4 c5 2.Nf3 d6 *
+"""
+
+def run_tulip(args):
+    cmd = ['../../src/tulip']
+    cmd.extend(args)
+    return subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+
+class TestSelfPlay(unittest.TestCase):
+    def setUp(self):
+        None
+
+    def play(self, openings, args):
+        out = run_tulip(['-selfplay', openings] + args)
+        self.assertEqual(0, out.returncode)
+        return (json.loads(out.stdout.decode('utf-8')), out.stderr.decode('utf-8').splitlines())
+
+    def test_match_totals(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            openings = os.path.join(tmp, 'openings.epd')
+            with open(openings, 'w') as f:
+                f.write('\n'.join(OPENINGS) + '\n')
+
+            (result, progress) = self.play(openings, ['-games', '6', '-threads', '2', '-depth', '1', '-tc', '10+0.1'])
+            self.assertEqual(3, result['openings'])
+            self.assertEqual(6, result['games'])
+            self.assertEqual(6, result['wins'] + result['draws'] + result['losses'])
+            self.assertEqual(1, result['engine']['depth'])
+            self.assertEqual(10000, result['baseline']['baseMillis'])
+            self.assertEqual(100, result['baseline']['incrementMillis'])
+            self.assertLess(result['lowerBound'], result['llr'])
+            self.assertGreater(result['upperBound'], result['llr'])
+            self.assertEqual('continue', result['verdict'])
+            self.assertEqual(6, len(progress))
+            self.assertTrue(progress[-1].startswith('Game 6 of 6'))
+
+    def test_book_openings(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            pgn = os.path.join(tmp, 'games.pgn')
+            with open(pgn, 'w') as f:
+                f.write(GAME)
+
+            book = os.path.join(tmp, 'book.bin')
+            run_tulip(['-buildbook', pgn, book])
+
+            (result, progress) = self.play(book, ['-games', '4', '-depth', '1', '-depth2', '2', '-bookplies', '4'])
+            self.assertEqual(2, result['openings'])
+            self.assertEqual(4, result['games'])
+            self.assertEqual(2, result['baseline']['depth'])
+
+    def test_seeded_book_openings(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            pgn = os.path.join(tmp, 'games.pgn')
+            with open(pgn, 'w') as f:
+                f.write(BRANCHING_GAMES)
+
+            book = os.path.join(tmp, 'book.bin')
+            run_tulip(['-buildbook', pgn, book])
+
+            def play(seed):
+                (result, progress) = self.play(book, ['-games', '8', '-depth', '2', '-bookplies', '4', '-seed', str(seed)])
+                return (result['plies'], result['wins'], result['draws'], result['losses'])
+
+            first = play(1)
+            self.assertEqual(first, play(1))
+            self.assertGreater(len({first, play(2), play(3)}), 1)
+
+    def test_no_openings(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            openings = os.path.join(tmp, 'openings.epd')
+            with open(openings, 'w') as f:
+                f.write('# Nothing here.\n')
+
+            self.assertNotEqual(0, run_tulip(['-selfplay', openings, '-games', '2']).returncode)
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,133 @@
+# The MIT License (MIT)
+#
+# Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+import subprocess
+import json
+import unittest
+
+INITIAL_FEN = 'rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1'
+KIWIPETE_FEN = 'r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1'
+
+class TestServer(unittest.TestCase):
+    def setUp(self):
+        self.proc = subprocess.Popen(['../../src/tulip', '-server'], stdin=subprocess.PIPE, stdout=subprocess.PIPE,
+                                     universal_newlines=True)
+
+    def tearDown(self):
+        self.proc.stdin.close()
+        self.proc.wait()
+        self.proc.stdout.close()
+
+    def request_raw(self, line):
+        self.proc.stdin.write(line + '\n')
+        self.proc.stdin.flush()
+        response = self.proc.stdout.readline()
+        self.assertTrue(response.endswith('\n'))
+        return json.loads(response)
+
+    def request(self, obj):
+        return self.request_raw(json.dumps(obj))
+
+    def test_listmoves(self):
+        result = self.request({'cmd': 'listmoves', 'fen': INITIAL_FEN})
+        self.assertEqual(20, len(result['moveList']))
+        self.assertEqual('legal', result['moveListType'])
+
+    def test_reuses_state_between_positions(self):
+        result = self.request({'cmd': 'listmoves', 'fen': KIWIPETE_FEN})
+        self.assertEqual(48, len(result['moveList']))
+        result = self.request({'cmd': 'listmoves', 'fen': '8/8/8/8/8/8/8/K6k w - - 0 1'})
+        self.assertEqual(3, len(result['moveList']))
+        result = self.request({'cmd': 'listmoves', 'fen': INITIAL_FEN, 'type': 'pseudo'})
+        self.assertEqual(20, len(result['moveList']))
+
+    def test_makemove(self):
+        result = self.request({'cmd': 'makemove', 'fen': INITIAL_FEN, 'move': 'e2e4'})
+        state = result['resultingState']
+        self.assertEqual('black', state['toMove'])
+        self.assertEqual('e', state['epFile'])
+        self.assertEqual(state['hash'], state['recalculatedHash'])
+
+    def test_perft(self):
+        self.assertEqual(8902, self.request({'cmd': 'perft', 'fen': INITIAL_FEN, 'depth': 3})['nodes'])
+        self.assertEqual(2039, self.request({'cmd': 'perft', 'fen': KIWIPETE_FEN, 'depth': 2})['nodes'])
+
+    def test_eval(self):
+        result = self.request({'cmd': 'eval', 'fen': INITIAL_FEN})
+        self.assertEqual(0, result['score'])
+
+    def test_search(self):
+        result = self.request({'cmd': 'search', 'fen': '6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1', 'depth': 3})
+        self.assertEqual('Ra8#', result['searchResult']['move'])
+
+    def test_search_does_not_depend_on_earlier_requests(self):
+        request = {'cmd': 'search', 'fen': KIWIPETE_FEN, 'depth': 4}
+        first = self.request(request)['searchResult']
+        self.request({'cmd': 'search', 'fen': INITIAL_FEN, 'depth': 3})
+        second = self.request(request)['searchResult']
+        self.assertEqual(first['nodes'], second['nodes'])
+        self.assertEqual(first['rootNodeScores'], second['rootNodeScores'])
+
+    def test_search_depth_must_be_positive(self):
+        self.assertIn('error', self.request({'cmd': 'search', 'fen': INITIAL_FEN, 'depth': 0}))
+        self.assertIn('error', self.request({'cmd': 'search', 'fen': INITIAL_FEN, 'depth': -1}))
+        self.assertEqual(1, self.request({'cmd': 'perft', 'fen': INITIAL_FEN, 'depth': 0})['nodes'])
+        result = self.request({'cmd': 'search', 'fen': '6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1', 'depth': 1})
+        self.assertEqual('Ra8#', result['searchResult']['move'])
+
+    def test_gamestatus(self):
+        result = self.request({'cmd': 'gamestatus', 'fen': INITIAL_FEN, 'moves': ['f3', 'e5', 'g4', 'Qh4']})
+        self.assertEqual('whiteCheckmated', result['status'])
+
+    def test_checkstatus(self):
+        result = self.request({'cmd': 'checkstatus', 'fen': 'rnb1kbnr/pppp1ppp/8/4p3/6Pq/5P2/PPPPP2P/RNBQKBNR w KQkq - 1 3'})
+        self.assertTrue(result['isCheck'])
+
+    def test_bookline(self):
+        result = self.request({'cmd': 'bookline', 'fen': INITIAL_FEN, 'moves': ['e4', 'e5']})
+        self.assertEqual(['e2e4', 'e7e5'], [x['move'] for x in result['hashSequence']])
+
+    def test_errors_keep_server_alive(self):
+        self.assertIn('error', self.request({'cmd': 'bogus'}))
+        self.assertIn('error', self.request_raw('this is not json'))
+        self.assertIn('error', self.request({'cmd': 'eval', 'fen': 'not a fen'}))
+        self.assertIn('error', self.request({'cmd': 'makemove', 'fen': INITIAL_FEN, 'move': 'e2e5'}))
+        self.assertIn('error', self.request({'cmd': 'gamestatus', 'fen': INITIAL_FEN, 'moves': ['e4', 'e4']}))
+        result = self.request({'cmd': 'listmoves', 'fen': INITIAL_FEN})
+        self.assertEqual(20, len(result['moveList']))
+
+    def test_move_list_limit(self):
+        shuffle = ['Nf3', 'Nf6', 'Ng1', 'Ng8']
+        result = self.request({'cmd': 'gamestatus', 'fen': INITIAL_FEN, 'moves': shuffle * 126})
+        self.assertEqual('threefoldDraw', result['status'])
+        result = self.request({'cmd': 'gamestatus', 'fen': INITIAL_FEN, 'moves': shuffle * 126 + ['Nf3']})
+        self.assertEqual('Too many moves.', result['error'])
+        result = self.request({'cmd': 'listmoves', 'fen': INITIAL_FEN})
+        self.assertEqual(20, len(result['moveList']))
+
+    def test_quit(self):
+        self.proc.stdin.write('{"cmd": "quit"}\n')
+        self.proc.stdin.flush()
+        self.assertEqual(0, self.proc.wait(timeout=10))
+
+if __name__ == '__main__':
+    unittest.main()
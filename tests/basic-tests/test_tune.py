@@ -0,0 +1,99 @@
+# The MIT License (MIT)
+#
+# Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+
+
+import subprocess
+import json
+import unittest
+import os
+import tempfile
+
+def call_tulip(args):
+    cmd = ['../../src/tulip']
+    cmd.extend(args)
+    out = subprocess.check_output(cmd, stderr=subprocess.DEVNULL)
+    return out.decode('utf-8')
+
+class TestTune(unittest.TestCase):
+    def setUp(self):
+        None
+
+    def generate(self, file_name):
+        args = ['-gendata', file_name, '-positions', '200', '-nodes', '300', '-depth', '4', '-seed', '11']
+        return json.loads(call_tulip(args))
+
+    def tune(self, data, output, extra_args=[]):
+        args = ['-tune', data, output, '-epochs', '10']
+        return json.loads(call_tulip(args + extra_args))
+
+    def test_tune_reduces_loss(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            data = os.path.join(tmp, 'data.bin')
+            output = os.path.join(tmp, 'tuned.c')
+            self.generate(data)
+            result = self.tune(data, output)
+            self.assertEqual(200, result['positions'] + result['skipped'])
+            self.assertGreater(result['positions'], 0)
+            self.assertGreater(result['k'], 0)
+            self.assertLess(result['finalLoss'], result['initialLoss'])
+
+            with open(output) as f:
+                text = f.read()
+            self.assertIn('\nSCORE_PAWN ', text)
+            self.assertIn('\nKING_EXPOSURE ', text)
+            self.assertIn('\nSQ_SCORE_PAWN_OPENING\n', text)
+            self.assertIn('\nSQ_SCORE_ENDGAME_KING\n', text)
+
+            # The output is a parameter file, which the engine and the tuner can load.
+            dumped = os.path.join(tmp, 'dumped.params')
+            call_tulip(['-params', output, '-dumpparams', dumped])
+            with open(dumped) as f:
+                self.assertEqual(text, f.read())
+
+            refined = os.path.join(tmp, 'refined.params')
+            again = json.loads(call_tulip(['-params', output, '-tune', data, refined, '-epochs', '1', '-k', str(result['k'])]))
+            self.assertAlmostEqual(result['finalLoss'], again['initialLoss'], places=3)
+
+    def test_threads_match(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            data = os.path.join(tmp, 'data.bin')
+            output = os.path.join(tmp, 'tuned.c')
+            self.generate(data)
+            single = self.tune(data, output, ['-k', '1.0'])
+            threaded = self.tune(data, output, ['-k', '1.0', '-threads', '3'])
+            self.assertEqual(single['positions'], threaded['positions'])
+            self.assertAlmostEqual(single['initialLoss'], threaded['initialLoss'], places=5)
+            self.assertAlmostEqual(single['finalLoss'], threaded['finalLoss'], places=5)
+
+    def test_unlabeled_positions_skipped(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            fens = os.path.join(tmp, 'data.fen')
+            data = os.path.join(tmp, 'data.bin')
+            with open(fens, 'w') as f:
+                f.write('rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1\n')
+            call_tulip(['-fen2bin', fens, data])
+            with self.assertRaises(subprocess.CalledProcessError):
+                self.tune(data, os.path.join(tmp, 'tuned.c'))
+
+if __name__ == '__main__':
+    unittest.main()
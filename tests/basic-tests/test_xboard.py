@@ -0,0 +1,58 @@
+# The MIT License (MIT)
+#
+# Copyright (c) 2015 Brian Wray (brian@wrocket.org)
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+import subprocess
+import glob
+import unittest
+import os
+import tempfile
+
+TULIP = os.path.abspath('../../src/tulip')
+
+# Runs an XBoard session over the given input in a scratch directory and returns the game log it wrote.
+def run_session(commands):
+    with tempfile.TemporaryDirectory() as tmp:
+        subprocess.run([TULIP], input=commands.encode('utf-8'), stdout=subprocess.DEVNULL,
+                       stderr=subprocess.DEVNULL, cwd=tmp, timeout=30)
+        logs = glob.glob(os.path.join(tmp, 'game-*.log'))
+        if len(logs) != 1:
+            return None
+        with open(logs[0]) as f:
+            return f.read()
+
+class TestXBoard(unittest.TestCase):
+    def setUp(self):
+        pass
+
+    def test_log_flushed_on_quit(self):
+        log = run_session('xboard\nprotover 2\nping 7\nquit\n')
+        self.assertIsNotNone(log)
+        self.assertIn('>>\tping 7', log)
+        self.assertIn('>>\tquit', log)
+
+    def test_log_flushed_on_eof(self):
+        log = run_session('xboard\nprotover 2\nping 7\n')
+        self.assertIsNotNone(log)
+        self.assertIn('>>\tping 7', log)
+
+if __name__ == '__main__':
+    unittest.main()
@@ -43,16 +43,22 @@ class MoveLine:
         self.move_hashes = move_hashes
 
 
-def build_line(line):
-    cmd = ['../src/tulip', '-bookline', 'rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1']
-    cmd.extend(line)
-    try:
-        out = subprocess.check_output(cmd)
-        result = json.loads(out.decode('utf-8'))
-        return MoveLine(result['initialHash'], [(x['move'], x['resultingHash']) for x in result['hashSequence']])
-    except (BrokenPipeError, subprocess.CalledProcessError):
+INITIAL_FEN = 'rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1'
+
+
+def start_tulip():
+    return subprocess.Popen(['../src/tulip', '-server'], stdin=subprocess.PIPE, stdout=subprocess.PIPE,
+                            universal_newlines=True)
+
+
+def build_line(tulip, line):
+    tulip.stdin.write(json.dumps({'cmd': 'bookline', 'fen': INITIAL_FEN, 'moves': line}) + '\n')
+    tulip.stdin.flush()
+    result = json.loads(tulip.stdout.readline())
+    if 'error' in result:
         print('Unplayable line: %s' % ' '.join(line))
         return None
+    return MoveLine(result['initialHash'], [(x['move'], x['resultingHash']) for x in result['hashSequence']])
 
 
 def digest_line(move_line):
@@ -107,16 +113,21 @@ line_len = len(all_lines)
 print("Read %i line(s) from stdin." % line_len)
 digested_lines = []
 count = 0
+tulip = start_tulip()
 for x in all_lines:
     count += 1
     if count % 10 == 0 or count == line_len:
         sys.stdout.write('\rCompleted %0.2f%%' % (count / line_len * 100.0))
-    digested = digest_line(build_line(x))
+    digested = digest_line(build_line(tulip, x))
     if digested != None:
         digested_lines.append(digested)
+tulip.stdin.close()
+tulip.wait()
 print()
 print('Combining positions...');
 file_lines = combine_lines(digested_lines)
 print('Writing to database file...')
 write_to_database(file_lines, 'tulip_openings.sqlite')
+print('Converting to a binary book...')
+subprocess.check_call(['../src/tulip', '-convertbook', 'tulip_openings.sqlite', 'tulip_openings.bin'])
 print('Done.')
\ No newline at end of file